@@ -110,5 +110,5 @@ uint32_t sha1_hash_to_uint32(const std::string &input)
     sha1_final(digest, &ctx);
     uint32_t hash = (uint32_t)digest[0] << 24 | (uint32_t)digest[1] << 16 |
                     (uint32_t)digest[2] << 8 | (uint32_t)digest[3];
-    return hash % (1 << m); // 限制在m位范围内
+    return hash % (1u << m); // 限制在m位范围内
 }
\ No newline at end of file
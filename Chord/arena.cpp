@@ -0,0 +1,102 @@
+#include "arena.h"
+#include <algorithm>
+
+using namespace std;
+
+const size_t MemoryArena::ALIGN;
+const size_t MemoryArena::MAX_SMALL;
+const size_t MemoryArena::CLASSES;
+
+MemoryArena::MemoryArena(size_t blockSize)
+    : blockSize(max(blockSize, MAX_SMALL)), cursor(nullptr), limit(nullptr), discarding(false), liveBytes(0)
+{
+    fill(freeLists, freeLists + CLASSES, nullptr);
+}
+
+MemoryArena::~MemoryArena() { release(); }
+
+/**
+ * @brief 分配一块内存：小块优先从空闲链表复用，否则从当前大块顺序切分
+ * @param bytes 请求字节数
+ * @return void* 16 字节对齐的内存
+ */
+void *MemoryArena::allocate(size_t bytes)
+{
+    if (bytes == 0)
+        bytes = 1;
+    if (bytes > MAX_SMALL)
+        return ::operator new(bytes);
+
+    size_t rounded = (bytes + ALIGN - 1) & ~(ALIGN - 1);
+    liveBytes += rounded;
+    FreeNode *&head = freeLists[rounded / ALIGN - 1];
+    if (head)
+    {
+        FreeNode *node = head;
+        head = node->next;
+        return node;
+    }
+    if (static_cast<size_t>(limit - cursor) < rounded)
+        return refill(rounded);
+    void *p = cursor;
+    cursor += rounded;
+    return p;
+}
+
+/**
+ * @brief 当前大块剩余空间不足时申请新的大块（旧块的剩余部分直接丢弃）
+ */
+void *MemoryArena::refill(size_t bytes)
+{
+    // operator new 返回的内存至少按 max_align_t 对齐，这里再补齐到 16 字节
+    char *block = static_cast<char *>(::operator new(blockSize + ALIGN));
+    blocks.push_back(block);
+    cursor = reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(block) + ALIGN - 1) & ~(uintptr_t)(ALIGN - 1));
+    limit = cursor + blockSize;
+    void *p = cursor;
+    cursor += bytes;
+    return p;
+}
+
+/**
+ * @brief 归还一块内存：小块挂回空闲链表，大块交还全局堆
+ */
+void MemoryArena::deallocate(void *p, size_t bytes)
+{
+    if (p == nullptr)
+        return;
+    if (bytes == 0)
+        bytes = 1;
+    if (bytes > MAX_SMALL)
+    {
+        ::operator delete(p);
+        return;
+    }
+    size_t rounded = (bytes + ALIGN - 1) & ~(ALIGN - 1);
+    liveBytes -= rounded;
+    if (discarding)
+        return;
+    FreeNode *node = static_cast<FreeNode *>(p);
+    FreeNode *&head = freeLists[rounded / ALIGN - 1];
+    node->next = head;
+    head = node;
+}
+
+void MemoryArena::setDiscarding(bool discard) { discarding = discard; }
+
+/**
+ * @brief 一次性归还所有大块并重置空闲链表
+ */
+void MemoryArena::release()
+{
+    for (char *block : blocks)
+        ::operator delete(block);
+    blocks.clear();
+    cursor = limit = nullptr;
+    fill(freeLists, freeLists + CLASSES, nullptr);
+    discarding = false;
+    liveBytes = 0;
+}
+
+size_t MemoryArena::reservedBytes() const { return blocks.size() * (blockSize + ALIGN); }
+size_t MemoryArena::usedBytes() const { return liveBytes; }
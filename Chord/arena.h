@@ -0,0 +1,87 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+// 按大小分级的内存池：从大块内存中顺序切分对象，释放的小块挂到对应等级的空闲链表上复用，
+// release() 一次性归还所有大块。由 ChordRingManager 持有，只在管理器所在线程使用，不加锁。
+class MemoryArena
+{
+public:
+    static const size_t ALIGN = 16;                   // 所有分配按 16 字节对齐
+    static const size_t MAX_SMALL = 1024;             // 超过该大小的请求直接走全局 operator new（须经 deallocate 归还）
+
+private:
+    static const size_t CLASSES = MAX_SMALL / ALIGN;
+
+    struct FreeNode
+    {
+        FreeNode *next;
+    };
+
+    size_t blockSize;
+    std::vector<char *> blocks;
+    char *cursor;
+    char *limit;
+    FreeNode *freeLists[CLASSES];
+    bool discarding; // 为 true 时 deallocate 不回收小块（整块释放前的拆除阶段）
+    size_t liveBytes;
+
+    void *refill(size_t bytes);
+
+public:
+    explicit MemoryArena(size_t blockSize = 64 * 1024);
+    ~MemoryArena();
+    MemoryArena(const MemoryArena &) = delete;
+    MemoryArena &operator=(const MemoryArena &) = delete;
+
+    void *allocate(size_t bytes);
+    void deallocate(void *p, size_t bytes); // 拆除阶段也须调用，否则超过 MAX_SMALL 的分配会泄漏
+    void setDiscarding(bool discard); // 拆除前打开，逐个析构对象时不再维护空闲链表
+    void release();                   // 归还所有大块；调用前其中的对象必须都已析构或不再使用
+    size_t reservedBytes() const;     // 已向系统申请的大块总字节数
+    size_t usedBytes() const;         // 当前仍在使用的小块字节数
+};
+
+// 把 MemoryArena 适配为标准库容器使用的分配器；arena 为空时退回全局 operator new
+template <class T>
+class ArenaAllocator
+{
+public:
+    typedef T value_type;
+    MemoryArena *arena;
+
+    ArenaAllocator(MemoryArena *arena = nullptr) : arena(arena) {}
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) {}
+
+    T *allocate(size_t n)
+    {
+        size_t bytes = n * sizeof(T);
+        return static_cast<T *>(arena ? arena->allocate(bytes) : ::operator new(bytes));
+    }
+
+    void deallocate(T *p, size_t n)
+    {
+        if (arena)
+            arena->deallocate(p, n * sizeof(T));
+        else
+            ::operator delete(p);
+    }
+
+    template <class U>
+    struct rebind
+    {
+        typedef ArenaAllocator<U> other;
+    };
+};
+
+template <class T, class U>
+bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) { return a.arena == b.arena; }
+template <class T, class U>
+bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) { return a.arena != b.arena; }
+
+#endif // ARENA_H
@@ -0,0 +1,113 @@
+#include "bloom.h"
+#include <cstring>
+
+using namespace std;
+
+namespace
+{
+    // splitmix64：资源ID在保序放置下是聚集的，先打散再选块与位
+    uint64_t mix(uint64_t x)
+    {
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+}
+
+BlockedBloomFilter::BlockedBloomFilter() : blocks(0), inserted(0) {}
+
+BlockedBloomFilter::BlockedBloomFilter(const BlockedBloomFilter &other) : blocks(0), inserted(0)
+{
+    *this = other;
+}
+
+/**
+ * @brief 复制时按块复制：两份存储的对齐偏移可能不同，不能直接复制整个 vector
+ */
+BlockedBloomFilter &BlockedBloomFilter::operator=(const BlockedBloomFilter &other)
+{
+    if (this == &other)
+        return *this;
+    if (other.blocks == 0)
+    {
+        clear();
+        return *this;
+    }
+    storage.assign(other.blocks * BLOCK_WORDS + BLOCK_WORDS - 1, 0);
+    blocks = other.blocks;
+    inserted = other.inserted;
+    memcpy(base(), other.base(), blocks * BLOCK_WORDS * sizeof(uint64_t));
+    return *this;
+}
+
+uint64_t *BlockedBloomFilter::base()
+{
+    uintptr_t p = reinterpret_cast<uintptr_t>(storage.data());
+    return reinterpret_cast<uint64_t *>((p + 63) & ~static_cast<uintptr_t>(63));
+}
+
+const uint64_t *BlockedBloomFilter::base() const
+{
+    uintptr_t p = reinterpret_cast<uintptr_t>(storage.data());
+    return reinterpret_cast<const uint64_t *>((p + 63) & ~static_cast<uintptr_t>(63));
+}
+
+/**
+ * @brief 按容量分配位数组并清零，块数向上取整
+ * @param capacity 预计的键数
+ */
+void BlockedBloomFilter::reset(size_t capacity)
+{
+    size_t bits = capacity * BITS_PER_KEY;
+    size_t n = (bits + BLOCK_WORDS * 64 - 1) / (BLOCK_WORDS * 64);
+    if (n == 0)
+        n = 1;
+    blocks = static_cast<uint32_t>(n);
+    inserted = 0;
+    storage.assign(n * BLOCK_WORDS + BLOCK_WORDS - 1, 0);
+}
+
+void BlockedBloomFilter::clear()
+{
+    vector<uint64_t>().swap(storage);
+    blocks = 0;
+    inserted = 0;
+}
+
+/**
+ * @brief 插入一个键：哈希高 32 位选块，另一次混合的 63 位切成 7 个 9 位下标置位
+ * @param key 资源ID
+ */
+void BlockedBloomFilter::insert(uint32_t key)
+{
+    if (blocks == 0)
+        return;
+    uint64_t h = mix(key);
+    uint64_t *block = base() + ((h >> 32) * blocks >> 32) * BLOCK_WORDS;
+    uint64_t bits = mix(h);
+    for (int i = 0; i < HASHES; i++, bits >>= 9)
+        block[(bits & 511) >> 6] |= 1ULL << (bits & 63);
+    inserted++;
+}
+
+/**
+ * @brief 查询键是否可能存在
+ * @param key 资源ID
+ * @return false 表示一定不存在
+ */
+bool BlockedBloomFilter::mayContain(uint32_t key) const
+{
+    if (blocks == 0)
+        return false;
+    uint64_t h = mix(key);
+    const uint64_t *block = base() + ((h >> 32) * blocks >> 32) * BLOCK_WORDS;
+    uint64_t bits = mix(h);
+    for (int i = 0; i < HASHES; i++, bits >>= 9)
+        if (!(block[(bits & 511) >> 6] & (1ULL << (bits & 63))))
+            return false;
+    return true;
+}
+
+size_t BlockedBloomFilter::memoryBytes() const { return storage.capacity() * sizeof(uint64_t); }
+size_t BlockedBloomFilter::size() const { return inserted; }
@@ -0,0 +1,40 @@
+#ifndef BLOOM_H
+#define BLOOM_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// 分块布隆过滤器：每个键只落在一个 64 字节（一条缓存行）的块内，块内置 HASHES 位，查询至多一次缓存未命中。
+// 只支持插入；删除后的残留位只会提高误判率，不会漏判，由使用者在残留过多时重建。
+class BlockedBloomFilter
+{
+public:
+    static const size_t BLOCK_WORDS = 8; // 512 位
+    static const int HASHES = 7;
+    static const size_t BITS_PER_KEY = 10; // 按容量计，满载时误判率约 1%
+
+private:
+    std::vector<uint64_t> storage; // 多分配 7 个字，块起点按 64 字节对齐
+    uint32_t blocks;
+    uint32_t inserted;
+
+    uint64_t *base();
+    const uint64_t *base() const;
+
+public:
+    BlockedBloomFilter();
+    BlockedBloomFilter(const BlockedBloomFilter &other);
+    BlockedBloomFilter &operator=(const BlockedBloomFilter &other);
+    BlockedBloomFilter(BlockedBloomFilter &&) = default;
+    BlockedBloomFilter &operator=(BlockedBloomFilter &&) = default;
+
+    void reset(size_t capacity); // 按容量分配并清零
+    void clear();                // 释放内存，之后所有查询返回 false
+    void insert(uint32_t key);
+    bool mayContain(uint32_t key) const;
+    size_t memoryBytes() const;
+    size_t size() const; // 插入次数
+};
+
+#endif // BLOOM_H
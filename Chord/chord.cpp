@@ -1,12 +1,53 @@
 #include "chord.h"
 #include "logger.h"
 #include "SHA_1.h"
+#include "ring_image.h"
+#include "chord_async.h"
 #include <algorithm>
 #include <stdexcept>
 #include <iostream>
+#include <chrono>
+#include <thread>
+#include <numeric>
+#include <cmath>
 
 using namespace std;
 
+namespace
+{
+    /**
+     * @brief 把 [0, n) 切成连续区间分给多个线程执行，规模较小时直接在当前线程执行
+     * @param n 元素个数
+     * @param threads 线程数上限，0 表示硬件线程数
+     * @param body 处理区间 [begin, end) 的函数，各区间之间不能有写冲突
+     */
+    void parallelFor(size_t n, size_t threads, const function<void(size_t, size_t)> &body)
+    {
+        const size_t MIN_PER_THREAD = 1024;
+        if (threads == 0)
+            threads = max<size_t>(1, thread::hardware_concurrency());
+        threads = min(threads, (n + MIN_PER_THREAD - 1) / MIN_PER_THREAD);
+        if (threads <= 1)
+        {
+            body(0, n);
+            return;
+        }
+        size_t step = (n + threads - 1) / threads;
+        vector<thread> workers;
+        for (size_t begin = 0; begin < n; begin += step)
+            workers.emplace_back(body, begin, min(n, begin + step));
+        for (auto &w : workers)
+            w.join();
+    }
+
+    // 系统时间（毫秒，UNIX 时间），TTL 的默认时钟
+    uint64_t systemNowMs()
+    {
+        return static_cast<uint64_t>(
+            chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count());
+    }
+}
+
 /*一点小巧思
 前置条件
 假设Chord环为圆O，圆心为O点，以O点竖直向上与圆相交的点H为哈希值为0点
@@ -117,7 +158,7 @@ bool ChordProxy::transferResourceToNode(Node &targetNode, const string &resource
         return false;
     try
     {
-        return chord->addResourceDirectly(sha1_hash_to_uint32(resource) % ID_SPACE, resource);
+        return chord->addResourceDirectly(resourceIdOf(resource), resource);
     }
     catch (...)
     {
@@ -198,9 +239,160 @@ Node ChordProxy::findSuccessorFromAny(uint32_t id)
     return chord ? chord->getSelf() : Node();
 }
 
+/**
+ * @brief 记录节点新增资源（写入该节点的 WAL）
+ * @param owner 存储资源的节点
+ * @param rid 资源ID
+ * @param resource 资源内容
+ */
+void ChordProxy::logResourcePut(const Node &owner, uint32_t rid, const string &resource)
+{
+    if (ringManager)
+        ringManager->getStorage().logPut(owner.id, rid, resource);
+}
+
+/**
+ * @brief 记录节点删除资源（写入该节点的 WAL）
+ * @param owner 存储资源的节点
+ * @param rid 资源ID
+ */
+void ChordProxy::logResourceRemove(const Node &owner, uint32_t rid)
+{
+    if (ringManager)
+        ringManager->getStorage().logRemove(owner.id, rid);
+}
+
+/**
+ * @brief 记录资源的到期时刻（写入该节点的 WAL）
+ * @param owner 存储资源的节点
+ * @param rid 资源ID
+ * @param deadlineMs 到期时刻
+ */
+void ChordProxy::logResourceExpiry(const Node &owner, uint32_t rid, uint64_t deadlineMs)
+{
+    if (ringManager)
+        ringManager->getStorage().logExpiry(owner.id, rid, deadlineMs);
+}
+
+/**
+ * @brief 记录节点删除一段连续的资源（闭区间 [lo, hi]，写入该节点的 WAL）
+ * @param owner 存储资源的节点
+ * @param lo 区间下界
+ * @param hi 区间上界
+ */
+void ChordProxy::logResourceRangeRemove(const Node &owner, uint32_t lo, uint32_t hi)
+{
+    if (ringManager)
+        ringManager->getStorage().logRemoveRange(owner.id, lo, hi);
+}
+
+/**
+ * @brief 记录一个迁移分块的所有权转移（写入接收节点的 WAL，一个分块一条记录）
+ * @param from 原负责节点
+ * @param to 新负责节点
+ * @param chunk 迁移的资源分块
+ */
+void ChordProxy::logResourceChunkTransfer(const Node &from, const Node &to, const ResourceChunk &chunk)
+{
+    if (ringManager)
+        ringManager->getStorage().logTransferChunk(from.id, to.id, chunk);
+}
+
+/**
+ * @brief 获取区间迁移配置
+ * @return const MigrationOptions& 迁移配置
+ */
+const MigrationOptions &ChordProxy::getMigrationOptions()
+{
+    static const MigrationOptions defaults;
+    return ringManager ? ringManager->getMigrationOptions() : defaults;
+}
+
+/**
+ * @brief 获取 TTL 配置
+ * @return const TtlOptions& TTL 配置
+ */
+const TtlOptions &ChordProxy::getTtlOptions()
+{
+    static const TtlOptions defaults;
+    return ringManager ? ringManager->getTtlOptions() : defaults;
+}
+
+uint64_t ChordProxy::nowMs() { return ringManager ? ringManager->nowMs() : systemNowMs(); }
+
+/**
+ * @brief 上报一次迁移的结果
+ * @param progress 迁移进度（done 为 true）
+ */
+void ChordProxy::recordMigration(const MigrationProgress &progress)
+{
+    if (ringManager)
+        ringManager->recordMigration(progress);
+}
+
+/**
+ * @brief 按环当前的放置方式计算资源ID
+ * @param resource 资源名称
+ * @return uint32_t 资源ID
+ */
+uint32_t ChordProxy::resourceIdOf(const string &resource)
+{
+    return ringManager ? ringManager->resourceIdOf(resource) : hashedKeyId(resource);
+}
+
+MemoryArena *ChordProxy::getArena()
+{
+    return ringManager ? &ringManager->getArena() : nullptr;
+}
+
+/**
+ * @brief 模拟一条节点之间的消息，未开启网络模拟时不做任何事
+ * @param from 发送方
+ * @param to 接收方
+ * @param payloadBytes 负载字节数（不含报头）
+ */
+void ChordProxy::sendMessage(const Node &from, const Node &to, size_t payloadBytes)
+{
+    NetworkEmulator *network = ringManager ? ringManager->getNetwork() : nullptr;
+    if (network)
+        network->send(from, to, payloadBytes);
+}
+
+/**
+ * @brief 模拟向多个节点并发发送的消息，未开启网络模拟时不做任何事
+ * @param from 发送方
+ * @param to 接收方列表
+ * @param payloadBytes 每条消息的负载字节数
+ */
+void ChordProxy::sendMessages(const Node &from, const vector<Node> &to, size_t payloadBytes)
+{
+    NetworkEmulator *network = ringManager ? ringManager->getNetwork() : nullptr;
+    if (network)
+        network->sendParallel(from, to, payloadBytes);
+}
+
+/**
+ * @brief 模拟异步运行时中与其他请求重叠的一条消息，耗时由调用方计入所属请求，未开启网络模拟时返回 0
+ * @param from 发送方
+ * @param to 接收方
+ * @param payloadBytes 负载字节数
+ * @return double 单程耗时（毫秒）
+ */
+double ChordProxy::sendConcurrentMessage(const Node &from, const Node &to, size_t payloadBytes)
+{
+    NetworkEmulator *network = ringManager ? ringManager->getNetwork() : nullptr;
+    return network ? network->sendConcurrent(from, to, payloadBytes) : 0;
+}
+
+bool ChordProxy::isNetworkEnabled() { return ringManager && ringManager->getNetwork(); }
+const RoutingGeometry *ChordProxy::getGeometry() { return ringManager ? ringManager->getGeometry() : &chordFingerGeometry(); }
+bool ChordProxy::isGossipEnabled() { return ringManager && ringManager->getGossipOptions().enabled; }
+
 // ==================== ChordRingManager 实现 ====================
 
-ChordRingManager::ChordRingManager() : proxy(this)
+ChordRingManager::ChordRingManager() : proxy(this), parallelism(0), filterCacheEnabled(false), expireCursor(0), epoch(0),
+      entryRng(1), entryCursor(0), entryEpoch(~0ULL), geometry(makeGeometry(GeometryOptions())),
+      gossip(GossipOptions())
 {
     logger.info("ChordRingManager 初始化");
 }
@@ -208,9 +400,49 @@ ChordRingManager::ChordRingManager() : proxy(this)
 ChordRingManager::~ChordRingManager()
 {
     logger.info("ChordRingManager 析构");
+    asyncRuntime.reset(); // 先完成在途的异步请求
+    releaseAllChords();
+}
+
+/**
+ * @brief 在管理器的内存池中创建 Chord 实例
+ * @param node 节点
+ * @return Chord* 新实例，由 destroyChord 或管理器析构时销毁
+ */
+Chord *ChordRingManager::createChord(const Node &node)
+{
+    // Chord 对象内嵌 uint32_t fingerIds[FINGER_SLOTS] 与 float fingerRtt[m]，另有几何指针与 links 向量头；
+    // m 最大时整个对象也须不超过内存池的小块上限，拆除阶段才能整块回收
+    static_assert(sizeof(Chord) <= MemoryArena::MAX_SMALL, "Chord 超出 MemoryArena 小块上限");
+    void *p = arena.allocate(sizeof(Chord));
+    return new (p) Chord(node, &proxy);
+}
+
+/**
+ * @brief 析构 Chord 实例并把内存归还内存池
+ * @param chord 由 createChord 创建的实例
+ */
+void ChordRingManager::destroyChord(Chord *chord)
+{
+    if (chord == nullptr)
+        return;
+    chord->~Chord();
+    arena.deallocate(chord, sizeof(Chord));
+}
+
+/**
+ * @brief 拆除全部节点：逐个析构并交还内存（不在内存池中的长字符串、大块分配随之释放），
+ *        期间不维护空闲链表，最后整块释放内存池
+ */
+void ChordRingManager::releaseAllChords()
+{
+    arena.setDiscarding(true);
     for (auto &p : chordNodes)
-        delete p.second;
+        destroyChord(p.second);
     chordNodes.clear();
+    filterCache.clear();
+    epoch++;
+    arena.release();
 }
 
 /**
@@ -228,10 +460,15 @@ bool ChordRingManager::join(Node &newNode, Chord *chordInstance)
         return false;
     }
     chordNodes[newNode.id] = chordInstance;
+    filterCache.clear(); // 负责区间变化，缓存的过滤器不再对应新的归属
+    epoch++;
+    storage.logJoin(newNode.ip());
     logger.info("节点加入: " + newNode.toString());
 
     // 实际应该是每个节点都会周期性刷新finger table保持稳定，范围是半个环上的节点，这里在每个节点加入后更新全部节点的finger table保证稳定
-    refreshAllFingerTables();
+    // 单跳几何与 gossip 模式由新节点在 joinRing 中推送增量，不刷新
+    if (!geometry->fullMembership() && !gossip.getOptions().enabled)
+        refreshAllFingerTables();
     return true;
 }
 
@@ -275,12 +512,13 @@ Chord *ChordRingManager::findChordNode(uint32_t id)
  * @brief 通过当前节点根据ID查找Chord节点的直接后继节点
  * @param currentNode 当前节点（用于定位Chord环）
  * @param id 节点ID
+ * @param hops 可选，累加路由经过的转发次数
  * @return Node 找到的Chord节点的直接后继节点，若不存在则返回空节点
  */
-Node ChordRingManager::findSuccessor(Node &currentNode, uint32_t id)
+Node ChordRingManager::findSuccessor(Node &currentNode, uint32_t id, int *hops)
 {
     Chord *chord = findChordNode(currentNode.id);
-    return chord ? chord->findSuccessor(id) : currentNode;
+    return chord ? chord->findSuccessor(id, hops) : currentNode;
 }
 
 /**
@@ -305,7 +543,7 @@ Node ChordRingManager::findPredecessor(Node &currentNode, uint32_t id)
 bool ChordRingManager::transferResourceToNode(Node &targetNode, const string &resource)
 {
     Chord *chord = findChordNode(targetNode.id);
-    return chord ? chord->addResourceDirectly(sha1_hash_to_uint32(resource) % ID_SPACE, resource) : false;
+    return chord ? chord->addResourceDirectly(resourceIdOf(resource), resource) : false;
 }
 
 /**
@@ -316,13 +554,50 @@ void ChordRingManager::notifyAllNodesUpdate(Node &newNode)
 {
     if (chordNodes.empty() || newNode.isEmpty())
         return;
+    if (gossip.getOptions().enabled)
+    {
+        // gossip：新节点自己开始传播，尚未得知的成员不会 ping 它
+        vector<uint32_t> ids = getAllSortedNodeIds();
+        size_t origin = lower_bound(ids.begin(), ids.end(), newNode.id) - ids.begin();
+        if (origin == ids.size() || ids[origin] != newNode.id)
+            return;
+        GossipUpdate update = {newNode.id, MemberState::ALIVE, 0};
+        lastGossip = gossip.disseminate(ids, origin, origin, update, [this](uint32_t id, const GossipUpdate &u)
+                                        { deliverGossip(id, u); });
+        gossipStats.add(lastGossip, false);
+        // 新节点自己的链接表与 PNS finger 只为它一个节点计算
+        Chord *joined = findChordNode(newNode.id);
+        if (!geometry->usesFingerTable() && !geometry->fullMembership())
+        {
+            vector<uint32_t> out;
+            geometry->buildLinks(ids, origin, vector<uint32_t>(), out);
+            joined->setRouting(geometry.get(), out);
+        }
+        if (proximity.enabled)
+        {
+            function<double(const Node &, const Node &)> rtt = rttSource();
+            for (int k = 0; k < m && rtt; k++)
+                repickProximateFinger(joined, k, rtt);
+        }
+        return;
+    }
+    bool full = geometry->fullMembership();
+    vector<Node> notified;
     for (auto &p : chordNodes)
     {
         if (p.first != newNode.id)
         {
-            p.second->updateFingerTable(newNode);
+            if (full)
+                p.second->addMember(newNode);
+            else
+                p.second->updateFingerTable(newNode);
+            if (full && proxy.isNetworkEnabled())
+                notified.push_back(p.second->getSelf());
         }
     }
+    // 单跳：增量由新节点并发发给每个成员，每条消息只含一个节点
+    if (!notified.empty())
+        proxy.sendMessages(newNode, notified, sizeof(uint32_t));
 }
 
 /**
@@ -330,6 +605,46 @@ void ChordRingManager::notifyAllNodesUpdate(Node &newNode)
  * @return ChordProxy& Chord环管理器的代理对象引用
  */
 ChordProxy &ChordRingManager::getProxy() { return proxy; }
+void ChordRingManager::setParallelism(size_t threads) { parallelism = threads; }
+size_t ChordRingManager::getParallelism() const { return parallelism; }
+
+// ==================== 异步接口 ====================
+
+ChordAsyncRuntime &ChordRingManager::getAsyncRuntime()
+{
+    if (!asyncRuntime)
+        asyncRuntime.reset(new ChordAsyncRuntime(*this));
+    return *asyncRuntime;
+}
+
+std::future<Node> ChordRingManager::lookupAsync(const std::string &resource) { return getAsyncRuntime().lookup(resource); }
+std::future<bool> ChordRingManager::putAsync(const std::string &resource) { return getAsyncRuntime().put(resource); }
+std::future<bool> ChordRingManager::removeAsync(const std::string &resource) { return getAsyncRuntime().remove(resource); }
+
+void ChordRingManager::drainAsync()
+{
+    if (asyncRuntime)
+        asyncRuntime->drain();
+}
+MemoryArena &ChordRingManager::getArena() { return arena; }
+
+/**
+ * @brief 开启网络模拟，已开启时以新配置替换（虚拟时钟与统计从零开始）
+ * @param options 网络模拟配置
+ * @return true 若时延模型创建成功
+ */
+bool ChordRingManager::enableNetwork(const NetworkOptions &options)
+{
+    unique_ptr<NetworkEmulator> emulator(new NetworkEmulator(options));
+    if (!emulator->init())
+        return false;
+    network = std::move(emulator);
+    logger.info(string("网络模拟已开启，模型 ") + (options.model == LatencyModelType::MATRIX ? "matrix" : "coords"));
+    return true;
+}
+
+void ChordRingManager::disableNetwork() { network.reset(); }
+NetworkEmulator *ChordRingManager::getNetwork() { return network.get(); }
 
 /**
  * @brief 获取所有Chord节点的ID，按ID排序
@@ -362,22 +677,35 @@ void ChordRingManager::notifyAllNodesLeave(Node &leftNode)
 {
     if (chordNodes.empty() || leftNode.isEmpty())
         return;
+    bool full = geometry->fullMembership();
+    vector<Node> notified;
     for (auto &p : chordNodes)
     {
         if (p.first != leftNode.id)
         {
             p.second->handleNodeLeave(leftNode);
+            if (full && proxy.isNetworkEnabled())
+                notified.push_back(p.second->getSelf());
         }
     }
+    // 单跳：离开（或崩溃）由后继发现后把增量并发发给每个成员
+    if (!notified.empty())
+    {
+        auto it = chordNodes.upper_bound(leftNode.id);
+        if (it == chordNodes.end())
+            it = chordNodes.begin();
+        proxy.sendMessages(it->second->getSelf(), notified, sizeof(uint32_t));
+    }
 }
 
 /**
  * @brief 移除Chord节点
  * @param leftNode 离开的Chord节点
+ * @param graceful true 为正常离开（资源转移给后继），false 为崩溃（本地资源丢失，邻居直接修补前驱/后继）
  * @return true 若成功移除
  * @return false 若失败（节点不存在或其他原因）
  */
-bool ChordRingManager::removeNode(Node &leftNode)
+bool ChordRingManager::removeNode(Node &leftNode, bool graceful)
 {
     auto it = chordNodes.find(leftNode.id);
     if (it == chordNodes.end())
@@ -387,17 +715,29 @@ bool ChordRingManager::removeNode(Node &leftNode)
     }
 
     Chord *chord = it->second;
-    bool result = chord->leaveRing();
+    bool result = chord->leaveRing(graceful);
 
-    // 通知所有节点有节点离开（无奈之举了属于是）
-    notifyAllNodesLeave(leftNode);
+    // 通知所有节点有节点离开（无奈之举了属于是）；gossip 模式下先摘除节点，其余成员经 gossip 得知
+    bool gossiping = gossip.getOptions().enabled;
+    if (!gossiping)
+        notifyAllNodesLeave(leftNode);
     chordNodes.erase(it);
+    filterCache.clear();
+    epoch++;
 
     // 删除节点后也通知所有节点更新 finger table（也是无奈之举，太弱小了）
-    refreshAllFingerTables();
-
-    delete chord;
-    logger.info("节点移除: " + leftNode.toString());
+    // 单跳几何在 notifyAllNodesLeave 中已按增量修补了每个节点
+    if (gossiping)
+        gossipLeave(leftNode, graceful);
+    else if (!geometry->fullMembership())
+        refreshAllFingerTables();
+
+    storage.logLeave(chord->getSelf().ip());
+    storage.dropNode(leftNode.id);
+    checkpoint();
+
+    destroyChord(chord);
+    logger.info(string(graceful ? "节点移除: " : "节点崩溃: ") + leftNode.toString());
     return result;
 }
 
@@ -417,58 +757,175 @@ void ChordRingManager::showChordInfo() const
 /**
  * @brief 添加资源到Chord环
  * @param resource 资源名称
+ * @param ttlMs 存活时间（毫秒），0 表示永不过期
  * @return true 若成功添加
  * @return false 若失败（环为空或其他原因）
  */
-bool ChordRingManager::addResource(const string &resource)
+bool ChordRingManager::addResource(const string &resource, uint64_t ttlMs)
 {
     if (chordNodes.empty())
         return false;
-    uint32_t rid = sha1_hash_to_uint32(resource) % ID_SPACE;
+    uint32_t rid = resourceIdOf(resource);
 
-    // 尝试获取任意节点作为起始点
-    Node anyNode = getAnyNode();
+    // 按入口策略选择起始节点
+    Node anyNode = enterRing(resource.size());
     if (anyNode.isEmpty())
         return false;
 
     // 直接把节点作为入口，查找负责节点
     Node responsible = findSuccessor(anyNode, rid);
-    Chord *chord = findChordNode(responsible.id);
-    if (!chord)
+    proxy.sendMessage(anyNode, responsible, resource.size());
+    proxy.sendMessage(responsible, anyNode);
+    return addResourceAt(findChordNode(responsible.id), resource, ttlMs);
+}
+
+/**
+ * @brief 在已路由到的负责节点上添加资源（同步与异步接口共用）
+ * @param owner 负责节点
+ * @param resource 资源名称
+ * @param ttlMs 存活时间（毫秒），0 表示永不过期
+ * @return true 若添加成功
+ */
+bool ChordRingManager::addResourceAt(Chord *owner, const string &resource, uint64_t ttlMs)
+{
+    if (!owner)
         return false;
-    bool result = chord->addResource(resource);
+    reclaimAt(owner);
+    expireOnRead(owner, resourceIdOf(resource)); // 已过期的同名资源视为不存在，可以重新写入
+    bool result = owner->addResource(resource);
     if (result)
-        logger.info("资源 '" + resource + "' -> " + responsible.toString());
+    {
+        if (ttlMs > 0)
+            owner->setExpiry(resourceIdOf(resource), nowMs() + ttlMs);
+        logger.info("资源 '" + resource + "' -> " + owner->getSelf().toString());
+        // 写入经过管理器，同步更新缓存的过滤器副本，保证缓存不会漏判
+        auto cached = filterCache.find(owner->getSelf().id);
+        if (cached != filterCache.end())
+            cached->second.insert(resourceIdOf(resource));
+    }
+    checkpoint();
+    // 写盘失败：资源已在内存中，记录留在缓冲区等下次提交重试，但不能向调用方确认写入成功
+    if (result && !storage.healthy())
+    {
+        logger.error("资源 '" + resource + "' 未能写盘");
+        return false;
+    }
     return result;
 }
 
 /**
  * @brief 查找资源的Chord节点
  * @param resource 资源名称
+ * @param hops 可选，输出从入口节点出发的路由跳数
  * @return Node 负责存储该资源的Chord节点的Node信息，若不存在则返回空Node节点
  */
-Node ChordRingManager::lookupResource(const string &resource)
+Node ChordRingManager::lookupResource(const string &resource, int *hops)
 {
     if (chordNodes.empty())
         return Node();
-    uint32_t rid = sha1_hash_to_uint32(resource) % ID_SPACE;
-    Node anyNode = getAnyNode();
+    uint32_t rid = resourceIdOf(resource);
+    Node anyNode = enterRing(resource.size());
     if (anyNode.isEmpty())
         return Node();
+    filterStats.lookups++;
 
-    Node responsible = findSuccessor(anyNode, rid);
+    // 缓存模式：按环视图直接定位负责节点，用缓存的过滤器副本在路由前拒绝不存在的资源
+    if (filterCacheEnabled)
+    {
+        Chord *owner = ownerOf(rid);
+        auto cached = filterCache.find(owner->getSelf().id);
+        if (cached == filterCache.end())
+        {
+            const BlockedBloomFilter &filter = owner->getFilter();
+            proxy.sendMessage(anyNode, owner->getSelf());
+            proxy.sendMessage(owner->getSelf(), anyNode, filter.memoryBytes());
+            cached = filterCache.emplace(owner->getSelf().id, filter).first;
+            filterStats.cacheFetches++;
+        }
+        if (!cached->second.mayContain(rid))
+        {
+            filterStats.cacheRejects++;
+            return Node();
+        }
+    }
+
+    Node responsible = findSuccessor(anyNode, rid, hops);
     Chord *chord = findChordNode(responsible.id);
     if (chord)
     {
-        // 检查该节点是否真正拥有这个资源
-        const auto &resources = chord->getAllResources();
-        if (resources.find(rid) != resources.end())
+        proxy.sendMessage(anyNode, responsible);
+        if (lookupAt(chord, rid, anyNode))
             return responsible; // 资源存在，返回负责节点
     }
 
     return Node();
 }
 
+/**
+ * @brief 在已路由到的负责节点上查找资源（异步接口用），与同步查找一样计入过滤器统计
+ * @param owner 负责节点
+ * @param rid 资源ID
+ * @param from 发起查找的入口节点，回复计入网络模拟
+ * @param concurrentMs 回复的模拟耗时累加到这里，不推进虚拟时钟（异步请求各自计时）
+ * @return true 若资源存在且未过期
+ */
+bool ChordRingManager::lookupResourceAt(Chord *owner, uint32_t rid, const Node &from, double *concurrentMs)
+{
+    if (!owner)
+        return false;
+    filterStats.lookups++;
+    return lookupAt(owner, rid, from, concurrentMs);
+}
+
+/**
+ * @brief 负责节点处理一次查找（经入口路由的查找、异步查找与客户端直连共用）
+ * @param owner 负责节点
+ * @param rid 资源ID
+ * @param from 请求方，回复计入网络模拟
+ * @param concurrentMs 非空时回复耗时累加到这里而不推进虚拟时钟（异步运行时）
+ * @return true 若资源存在且未过期
+ */
+bool ChordRingManager::lookupAt(Chord *owner, uint32_t rid, const Node &from, double *concurrentMs)
+{
+    Node self = owner->getSelf();
+    auto reply = [&](size_t payloadBytes)
+    {
+        if (concurrentMs)
+            *concurrentMs += proxy.sendConcurrentMessage(self, from, payloadBytes);
+        else
+            proxy.sendMessage(self, from, payloadBytes);
+    };
+    reclaimAt(owner);
+    // 过滤器判定不存在时直接回复，不访问资源表
+    if (!owner->mayContainResource(rid))
+    {
+        filterStats.nodeRejects++;
+        reply(0);
+        return false;
+    }
+    // 检查该节点是否真正拥有这个资源
+    const auto &resources = owner->getResourceMap();
+    auto it = resources.find(rid);
+    bool expired = it != resources.end() && expireOnRead(owner, rid);
+    if (expired)
+        it = resources.end();
+    reply(it != resources.end() ? it->second.size() : 0);
+    if (it == resources.end() && !expired)
+        filterStats.falsePositives++;
+    return it != resources.end();
+}
+
+/**
+ * @brief 按当前成员直接定位资源的负责节点（rid 的后继），环非空时调用
+ * @param rid 资源ID
+ * @return Chord* 负责节点
+ */
+Chord *ChordRingManager::ownerOf(uint32_t rid) const
+{
+    auto it = chordNodes.lower_bound(rid);
+    return it == chordNodes.end() ? chordNodes.begin()->second : it->second;
+}
+
 /**
  * @brief 显示资源分布
  */
@@ -493,23 +950,41 @@ void ChordRingManager::refreshAllFingerTables()
 {
     for (auto &p : chordNodes)
         p.second->fixFingers();
+    rebuildLinks();
+    if (proximity.enabled)
+    {
+        vector<uint32_t> ids;
+        vector<Chord *> chords;
+        ids.reserve(chordNodes.size());
+        chords.reserve(chordNodes.size());
+        for (auto &p : chordNodes)
+        {
+            ids.push_back(p.first);
+            chords.push_back(p.second);
+        }
+        applyProximity(ids, chords);
+    }
 }
 
 // ==================== Chord 实现 ====================
 
 Chord::Chord(Node self, ChordProxy *proxy)
-    : self(self), predecessor(Node()), successor(Node()), proxy(proxy)
+    : self(self), predecessor(Node()), successor(Node()), proxy(proxy),
+      resources(ResourceMap::allocator_type(proxy ? proxy->getArena() : nullptr))
 {
-    fingerTable.resize(m);
-    for (uint32_t i = 0; i < m; i++)
-    {
-        fingerTable[i].startId = (self.id + (1u << i)) % ID_SPACE;
-        fingerTable[i].node = self;
-    }
+    for (int i = 0; i < FINGER_SLOTS; i++)
+        fingerIds[i] = self.id;
+    for (int i = 0; i < m; i++)
+        fingerRtt[i] = 0;
+    filterCapacity = 0;
+    filterStale = 0;
+    geometry = proxy ? proxy->getGeometry() : &chordFingerGeometry();
+    if (!logger.isEnabled())
+        return;
     string fingerTableStr = "[";
-    for (const auto &entry : fingerTable)
+    for (int i = 0; i < m; i++)
     {
-        fingerTableStr += "(" + to_string(entry.startId) + ", " + entry.node.toString() + "), ";
+        fingerTableStr += "(" + to_string(getFingerStart(i)) + ", " + to_string(fingerIds[i]) + "), ";
     }
     fingerTableStr += "]";
     logger.info("Init Chord " + self.toString() + " with finger table: " + fingerTableStr);
@@ -517,9 +992,8 @@ Chord::Chord(Node self, ChordProxy *proxy)
 
 Chord::~Chord()
 {
-    logger.info("Destroy Chord " + self.toString());
-    resources.clear();
-    fingerTable.clear();
+    if (logger.isEnabled())
+        logger.info("Destroy Chord " + self.toString());
 }
 
 /**
@@ -529,8 +1003,8 @@ void Chord::initAsFirstNode()
 {
     predecessor = self;
     successor = self;
-    for (int i = 0; i < m; i++)
-        fingerTable[i].node = self;
+    for (int i = 0; i < FINGER_SLOTS; i++)
+        fingerIds[i] = self.id;
     logger.info("Init Chord " + self.toString() + " as the first node in the ring.");
 }
 
@@ -571,61 +1045,119 @@ bool Chord::isInOpenInterval(uint32_t id, uint32_t start, uint32_t end)
 /**
  * @brief 查找Chord环中节点为id的后继节点
  * @param id 要查找的节点ID
+ * @param hops 可选，每转发给下一个节点一次加 1
  * @return Node 后继节点，若不存在则返回空节点
  */
-Node Chord::findSuccessor(uint32_t id)
+Node Chord::findSuccessor(uint32_t id, int *hops)
 {
-    if (successor.isEmpty())
-        return self;
-
-    if (id == self.id)
-        return self;
+    const Chord *current = this;
+    uint32_t next;
+    while (!current->routeStep(id, next))
+    {
+        // 通过网络（代理）转发给最接近的前驱，找不到该节点时退回当前节点的后继
+        Chord *nextChord = proxy ? proxy->findChordNodeByID(next) : nullptr;
+        if (!nextChord)
+            return current->successor;
+        if (hops)
+            (*hops)++;
+        proxy->sendMessage(current->self, nextChord->self);
+        current = nextChord;
+    }
+    // 确定后继的节点把结果直接回给发起查找的节点
+    if (proxy)
+        proxy->sendMessage(current->self, self);
+    return current->resolveNode(next);
+}
 
+/**
+ * @brief 路由一步：判断 id 的后继能否在本节点确定，不能时给出下一跳
+ * @param id 要查找的ID
+ * @param next 输出，已确定时为后继节点ID，否则为下一跳（finger 表中最接近的前驱）节点ID
+ * @return true 若已确定后继
+ */
+bool Chord::routeStep(uint32_t id, uint32_t &next) const
+{
+    if (successor.isEmpty() || id == self.id)
+    {
+        next = self.id;
+        load.resolves++;
+        return true;
+    }
     if (isInInterval(id, self.id, successor.id))
-        return successor;
-
+    {
+        next = successor.id;
+        load.resolves++;
+        return true;
+    }
     if (!predecessor.isEmpty() && isInInterval(id, predecessor.id, self.id))
     {
-        return self;
+        next = self.id;
+        load.resolves++;
+        return true;
     }
 
-    // 如果在finger table中，则查找该节点的前继节点
-    Node closest = findClosestPrecedingNode(id);
-    if (closest.id == self.id)
+    // 全成员表在本节点直接确定后继，不再转发
+    uint32_t owner;
+    if (!links.empty() && geometry->owner(links.data(), links.size(), self.id, id, owner))
     {
-        return successor;
+        next = owner;
+        load.resolves++;
+        return true;
     }
 
-    // 否则，通过网络（代理）查找该节点的后继节点
-    if (proxy)
+    // 如果在finger table中，则查找该节点的前继节点
+    uint32_t closest = closestPrecedingFinger(id);
+    if (closest == self.id)
     {
-        Chord *closestChord = proxy->findChordNodeByID(closest.id);
-        if (closestChord)
-            return closestChord->findSuccessor(id);
+        next = successor.id;
+        load.resolves++;
+        return true;
     }
-    return successor;
+    next = closest;
+    load.forwards++;
+    return false;
 }
 
 /**
  * @brief 在finger table中查找Chord环中节点id的最接近的前驱节点
  * @param id 要查找的节点ID
- * @return Node 最接近的前驱节点，若不存在则返回空节点
+ * @return Node 最接近的前驱节点，若不存在则返回自身
  */
 Node Chord::findClosestPrecedingNode(uint32_t id)
 {
-    for (int i = m - 1; i >= 0; i--)
-    {
-        Node &fingerNode = fingerTable[i].node;
-        if (fingerNode.isEmpty() || fingerNode == self)
-            continue;
+    return resolveNode(closestPrecedingFinger(id));
+}
 
-        if (isInInterval(fingerNode.id, self.id, id))
-        {
-            if (fingerNode.id != id)
-                return fingerNode;
-        }
-    }
-    return self;
+/**
+ * @brief 按路由几何在路由表上选 id 的下一跳（只看节点ID，不解析 IP），路由热路径使用
+ * @param id 要查找的节点ID
+ * @return uint32_t 下一跳节点ID，落在 (self.id, id) 内；若不存在则返回自身ID
+ */
+uint32_t Chord::closestPrecedingFinger(uint32_t id) const
+{
+    // Chord 几何：条件 finger ∈ (self.id, id) 由 finger_simd 内核一次比较全部槽位，取下标最大者
+    if (links.empty())
+        return geometry->nextHop(fingerIds, FINGER_SLOTS, self.id, id);
+    // 链接表不含后继，没有更近的链接时交给后继（调用方已排除 id 落在 (self, successor] 内的情况）
+    uint32_t next = geometry->nextHop(links.data(), links.size(), self.id, id);
+    return next == self.id && !successor.isEmpty() ? successor.id : next;
+}
+
+/**
+ * @brief 把节点ID解析为完整节点信息（含 IP），仅在需要展示或对外返回时调用
+ * @param id 节点ID
+ * @return Node 节点信息；节点已不在环中时 IP 为空
+ */
+Node Chord::resolveNode(uint32_t id) const
+{
+    if (id == self.id)
+        return self;
+    if (id == successor.id && !successor.isEmpty())
+        return successor;
+    if (id == predecessor.id && !predecessor.isEmpty())
+        return predecessor;
+    Chord *chord = proxy ? proxy->findChordNodeByID(id) : nullptr;
+    return chord ? chord->getSelf() : Node(id, "");
 }
 
 /**
@@ -694,19 +1226,19 @@ Node Chord::findPredecessor(uint32_t id)
 
         // 向前推进到更接近的节点
         // 在当前节点的finger table中查找最接近目标id的前驱节点
-        Node next = currentChord->findClosestPrecedingNode(id);
+        uint32_t next = currentChord->closestPrecedingFinger(id);
 
         // 检查是否需要退出循环
         // 如果找不到更接近的节点，或者找到的节点就是当前节点
         // 说明已经到达查找的终点
-        if (next.id == current.id || next.isEmpty())
+        if (next == current.id)
         {
             logger.info("findPredecessor: no closer node found, current hop: " + to_string(hops));
             break;
         }
 
         // 更新当前节点，继续下一轮查找
-        current = next;
+        current = currentChord->resolveNode(next);
     }
 
     // 5.查找结束处理
@@ -734,19 +1266,26 @@ void Chord::initWithBootstrapNode(Node &bootstrapNode)
         Chord *bootstrapChord = proxy->findChordNodeByID(bootstrapNode.id);
         if (!bootstrapChord)
             throw runtime_error("无法获取引导节点");
+        proxy->sendMessage(self, bootstrapNode);
         Node successorNode = bootstrapChord->findSuccessor(self.id);
         if (successorNode.isEmpty())
             throw runtime_error("无法找到后继");
+        proxy->sendMessage(bootstrapNode, self);
 
         logger.info("找到后继: " + successorNode.toString() + ", bootstrap=" + bootstrapNode.toString() + ", successorNode == bootstrapNode: " + string(successorNode == bootstrapNode ? "true" : "false"));
 
         successor = successorNode;
-        fingerTable[0].node = successorNode;
+        fingerIds[0] = successorNode.id;
 
         Chord *successorChord = proxy->findChordNodeByID(successorNode.id);
         Node oldPredecessorOfSuccessor;
         if (successorChord)
+        {
+            // 向后继询问其前驱，并通知后继自己成为新前驱
+            proxy->sendMessage(self, successorNode);
+            proxy->sendMessage(successorNode, self);
             oldPredecessorOfSuccessor = successorChord->getPredecessor();
+        }
         if (!oldPredecessorOfSuccessor.isEmpty() && oldPredecessorOfSuccessor != self)
         {
             predecessor = oldPredecessorOfSuccessor;
@@ -762,14 +1301,25 @@ void Chord::initWithBootstrapNode(Node &bootstrapNode)
         if (!oldPredecessorOfSuccessor.isEmpty() && oldPredecessorOfSuccessor != self && oldPredecessorOfSuccessor != successorNode)
         {
             Chord *oldPredChord = proxy->findChordNodeByID(oldPredecessorOfSuccessor.id);
+            proxy->sendMessage(self, oldPredecessorOfSuccessor);
             if (oldPredChord)
                 oldPredChord->setSuccessor(self);
         }
 
-        initFingerTable();
-        notifyRelevantNodes();
+        // 单跳：从后继取得全成员表并在本地算出 finger，不做 finger 查找
+        bool full = geometry->fullMembership();
+        if (full)
+            copyMembership(successorChord);
+        else
+            initFingerTable();
+        // 单跳与 gossip 模式经代理把自身加入的增量推送给其余节点，否则直接更新半个环
+        if (full || proxy->isGossipEnabled())
+            proxy->notifyNodeUpdate(self);
+        else
+            notifyRelevantNodes();
         redistributeResources();
-        fixFingers();
+        if (!full)
+            fixFingers();
 
         logger.info("节点 " + self.toString() + " 初始化完成");
     }
@@ -788,20 +1338,27 @@ void Chord::initFingerTable()
     if (!proxy)
     {
         for (int i = 1; i < m; i++)
-            fingerTable[i].node = successor;
+            fingerIds[i] = successor.id;
         return;
     }
 
-    fingerTable[0].node = successor;
+    fingerIds[0] = successor.id;
 
     for (int i = 1; i < m; i++)
     {
-        uint32_t start = fingerTable[i].startId;
+        uint32_t start = getFingerStart(i);
         Node succ = proxy->findSuccessorFromAny(start);
         if (!succ.isEmpty())
-            fingerTable[i].node = succ;
+            fingerIds[i] = succ.id;
         else
-            fingerTable[i].node = successor;
+            fingerIds[i] = successor.id;
+        // 网络模拟：每个新出现的 finger 节点计一次往返（乐观估计，由后继代为查找的跳数不计）
+        if (fingerIds[i] != fingerIds[i - 1] && fingerIds[i] != self.id)
+        {
+            Node finger = resolveNode(fingerIds[i]);
+            proxy->sendMessage(self, finger);
+            proxy->sendMessage(finger, self);
+        }
     }
 }
 
@@ -849,14 +1406,22 @@ void Chord::notifyRelevantNodes()
         return;
 
     int half = n / 2;
+    vector<Node> notified;
+    bool network = proxy->isNetworkEnabled();
     for (int i = 1; i <= half; i++)
     {
         int idx = (selfPos - i + n) % n;
         uint32_t otherId = allIds[idx];
         Chord *chord = proxy->findChordNodeByID(otherId);
         if (chord)
+        {
             chord->updateFingerTable(self);
+            if (network)
+                notified.push_back(chord->getSelf());
+        }
     }
+    // 各节点的通知互不依赖，按并发发送计时
+    proxy->sendMessages(self, notified);
 }
 
 /**
@@ -869,22 +1434,22 @@ void Chord::updateFingerTable(Node &newNode)
         return;
     for (int i = 0; i < m; i++)
     {
-        uint32_t start = fingerTable[i].startId;
-        Node current = fingerTable[i].node;
+        uint32_t start = getFingerStart(i);
+        uint32_t current = fingerIds[i];
 
         bool shouldUpdate = false;
         if (newNode.id == start)
         {
             shouldUpdate = true;
         }
-        else if (isInOpenInterval(newNode.id, start, current.id))
+        else if (isInOpenInterval(newNode.id, start, current))
         {
             shouldUpdate = true;
         }
 
-        if (shouldUpdate && newNode != current)
+        if (shouldUpdate && newNode.id != current)
         {
-            fingerTable[i].node = newNode;
+            fingerIds[i] = newNode.id;
             if (i == 0)
                 successor = newNode;
         }
@@ -900,11 +1465,11 @@ void Chord::fixFingers()
         return;
     for (int i = 1; i < m; i++)
     {
-        Node succ = proxy->findSuccessorFromAny(fingerTable[i].startId);
+        Node succ = proxy->findSuccessorFromAny(getFingerStart(i));
         if (!succ.isEmpty())
-            fingerTable[i].node = succ;
+            fingerIds[i] = succ.id;
         else if (!successor.isEmpty())
-            fingerTable[i].node = successor;
+            fingerIds[i] = successor.id;
     }
 }
 
@@ -958,24 +1523,8 @@ void Chord::redistributeResources()
     if (!succChord)
         return;
 
-    auto succRes = succChord->getAllResources();
-    vector<pair<uint32_t, string>> toTransfer;
-
-    for (auto &res : succRes)
-    {
-        if (isInInterval(res.first, predecessor.id, self.id))
-        {
-            toTransfer.push_back(res);
-        }
-    }
-
-    for (auto &res : toTransfer)
-    {
-        if (succChord->removeResourceDirectly(res.first))
-        {
-            resources[res.first] = res.second;
-        }
-    }
+    // 只迁移 (predecessor, self] 区间内的资源，由后继按分块推送过来
+    succChord->streamRangeTo(this, predecessor.id, self.id, proxy->getMigrationOptions());
 }
 
 /**
@@ -986,39 +1535,172 @@ bool Chord::transferResources()
 {
     if (!proxy || resources.empty() || successor == self)
         return true;
-    for (auto &res : resources)
+    Chord *succChord = proxy->findChordNodeByID(successor.id);
+    if (!succChord)
     {
-        proxy->transferResourceToNode(successor, res.second);
-    }
-    resources.clear();
+        // 后继不可达时退回逐个转移
+        for (auto &res : resources)
+        {
+            proxy->sendMessage(self, successor, res.second.size());
+            proxy->transferResourceToNode(successor, res.second);
+        }
+        resources.clear();
+        clearDeadlines();
+        rebuildFilter();
+        return true;
+    }
+    // 离开时把全部资源整体推送给后继（start == end 表示整个环）
+    streamRangeTo(succChord, self.id, self.id, proxy->getMigrationOptions());
     return true;
 }
 
+/**
+ * @brief 将 (start, end] 区间内的资源按分块迁移到目标节点；start == end 时迁移全部资源
+ *        区间在 ID 空间上拆成至多两段有序区间，每个分块从 map 中连续摘出（资源内容移动而非拷贝），
+ *        目标节点按序插入，不重新计算哈希
+ * @param target 目标节点
+ * @param start 区间起点（不包含）
+ * @param end 区间终点（包含）
+ * @param options 分块大小、限速与进度回调
+ * @return size_t 迁移的资源数
+ */
+size_t Chord::streamRangeTo(Chord *target, uint32_t start, uint32_t end, const MigrationOptions &options)
+{
+    if (!target || target == this)
+        return 0;
+
+    // 拆分为闭区间 [lo, hi] 的有序段
+    vector<pair<uint32_t, uint32_t>> segments;
+    if (start == end)
+        segments.push_back(make_pair(0u, ID_SPACE - 1));
+    else if (start < end)
+        segments.push_back(make_pair(start + 1, end));
+    else
+    {
+        if (start + 1 < ID_SPACE)
+            segments.push_back(make_pair(start + 1, ID_SPACE - 1));
+        segments.push_back(make_pair(0u, end));
+    }
+
+    size_t chunkSize = options.chunkSize == 0 ? 1 : options.chunkSize;
+    MigrationProgress progress = {self.id, target->getSelf().id, 0, 0, 0, false};
+    auto begin = chrono::steady_clock::now();
+    ResourceChunk chunk;
+    chunk.reserve(min(chunkSize, resources.size()));
+
+    for (auto &seg : segments)
+    {
+        auto it = resources.lower_bound(seg.first);
+        while (it != resources.end() && it->first <= seg.second)
+        {
+            auto first = it;
+            chunk.clear();
+            size_t bytes = 0;
+            while (it != resources.end() && it->first <= seg.second && chunk.size() < chunkSize)
+            {
+                bytes += it->second.size();
+                chunk.emplace_back(it->first, std::move(it->second));
+                ++it;
+            }
+            uint32_t lo = chunk.front().first, hi = chunk.back().first;
+
+            // 先由接收方落盘，再删除本地区间，崩溃时最多重复而不会丢失
+            if (proxy)
+                proxy->sendMessage(self, target->self, bytes + chunk.size() * sizeof(uint32_t));
+            target->receiveResources(self, chunk);
+            if (!deadlines.empty())
+                handOverDeadlines(target, chunk);
+            resources.erase(first, it);
+            filterRemoved(chunk.size());
+            if (proxy)
+                proxy->logResourceRangeRemove(self, lo, hi);
+
+            progress.movedKeys += chunk.size();
+            progress.movedBytes += bytes;
+            progress.chunks++;
+            if (options.onProgress)
+                options.onProgress(progress);
+
+            if (options.maxKeysPerSecond > 0)
+            {
+                auto due = begin + chrono::duration_cast<chrono::steady_clock::duration>(
+                                       chrono::duration<double>(progress.movedKeys / options.maxKeysPerSecond));
+                this_thread::sleep_until(due);
+            }
+        }
+    }
+
+    progress.done = true;
+    if (options.onProgress)
+        options.onProgress(progress);
+    if (proxy)
+        proxy->recordMigration(progress);
+    if (progress.movedKeys > 0)
+        logger.info("区间迁移: " + self.toString() + " -> " + target->getSelf().toString() + ", 资源 " +
+                    to_string(progress.movedKeys) + ", 字节 " + to_string(progress.movedBytes) + ", 分块 " + to_string(progress.chunks));
+    return progress.movedKeys;
+}
+
+/**
+ * @brief 接收一个迁移分块（分块内资源ID升序），资源内容直接移动进本地存储
+ * @param from 发送方节点
+ * @param chunk 资源分块，调用后其中的资源内容被移走
+ */
+void Chord::receiveResources(const Node &from, ResourceChunk &chunk)
+{
+    if (chunk.empty())
+        return;
+    if (proxy)
+        proxy->logResourceChunkTransfer(from, self, chunk);
+    auto hint = resources.lower_bound(chunk.front().first);
+    for (auto &res : chunk)
+    {
+        hint = resources.emplace_hint(hint, res.first, std::move(res.second));
+        ++hint;
+    }
+    if (resources.size() > filterCapacity)
+        rebuildFilter();
+    else
+        for (auto &res : chunk)
+            filter.insert(res.first);
+}
+
 /**
  * @brief 离开Chord环
+ * @param graceful true 时先把资源转移给后继；false 模拟崩溃，资源直接丢失，
+ *        前驱/后继的修补等价于 check_predecessor 与 stabilize 检测到失效后的结果
  * @return 如果离开成功返回true，否则返回false
  */
-bool Chord::leaveRing()
+bool Chord::leaveRing(bool graceful)
 {
     if (!proxy)
         return false;
     if (successor == self)
     {
         resources.clear();
+        clearDeadlines();
+        rebuildFilter();
         return true;
     }
 
-    transferResources();
+    if (graceful)
+        transferResources();
+    else
+        logger.warning(self.toString() + " 崩溃，丢失资源 " + to_string(resources.size()));
 
     if (!predecessor.isEmpty() && predecessor != self)
     {
         Chord *predChord = proxy->findChordNodeByID(predecessor.id);
+        if (graceful)
+            proxy->sendMessage(self, predecessor);
         if (predChord)
             predChord->setSuccessor(successor);
     }
     if (!successor.isEmpty() && successor != self)
     {
         Chord *succChord = proxy->findChordNodeByID(successor.id);
+        if (graceful)
+            proxy->sendMessage(self, successor);
         if (succChord)
             succChord->setPredecessor(predecessor);
     }
@@ -1026,6 +1708,8 @@ bool Chord::leaveRing()
     predecessor = Node();
     successor = Node();
     resources.clear();
+    clearDeadlines();
+    rebuildFilter();
     logger.info(self.toString() + " 已离开");
     return true;
 }
@@ -1038,6 +1722,11 @@ void Chord::handleNodeLeave(Node &leftNode)
 {
     if (leftNode.isEmpty() || leftNode == self)
         return;
+    if (geometry->fullMembership())
+    {
+        removeMember(leftNode);
+        return;
+    }
 
     if (successor == leftNode)
     {
@@ -1074,12 +1763,12 @@ void Chord::handleNodeLeave(Node &leftNode)
         if (!newSucc.isEmpty() && newSucc != leftNode)
         {
             successor = newSucc;
-            fingerTable[0].node = newSucc;
+            fingerIds[0] = newSucc.id;
         }
         else
         {
             successor = self;
-            fingerTable[0].node = self;
+            fingerIds[0] = self.id;
         }
     }
 
@@ -1090,16 +1779,16 @@ void Chord::handleNodeLeave(Node &leftNode)
 
     for (int i = 1; i < m; i++)
     {
-        if (fingerTable[i].node == leftNode)
+        if (fingerIds[i] == leftNode.id)
         {
-            Node newSucc = proxy->findSuccessorFromAny(fingerTable[i].startId);
+            Node newSucc = proxy->findSuccessorFromAny(getFingerStart(i));
             if (!newSucc.isEmpty() && newSucc != leftNode)
             {
-                fingerTable[i].node = newSucc;
+                fingerIds[i] = newSucc.id;
             }
             else
             {
-                fingerTable[i].node = successor.isEmpty() ? self : successor;
+                fingerIds[i] = successor.isEmpty() ? self.id : successor.id;
             }
         }
     }
@@ -1114,10 +1803,13 @@ void Chord::handleNodeLeave(Node &leftNode)
  */
 bool Chord::addResource(string resource)
 {
-    uint32_t rid = sha1_hash_to_uint32(resource) % ID_SPACE;
+    uint32_t rid = proxy ? proxy->resourceIdOf(resource) : hashedKeyId(resource);
     if (resources.count(rid))
         return false;
     resources[rid] = resource;
+    filterAdded(rid);
+    if (proxy)
+        proxy->logResourcePut(self, rid, resource);
     return true;
 }
 
@@ -1131,6 +1823,10 @@ bool Chord::addResourceDirectly(uint32_t rid, const string &res)
 {
     logger.info("addResourceDirectly: " + self.toString() + " -> " + to_string(rid));
     resources[rid] = res;
+    forgetDeadline(rid);
+    filterAdded(rid);
+    if (proxy)
+        proxy->logResourcePut(self, rid, res);
     return true;
 }
 
@@ -1138,7 +1834,7 @@ bool Chord::addResourceDirectly(uint32_t rid, const string &res)
  * @brief 获取Chord环中的所有资源
  * @return 资源ID到资源内容的映射
  */
-map<uint32_t, string> Chord::getAllResources() const { return resources; }
+map<uint32_t, string> Chord::getAllResources() const { return map<uint32_t, string>(resources.begin(), resources.end()); }
 
 /**
  * @brief 直接移除Chord环中的资源
@@ -1152,6 +1848,10 @@ bool Chord::removeResourceDirectly(uint32_t rid)
     if (it != resources.end())
     {
         resources.erase(it);
+        forgetDeadline(rid);
+        filterRemoved(1);
+        if (proxy)
+            proxy->logResourceRemove(self, rid);
         return true;
     }
     return false;
@@ -1160,6 +1860,388 @@ bool Chord::removeResourceDirectly(uint32_t rid)
 Node Chord::getSelf() const { return self; }
 Node Chord::getSuccessor() const { return successor; }
 Node Chord::getPredecessor() const { return predecessor; }
+Node Chord::getFingerNode(int i) const { return resolveNode(fingerIds[i]); }
+uint32_t Chord::getFingerId(int i) const { return fingerIds[i]; }
+uint32_t Chord::getFingerStart(int i) const { return (self.id + (1u << i)) % ID_SPACE; }
+const ResourceMap &Chord::getResourceMap() const { return resources; }
+
+/**
+ * @brief 直接设置前驱与后继（从镜像恢复时使用，不通知其他节点）
+ * @param pred 前驱节点
+ * @param succ 后继节点
+ */
+void Chord::restoreRouting(const Node &pred, const Node &succ)
+{
+    predecessor = pred;
+    successor = succ;
+    fingerIds[0] = succ.isEmpty() ? self.id : succ.id;
+}
+
+void Chord::setFingerNode(int i, const Node &n) { fingerIds[i] = n.isEmpty() ? self.id : n.id; }
+void Chord::setFingerId(int i, uint32_t id, float rttMs)
+{
+    fingerIds[i] = id;
+    fingerRtt[i] = rttMs;
+}
+
+float Chord::getFingerRtt(int i) const { return fingerRtt[i]; }
+
+void Chord::setRouting(const RoutingGeometry *geometry, const vector<uint32_t> &links)
+{
+    this->geometry = geometry;
+    this->links = links;
+    if (!this->links.empty())
+        this->links.resize((links.size() + FINGER_LANES - 1) / FINGER_LANES * FINGER_LANES, self.id);
+    else
+        this->links.shrink_to_fit();
+}
+
+vector<uint32_t> Chord::getLinks() const
+{
+    vector<uint32_t> out;
+    for (uint32_t id : links)
+        if (id != self.id)
+            out.push_back(id);
+    return out;
+}
+
+/**
+ * @brief 路由表中的不同远程节点：finger 数组（或链接表）加上前驱与后继，去掉自身
+ * @return vector<uint32_t> 升序的节点ID
+ */
+vector<uint32_t> Chord::getRoutingEntries() const
+{
+    vector<uint32_t> out = links.empty() ? vector<uint32_t>(fingerIds, fingerIds + m) : links;
+    if (!successor.isEmpty())
+        out.push_back(successor.id);
+    if (!predecessor.isEmpty())
+        out.push_back(predecessor.id);
+    sort(out.begin(), out.end());
+    out.erase(unique(out.begin(), out.end()), out.end());
+    out.erase(remove(out.begin(), out.end(), self.id), out.end());
+    return out;
+}
+
+size_t Chord::linkCount() const
+{
+    size_t count = links.size();
+    while (count > 0 && links[count - 1] == self.id)
+        count--;
+    return count;
+}
+
+void Chord::padLinks(size_t count)
+{
+    links.resize(count);
+    if (count > 0)
+        links.resize((count + FINGER_LANES - 1) / FINGER_LANES * FINGER_LANES, self.id);
+}
+
+uint32_t Chord::memberOwner(uint32_t id) const
+{
+    uint32_t out = self.id;
+    if (!links.empty())
+        geometry->owner(links.data(), links.size(), self.id, id, out);
+    return out;
+}
+
+vector<uint32_t>::iterator Chord::memberSlot(uint32_t id, size_t count)
+{
+    const uint32_t mask = ID_SPACE - 1, distance = (id - self.id) & mask;
+    return lower_bound(links.begin(), links.begin() + count, distance, [this, mask](uint32_t member, uint32_t d)
+                       { return ((member - self.id) & mask) < d; });
+}
+
+/**
+ * @brief 单跳加入：后继的全成员表加上后继自身即除新节点外的全部成员，旋转成从自身起的顺时针顺序；
+ *        finger 按 start 在表中二分查找得到，代价 O(N + m·logN)，只有一次 N 个 ID 的传输
+ * @param from 新节点的后继，为空时退回代理提供的有序成员
+ */
+void Chord::copyMembership(const Chord *from)
+{
+    vector<uint32_t> members = from ? from->getLinks() : proxy->getAllSortedNodeIds();
+    if (from)
+    {
+        members.push_back(from->self.id);
+        proxy->sendMessage(from->self, self, members.size() * sizeof(uint32_t));
+    }
+    members.erase(remove(members.begin(), members.end(), self.id), members.end());
+    sort(members.begin(), members.end());
+    rotate(members.begin(), upper_bound(members.begin(), members.end(), self.id), members.end());
+    setRouting(geometry, members);
+    for (int i = 1; i < m; i++)
+        fingerIds[i] = memberOwner(getFingerStart(i));
+}
+
+/**
+ * @brief 成员加入的增量：按顺时针位置插入全成员表（一次 O(N) 的移动），finger 与后继/前驱按原有的本地规则修补
+ * @param node 新加入的节点
+ */
+void Chord::addMember(Node &node)
+{
+    if (node.isEmpty() || node == self)
+        return;
+    size_t count = linkCount();
+    auto pos = memberSlot(node.id, count);
+    if (pos != links.begin() + count && *pos == node.id)
+        return;
+    links.insert(pos, node.id);
+    padLinks(count + 1);
+    updateFingerTable(node);
+    notifyPredecessor(node);
+}
+
+/**
+ * @brief 成员离开的增量：从全成员表删除，指向离开节点的后继、前驱与 finger 改为表中的后继/前驱，只做本地计算
+ * @param node 离开的节点
+ */
+void Chord::removeMember(const Node &node)
+{
+    size_t count = linkCount();
+    auto pos = memberSlot(node.id, count);
+    if (pos == links.begin() + count || *pos != node.id)
+        return;
+    links.erase(pos);
+    padLinks(count - 1);
+    count--;
+    if (successor == node)
+    {
+        successor = resolveNode(count ? links[0] : self.id);
+        fingerIds[0] = successor.id;
+    }
+    if (predecessor == node)
+        predecessor = count ? resolveNode(links[count - 1]) : self;
+    for (int i = 1; i < m; i++)
+        if (fingerIds[i] == node.id)
+            fingerIds[i] = memberOwner(getFingerStart(i));
+}
+
+/**
+ * @brief gossip 传来的加入：单跳插入成员表，其余几何按 updateFingerTable 修补 finger，链接表交给几何就地修补
+ * @param node 新加入的节点
+ */
+void Chord::handleMemberJoin(Node &node)
+{
+    if (geometry->fullMembership())
+    {
+        addMember(node);
+        return;
+    }
+    updateFingerTable(node);
+    if (!geometry->usesFingerTable())
+    {
+        vector<uint32_t> current = getLinks();
+        geometry->linkJoined(self.id, successor.id, current, node.id);
+        if (current.size() != linkCount())
+            setRouting(geometry, current);
+    }
+}
+
+/**
+ * @brief gossip 传来的离开或失效：离开节点负责的区间由 successorId 接替，原先指向它的后继与 finger 改指 successorId
+ *        （finger k 指向离开节点当且仅当 start_k 落在其负责区间内），链接表交给几何就地修补，只做本地计算，不发起查找
+ * @param left 离开的节点
+ * @param successorId 离开后接替它的节点
+ */
+void Chord::handleMemberLeave(const Node &left, uint32_t successorId)
+{
+    if (geometry->fullMembership())
+    {
+        removeMember(left);
+        return;
+    }
+    if (successor == left)
+        successor = resolveNode(successorId);
+    for (int i = 0; i < m; i++)
+        if (fingerIds[i] == left.id)
+            fingerIds[i] = successorId;
+    if (!geometry->usesFingerTable() && find(links.begin(), links.end(), left.id) != links.end())
+    {
+        vector<uint32_t> current = getLinks();
+        geometry->linkLeft(self.id, successor.id, current, left.id, successorId);
+        setRouting(geometry, current);
+    }
+}
+
+/**
+ * @brief 恢复资源（按资源ID升序调用时为均摊 O(1) 插入，不写日志）
+ * @param rid 资源ID
+ * @param res 资源内容
+ */
+void Chord::restoreResource(uint32_t rid, const string &res)
+{
+    resources.emplace_hint(resources.end(), rid, res);
+    filterAdded(rid);
+}
+
+/**
+ * @brief 新资源放入 resources 后更新过滤器，资源数超过容量时按两倍容量重建
+ * @param rid 资源ID
+ */
+void Chord::filterAdded(uint32_t rid)
+{
+    if (resources.size() > filterCapacity)
+        rebuildFilter();
+    else
+        filter.insert(rid);
+}
+
+/**
+ * @brief 记录删除或迁出的资源数，残留键超过容量的一半时重建（重建代价均摊到每次删除为 O(1)）
+ * @param count 删除的资源数
+ */
+void Chord::filterRemoved(size_t count)
+{
+    filterStale += static_cast<uint32_t>(count);
+    if (filterStale > filterCapacity / 2)
+        rebuildFilter();
+}
+
+/**
+ * @brief 按当前资源重建过滤器，容量取资源数的两倍（至少占满一个块），没有资源时释放内存
+ */
+void Chord::rebuildFilter()
+{
+    filterStale = 0;
+    if (resources.empty())
+    {
+        filter.clear();
+        filterCapacity = 0;
+        return;
+    }
+    filterCapacity = static_cast<uint32_t>(max<size_t>(BlockedBloomFilter::BLOCK_WORDS * 64 / BlockedBloomFilter::BITS_PER_KEY,
+                                                                 resources.size() * 2));
+    filter.reset(filterCapacity);
+    for (auto &res : resources)
+        filter.insert(res.first);
+}
+
+/**
+ * @brief 为已存在的资源设置到期时刻并登记到时间轮（时间轮在第一个带 TTL 的资源到来时分配）
+ * @param rid 资源ID
+ * @param deadlineMs 到期时刻
+ */
+void Chord::setExpiry(uint32_t rid, uint64_t deadlineMs)
+{
+    if (resources.find(rid) == resources.end())
+        return;
+    deadlines[rid] = deadlineMs;
+    if (!wheel)
+        wheel.reset(new TimerWheel(proxy ? proxy->getTtlOptions().tickMs : TtlOptions().tickMs));
+    wheel->schedule(rid, deadlineMs, proxy ? proxy->nowMs() : systemNowMs());
+    if (proxy)
+        proxy->logResourceExpiry(self, rid, deadlineMs);
+}
+
+uint64_t Chord::getDeadline(uint32_t rid) const
+{
+    auto it = deadlines.find(rid);
+    return it == deadlines.end() ? 0 : it->second;
+}
+
+bool Chord::isExpired(uint32_t rid, uint64_t nowMs) const
+{
+    if (deadlines.empty())
+        return false;
+    auto it = deadlines.find(rid);
+    return it != deadlines.end() && it->second <= nowMs;
+}
+
+/**
+ * @brief 读取时惰性删除：资源已过期则删除。到期删除不写日志，恢复时到期时刻已持久化，资源会再次过期
+ * @param rid 资源ID
+ * @param nowMs 当前时刻
+ * @return true 若资源已过期并被删除
+ */
+bool Chord::dropIfExpired(uint32_t rid, uint64_t nowMs)
+{
+    auto it = deadlines.find(rid);
+    if (it == deadlines.end() || it->second > nowMs)
+        return false;
+    deadlines.erase(it);
+    resources.erase(rid);
+    filterRemoved(1);
+    if (deadlines.empty())
+        wheel.reset();
+    return true;
+}
+
+/**
+ * @brief 推进时间轮并批量删除到期资源；删除、迁出或改期后残留的旧条目按到期时刻比对后丢弃
+ * @param nowMs 当前时刻
+ * @param limit 本次最多处理的到期条目数（按刻度整批结算），0 表示不限
+ * @return size_t 删除的资源数
+ */
+size_t Chord::expireDue(uint64_t nowMs, size_t limit)
+{
+    if (!wheel)
+        return 0;
+    vector<pair<uint32_t, uint64_t>> due;
+    wheel->advance(nowMs, due, limit);
+    size_t removed = 0;
+    for (auto &d : due)
+    {
+        auto it = deadlines.find(d.first);
+        if (it == deadlines.end() || it->second != d.second)
+            continue;
+        deadlines.erase(it);
+        resources.erase(d.first);
+        removed++;
+    }
+    if (removed > 0)
+        filterRemoved(removed);
+    if (deadlines.empty())
+        wheel.reset(); // 只剩残留条目，整个时间轮一并释放
+    return removed;
+}
+
+/**
+ * @brief 迁移分块已交给接收方后，把其中带 TTL 的资源的到期时刻一并移交（接收方在分块记录之后写到期记录）
+ * @param target 接收方
+ * @param chunk 已迁移的分块（只使用其中的资源ID）
+ */
+void Chord::handOverDeadlines(Chord *target, const ResourceChunk &chunk)
+{
+    for (auto &res : chunk)
+    {
+        auto it = deadlines.find(res.first);
+        if (it == deadlines.end())
+            continue;
+        target->setExpiry(res.first, it->second);
+        deadlines.erase(it);
+    }
+    if (deadlines.empty())
+        wheel.reset();
+}
+
+void Chord::forgetDeadline(uint32_t rid)
+{
+    if (deadlines.erase(rid) && deadlines.empty())
+        wheel.reset();
+}
+
+void Chord::clearDeadlines()
+{
+    deadlines.clear();
+    wheel.reset();
+}
+
+const DeadlineMap &Chord::getDeadlines() const { return deadlines; }
+
+size_t Chord::getTtlMemoryBytes() const
+{
+    size_t bytes = wheel ? wheel->memoryBytes() : 0;
+    return bytes + deadlines.bucket_count() * sizeof(void *) +
+           deadlines.size() * (sizeof(DeadlineMap::value_type) + sizeof(void *));
+}
+
+size_t Chord::getWheelEntries() const { return wheel ? wheel->size() : 0; }
+const RoutingLoad &Chord::getRoutingLoad() const { return load; }
+void Chord::recordEntry() { load.entries++; }
+void Chord::resetRoutingLoad() { load = RoutingLoad(); }
+
+bool Chord::mayContainResource(uint32_t rid) const { return filter.mayContain(rid); }
+const BlockedBloomFilter &Chord::getFilter() const { return filter; }
 int Chord::getResourceCount() const { return resources.size(); }
 
 void Chord::setPredecessor(const Node &n)
@@ -1172,7 +2254,7 @@ void Chord::setSuccessor(const Node &n)
 {
     logger.info("setSuccessor: " + self.toString() + " -> " + n.toString());
     successor = n;
-    fingerTable[0].node = n;
+    fingerIds[0] = n.isEmpty() ? self.id : n.id;
 }
 
 void Chord::showNodeInfo() const
@@ -1185,21 +2267,37 @@ void Chord::showNodeInfo() const
         cout << "  无" << endl;
     else
     {
+        uint64_t now = deadlines.empty() ? 0 : (proxy ? proxy->nowMs() : systemNowMs());
         for (const auto &res : resources)
         {
-            cout << "  ID: " << res.first << " -> " << res.second << endl;
+            cout << "  ID: " << res.first << " -> " << res.second;
+            uint64_t deadline = getDeadline(res.first);
+            if (deadline > now)
+                cout << "  TTL 剩余 " << deadline - now << " ms";
+            else if (deadline > 0)
+                cout << "  已过期";
+            cout << endl;
         }
     }
+    cout << "路由负载: 入口 " << load.entries << "，转发 " << load.forwards << "，确定后继 " << load.resolves << endl;
     cout << "Finger Table:" << endl;
     for (int i = 0; i < m; i++)
     {
-        cout << "  [" << i << "] " << fingerTable[i].startId << " -> ";
-        if (fingerTable[i].node.isEmpty())
-            cout << "EMPTY";
-        else
-            cout << fingerTable[i].node.toString();
+        cout << "  [" << i << "] " << getFingerStart(i) << " -> " << getFingerNode(i).toString();
+        if (fingerRtt[i] > 0)
+            cout << "  RTT " << fingerRtt[i] << " ms";
         cout << endl;
     }
+    vector<uint32_t> linked = getLinks();
+    if (!linked.empty())
+    {
+        const size_t shown = 32; // 单跳的全成员表可能有数千项，只列出前面一部分
+        cout << "链接表 (" << geometryName(geometry->kind()) << "，" << linked.size() << " 个，路由时代替 finger 表):" << endl;
+        for (size_t i = 0; i < linked.size() && i < shown; i++)
+            cout << "  " << resolveNode(linked[i]).toString() << endl;
+        if (linked.size() > shown)
+            cout << "  ... 另有 " << linked.size() - shown << " 个" << endl;
+    }
     cout << "============================================" << endl;
 }
 
@@ -1218,22 +2316,24 @@ bool ChordRingManager::join(const std::string &ip)
         return false;
     }
     Node newNode(ip);
-    Chord *chord = new Chord(newNode, &proxy);
+    Chord *chord = createChord(newNode);
     if (!join(newNode, chord))
     {
-        delete chord;
+        destroyChord(chord);
         return false;
     }
     chord->joinRing();
+    checkpoint();
     return true;
 }
 
 /**
  * @brief 移除Chord环中的节点
  * @param ip 节点IP
+ * @param graceful false 表示节点崩溃，资源不转移
  * @return 如果移除成功返回true，否则返回false
  */
-bool ChordRingManager::removeNodeByIP(const std::string &ip)
+bool ChordRingManager::removeNodeByIP(const std::string &ip, bool graceful)
 {
     Node node = getNodeByIP(ip);
     if (node.isEmpty())
@@ -1241,7 +2341,7 @@ bool ChordRingManager::removeNodeByIP(const std::string &ip)
         logger.warning("节点IP " + ip + " 不存在，无法删除");
         return false;
     }
-    return removeNode(node);
+    return removeNode(node, graceful);
 }
 
 /**
@@ -1251,12 +2351,14 @@ bool ChordRingManager::removeNodeByIP(const std::string &ip)
  */
 Node ChordRingManager::getNodeByIP(const std::string &ip) const
 {
-    for (const auto &p : chordNodes)
-    {
-        if (p.second->getSelf().ip == ip)
-            return p.second->getSelf();
-    }
-    return Node();
+    // 先在注册表的哈希索引中找到驻留记录，再按其ID定位节点；同一ID上的节点必须是同一条记录
+    const NodeRecord *record = NodeRegistry::instance().find(ip);
+    if (record == nullptr)
+        return Node();
+    auto it = chordNodes.find(record->id);
+    if (it == chordNodes.end() || it->second->getSelf().record != record)
+        return Node();
+    return it->second->getSelf();
 }
 
 /**
@@ -1278,7 +2380,7 @@ std::vector<std::string> ChordRingManager::getAllNodeIPs() const
     std::vector<std::string> ips;
     for (const auto &p : chordNodes)
     {
-        ips.push_back(p.second->getSelf().ip);
+        ips.push_back(p.second->getSelf().ip());
     }
     return ips;
 }
@@ -1292,20 +2394,39 @@ bool ChordRingManager::removeResource(const std::string &resourceName)
 {
     if (chordNodes.empty())
         return false;
-    uint32_t rid = sha1_hash_to_uint32(resourceName) % ID_SPACE;
-    Node anyNode = getAnyNode();
+    uint32_t rid = resourceIdOf(resourceName);
+    Node anyNode = enterRing(resourceName.size());
     if (anyNode.isEmpty())
         return false;
     Node responsible = findSuccessor(anyNode, rid);
-    Chord *chord = findChordNode(responsible.id);
-    if (!chord)
+    proxy.sendMessage(anyNode, responsible, resourceName.size());
+    proxy.sendMessage(responsible, anyNode);
+    return removeResourceAt(findChordNode(responsible.id), rid, resourceName);
+}
+
+/**
+ * @brief 在已路由到的负责节点上删除资源（同步与异步接口共用）
+ * @param owner 负责节点
+ * @param rid 资源ID
+ * @param resourceName 资源名称
+ * @return true 若资源存在并已删除
+ */
+bool ChordRingManager::removeResourceAt(Chord *owner, uint32_t rid, const std::string &resourceName)
+{
+    if (!owner)
         return false;
-    const auto &resources = chord->getAllResources();
-    auto it = resources.find(rid);
-    if (it == resources.end())
+    reclaimAt(owner);
+    const auto &resources = owner->getResourceMap();
+    if (resources.find(rid) == resources.end() || expireOnRead(owner, rid))
+        return false;
+    owner->removeResourceDirectly(rid);
+    logger.info("资源 '" + resourceName + "' 从节点 " + owner->getSelf().toString() + " 移除");
+    checkpoint();
+    if (!storage.healthy())
+    {
+        logger.error("资源 '" + resourceName + "' 的删除未能写盘");
         return false;
-    chord->removeResourceDirectly(rid);
-    logger.info("资源 '" + resourceName + "' 从节点 " + responsible.toString() + " 移除");
+    }
     return true;
 }
 
@@ -1316,11 +2437,1281 @@ bool ChordRingManager::removeResource(const std::string &resourceName)
 std::vector<std::string> ChordRingManager::getAllResourceNames() const
 {
     std::vector<std::string> names;
+    uint64_t now = nowMs();
     for (const auto &p : chordNodes)
     {
-        for (const auto &res : p.second->getAllResources())
-            names.push_back(res.second);
+        for (const auto &res : p.second->getResourceMap())
+            if (!p.second->isExpired(res.first, now))
+                names.push_back(res.second);
     }
     return names;
+}
+
+/**
+ * @brief 删除全部节点：不逐个走离开流程（没有节点可以接收资源，也无需刷新 finger 表），
+ *        只记录成员变化并清理各节点的持久化文件，然后整块释放内存池
+ * @return size_t 删除的节点数
+ */
+size_t ChordRingManager::clear()
+{
+    size_t removed = chordNodes.size();
+    for (auto &p : chordNodes)
+        storage.logLeave(p.second->getSelf().ip());
+    storage.commit(); // 离开记录一次写盘，之后逐个删除文件时无需再提交
+    for (auto &p : chordNodes)
+        storage.dropNode(p.first);
+    releaseAllChords();
+    checkpoint();
+    logger.info("删除全部节点: " + to_string(removed) + " 个");
+    return removed;
+}
+
+// ==================== 持久化 ====================
+
+/**
+ * @brief 打开数据目录，加载快照并重放 WAL 尾部恢复整个环
+ * @param options 持久化配置
+ * @return true 若成功打开（无论目录中是否已有数据）
+ * @return false 若无法打开数据目录
+ */
+bool ChordRingManager::openStorage(const StorageOptions &options)
+{
+    auto start = chrono::steady_clock::now();
+    if (!storage.open(options))
+        return false;
+
+    RecoveredRing ring;
+    if (storage.recover(ring))
+    {
+        // 恢复期间重建环的操作不再写日志：先恢复放置方式（范围查询依赖它），
+        // 成员一次性构建（与载入镜像相同，不逐个 join），资源按ID升序直接放回原节点
+        storage.setSuspended(true);
+        placement = ring.placement;
+        bulkLoad(ring.memberIps);
+        // 迁移中途崩溃时发送方的旧副本可能还在（接收方先落盘），不在自己区间内的资源只在负责节点缺少时补过去
+        vector<pair<uint32_t, uint32_t>> strays; // (原节点, 资源ID)
+        for (auto &p : ring.resources)
+        {
+            Chord *chord = findChordNode(p.first);
+            if (!chord)
+                continue;
+            auto timed = ring.deadlines.find(p.first);
+            for (auto &res : p.second)
+            {
+                if (ownerOf(res.first) != chord)
+                {
+                    strays.push_back(make_pair(p.first, res.first));
+                    continue;
+                }
+                chord->restoreResource(res.first, res.second);
+                if (timed != ring.deadlines.end() && timed->second.count(res.first))
+                    chord->setExpiry(res.first, timed->second.at(res.first));
+            }
+        }
+        storage.setSuspended(false);
+        for (auto &s : strays)
+        {
+            Chord *owner = ownerOf(s.second);
+            if (owner->getResourceMap().count(s.second))
+                continue;
+            owner->addResourceDirectly(s.second, ring.resources[s.first][s.second]);
+            auto timed = ring.deadlines.find(s.first);
+            if (timed != ring.deadlines.end() && timed->second.count(s.second))
+                owner->setExpiry(s.second, timed->second.at(s.second));
+        }
+        checkpoint();
+    }
+
+    StorageStats &stats = storage.mutableStats();
+    stats.recoveryMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    logger.info("持久化恢复完成: 节点 " + to_string(stats.recoveredNodes) + ", 资源 " + to_string(stats.recoveredResources) +
+                ", 重放记录 " + to_string(stats.replayedRecords) + ", 耗时 " + to_string(stats.recoveryMs) + " ms");
+    return true;
+}
 
+/**
+ * @brief 获取持久化层
+ * @return ChordStorage& 持久化层引用
+ */
+ChordStorage &ChordRingManager::getStorage() { return storage; }
+
+/**
+ * @brief 提交检查点：为 WAL 过长的节点写快照（这些节点在追加记录时登记，与环的大小无关）
+ */
+void ChordRingManager::checkpoint()
+{
+    if (!storage.isEnabled())
+        return;
+    for (uint32_t id : storage.nodesNeedingSnapshot())
+    {
+        Chord *chord = findChordNode(id);
+        if (chord)
+            storage.writeNodeSnapshot(id, chord->getResourceMap(), chord->getDeadlines());
+    }
+    if (storage.membershipNeedsSnapshot())
+        storage.writeMembershipSnapshot(getAllNodeIPs(), placement);
+}
+
+/**
+ * @brief 显示持久化统计信息
+ */
+void ChordRingManager::showStorageStats() const
+{
+    const StorageStats &stats = storage.getStats();
+    cout << "\n========== 持久化状态 ==========" << endl;
+    if (!storage.isEnabled())
+    {
+        cout << "未启用（启动时指定数据目录以启用）" << endl;
+        cout << "================================" << endl;
+        return;
+    }
+    cout << "启动恢复耗时: " << stats.recoveryMs << " ms" << endl;
+    cout << "恢复节点数: " << stats.recoveredNodes << ", 恢复资源数: " << stats.recoveredResources
+         << ", 重放记录数: " << stats.replayedRecords << endl;
+    cout << "WAL 记录数: " << stats.walRecords << ", 组提交次数: " << stats.groupCommits
+         << ", 写盘失败: " << stats.commitFailures << ", 启动时跳过的旧 WAL: " << stats.staleLogs << endl;
+    cout << "WAL 字节: " << stats.walBytes << ", 快照字节: " << stats.snapshotBytes
+         << " (" << stats.snapshotsWritten << " 个快照)" << endl;
+    cout << "逻辑字节: " << stats.logicalBytes << ", 写放大: " << stats.writeAmplification() << endl;
+    cout << "================================" << endl;
+}
+
+// ==================== 放置方式与范围查询 ====================
+
+/**
+ * @brief 设置资源放置方式；已有资源的ID由旧方式计算，因此仅在环中没有资源时允许切换
+ * @param options 放置配置
+ * @return true 若切换成功
+ * @return false 若环中已有资源
+ */
+bool ChordRingManager::setPlacement(const PlacementOptions &options)
+{
+    for (auto &p : chordNodes)
+    {
+        if (p.second->getResourceCount() > 0)
+        {
+            logger.warning("环中已有资源，无法切换放置方式");
+            return false;
+        }
+    }
+    placement = options;
+    storage.logPlacement(options);
+    filterCache.clear();
+    epoch++; // 资源ID的算法变了，客户端须重新取放置方式
+    logger.info(string("放置方式: ") + (options.mode == PlacementMode::ORDER_PRESERVING ? "保序" : "哈希"));
+    return true;
+}
+
+const PlacementOptions &ChordRingManager::getPlacement() const { return placement; }
+
+/**
+ * @brief 按当前放置方式计算资源ID
+ * @param resource 资源名称
+ * @return uint32_t 资源ID
+ */
+uint32_t ChordRingManager::resourceIdOf(const string &resource) const
+{
+    return placeKey(resource, placement);
+}
+
+/**
+ * @brief 范围查询 [start, end)：先路由到 start 的负责节点，再沿后继依次遍历，
+ *        每个节点内按资源ID有序扫描，结果按字典序分批回调；仅保序放置模式下可用
+ * @param start 起始键（包含）
+ * @param end 结束键（不包含），为空表示不设上界
+ * @param limit 最多返回的结果数，0 表示不限
+ * @param onBatch 批量回调，返回 false 时提前结束
+ * @param batchSize 每批结果数
+ * @return size_t 返回的结果总数
+ */
+size_t ChordRingManager::scan(const string &start, const string &end, size_t limit, const ScanCallback &onBatch, size_t batchSize)
+{
+    if (placement.mode != PlacementMode::ORDER_PRESERVING)
+    {
+        logger.warning("范围查询需要保序放置模式");
+        return 0;
+    }
+    if (chordNodes.empty() || (!end.empty() && end <= start))
+        return 0;
+    if (batchSize == 0)
+        batchSize = 1;
+
+    uint32_t startId = resourceIdOf(start);
+    uint32_t endId = end.empty() ? ID_SPACE - 1 : resourceIdOf(end);
+    Node entry = enterRing(start.size() + end.size());
+    Node current = findSuccessor(entry, startId);
+
+    vector<string> batch;
+    size_t total = 0;
+    bool stopped = false;
+    auto emit = [&](const string &name)
+    {
+        batch.push_back(name);
+        total++;
+        if (batch.size() >= batchSize)
+        {
+            stopped = onBatch && !onBatch(batch);
+            batch.clear();
+        }
+        if (limit > 0 && total >= limit)
+            stopped = true;
+    };
+
+    // 负责 0 附近的节点同时持有环末尾 (最大节点ID, ID_SPACE) 的资源：
+    // 首次访问只扫 [startId, 自身ID]，绕回时再扫末尾一段，保证结果整体有序
+    uint32_t firstId = current.id;
+    uint64_t now = nowMs();
+    for (size_t visited = 0; visited <= chordNodes.size() && !stopped; visited++)
+    {
+        Chord *chord = findChordNode(current.id);
+        if (!chord)
+            break;
+        bool revisit = visited > 0 && current.id == firstId;
+        uint32_t lo = revisit ? max(startId, current.id + 1) : startId;
+        uint32_t hi = (!revisit && startId <= current.id) ? min(endId, current.id) : endId;
+        const auto &res = chord->getResourceMap();
+        for (auto it = res.lower_bound(lo); it != res.end() && it->first <= hi && !stopped; ++it)
+        {
+            if (it->second >= start && (end.empty() || it->second < end) && !chord->isExpired(it->first, now))
+                emit(it->second);
+        }
+        // 当前节点已覆盖到 endId，或已绕过环的末尾（ID 小于 startId 的节点负责到 ID_SPACE-1）
+        if (revisit || current.id >= endId || current.id < startId)
+            break;
+        current = chord->getSuccessor();
+    }
+    if (!batch.empty() && onBatch)
+        onBatch(batch);
+    return total;
+}
+
+/**
+ * @brief 前缀查询：等价于 scan(prefix, prefix 的右开上界)
+ * @param prefix 前缀
+ * @param limit 最多返回的结果数，0 表示不限
+ * @param onBatch 批量回调，返回 false 时提前结束
+ * @param batchSize 每批结果数
+ * @return size_t 返回的结果总数
+ */
+size_t ChordRingManager::scanPrefix(const string &prefix, size_t limit, const ScanCallback &onBatch, size_t batchSize)
+{
+    return scan(prefix, prefixUpperBound(prefix), limit, onBatch, batchSize);
+}
+
+// ==================== 区间迁移 ====================
+
+/**
+ * @brief 设置节点加入/离开时的区间迁移配置（分块大小、限速、进度回调）
+ * @param options 迁移配置
+ */
+void ChordRingManager::setMigrationOptions(const MigrationOptions &options) { migrationOptions = options; }
+
+const MigrationOptions &ChordRingManager::getMigrationOptions() const { return migrationOptions; }
+
+/**
+ * @brief 累计一次迁移的统计
+ * @param progress 迁移进度（done 为 true）
+ */
+void ChordRingManager::recordMigration(const MigrationProgress &progress)
+{
+    migrationStats.migrations++;
+    migrationStats.keysMoved += progress.movedKeys;
+    migrationStats.bytesMoved += progress.movedBytes;
+    migrationStats.chunks += progress.chunks;
+}
+
+const MigrationStats &ChordRingManager::getMigrationStats() const { return migrationStats; }
+
+// ==================== 邻近节点选择 ====================
+
+/**
+ * @brief 设置邻近节点选择配置，立即按新配置重算全部路由表（关闭时恢复精确 finger）
+ * @param options PNS 配置
+ */
+void ChordRingManager::setProximity(const ProximityOptions &options)
+{
+    proximity = options;
+    rebuildRouting();
+}
+
+const ProximityOptions &ChordRingManager::getProximity() const { return proximity; }
+
+// ==================== 路由几何 ====================
+
+/**
+ * @brief 切换路由几何：先让所有节点改用新几何并清空旧链接（不同几何的链接不能沿用），再重算全部路由表
+ * @param options 几何配置
+ */
+void ChordRingManager::setGeometry(const GeometryOptions &options)
+{
+    unique_ptr<RoutingGeometry> next = makeGeometry(options);
+    for (auto &p : chordNodes)
+        p.second->setRouting(next.get(), vector<uint32_t>());
+    geometryOptions = options;
+    geometry = std::move(next);
+    rebuildRouting();
+}
+
+const GeometryOptions &ChordRingManager::getGeometryOptions() const { return geometryOptions; }
+const RoutingGeometry *ChordRingManager::getGeometry() const { return geometry.get(); }
+
+/**
+ * @brief 按当前几何重算各节点的链接表，节点按区间分给多个线程。Chord 几何直接使用 finger 数组，只清空链接表；
+ *        几何允许沿用旧链接时把节点现有的链接交给 buildLinks，仍在环中的保留，成员变化时改动的表项更少
+ */
+void ChordRingManager::rebuildLinks()
+{
+    size_t n = chordNodes.size();
+    const RoutingGeometry *g = geometry.get();
+    if (g->usesFingerTable())
+    {
+        for (auto &p : chordNodes)
+            p.second->setRouting(g, vector<uint32_t>());
+        return;
+    }
+    if (n == 0)
+        return;
+    vector<uint32_t> ids;
+    vector<Chord *> chords;
+    ids.reserve(n);
+    chords.reserve(n);
+    for (auto &p : chordNodes)
+    {
+        ids.push_back(p.first);
+        chords.push_back(p.second);
+    }
+    bool keep = geometry->beginRebuild(n);
+    parallelFor(n, parallelism, [&](size_t begin, size_t end)
+                {
+        vector<uint32_t> previous, out;
+        for (size_t i = begin; i < end; i++)
+        {
+            if (keep)
+                previous = chords[i]->getLinks();
+            out.clear();
+            g->buildLinks(ids, i, previous, out);
+            chords[i]->setRouting(g, out);
+        } });
+}
+
+RoutingStateStats ChordRingManager::getRoutingStateStats() const
+{
+    RoutingStateStats stats;
+    stats.nodes = chordNodes.size();
+    stats.minEntries = stats.nodes ? SIZE_MAX : 0;
+    for (auto &p : chordNodes)
+    {
+        size_t entries = p.second->getRoutingEntries().size();
+        stats.entries += entries;
+        stats.minEntries = min(stats.minEntries, entries);
+        stats.maxEntries = max(stats.maxEntries, entries);
+    }
+    return stats;
+}
+
+// ==================== 成员传播（gossip） ====================
+
+void ChordRingManager::setGossipOptions(const GossipOptions &options) { gossip.setOptions(options); }
+const GossipOptions &ChordRingManager::getGossipOptions() const { return gossip.getOptions(); }
+const GossipStats &ChordRingManager::getGossipStats() const { return gossipStats; }
+const GossipRun &ChordRingManager::getLastGossipRun() const { return lastGossip; }
+
+void ChordRingManager::resetGossipStats()
+{
+    gossipStats = GossipStats();
+    lastGossip = GossipRun();
+}
+
+/**
+ * @brief 节点第一次得知一条成员更新：加入按 handleMemberJoin、离开与失效按接替节点由 handleMemberLeave 就地修补 finger 与链接表，
+ *        开启 PNS 时只重选受影响的 finger；怀疑不改变路由表，变化涉及的节点自身不处理。不做全环重算
+ * @param nodeId 得知更新的节点
+ * @param update 成员更新
+ */
+void ChordRingManager::deliverGossip(uint32_t nodeId, const GossipUpdate &update)
+{
+    Chord *chord = nodeId == update.id ? nullptr : findChordNode(nodeId);
+    if (!chord)
+        return;
+    function<double(const Node &, const Node &)> rtt =
+        proximity.enabled && !geometry->fullMembership() ? rttSource() : nullptr;
+    if (update.state == MemberState::ALIVE)
+    {
+        Chord *joined = findChordNode(update.id);
+        if (!joined)
+            return;
+        Node node = joined->getSelf();
+        chord->handleMemberJoin(node);
+        // PNS：新成员只可能成为它所在的那一个 finger 区间 [self + 2^k, self + 2^(k+1)) 的候选
+        if (rtt)
+        {
+            uint32_t distance = (update.id - chord->getSelf().id) & (ID_SPACE - 1);
+            int k = 0;
+            while (k + 1 < m && (distance >> (k + 1)) != 0)
+                k++;
+            repickProximateFinger(chord, k, rtt);
+            if (k != 0 && chord->getSuccessor().id == update.id)
+                repickProximateFinger(chord, 0, rtt); // 新成员成了后继，更新后继的 RTT
+        }
+    }
+    else if (update.state == MemberState::DEAD || update.state == MemberState::LEFT)
+    {
+        // PNS：指向离开节点的 finger 被改指接替者，接替者可能已越出区间，逐个重选
+        vector<int> affected;
+        for (int k = 0; k < m && rtt; k++)
+            if (chord->getFingerId(k) == update.id)
+                affected.push_back(k);
+        chord->handleMemberLeave(Node(update.id, ""), update.successorId);
+        for (int k : affected)
+            repickProximateFinger(chord, k, rtt);
+    }
+}
+
+/**
+ * @brief 节点已从成员中摘除后传播其离开：正常离开时后继已由 leaveRing 直接告知，由后继开始传播；
+ *        崩溃时没有人通知，由其余成员 ping 超时后怀疑并确认
+ * @param leftNode 离开的节点
+ * @param graceful 是否正常离开
+ */
+void ChordRingManager::gossipLeave(const Node &leftNode, bool graceful)
+{
+    if (chordNodes.empty())
+        return;
+    vector<uint32_t> ids = getAllSortedNodeIds();
+    size_t succ = upper_bound(ids.begin(), ids.end(), leftNode.id) - ids.begin();
+    if (succ == ids.size())
+        succ = 0;
+    auto deliver = [this](uint32_t id, const GossipUpdate &u)
+    { deliverGossip(id, u); };
+    if (graceful)
+    {
+        GossipUpdate update = {leftNode.id, MemberState::LEFT, ids[succ]};
+        lastGossip = gossip.disseminate(ids, succ, SIZE_MAX, update, deliver);
+    }
+    else
+        lastGossip = gossip.detectFailure(ids, leftNode.id, ids[succ], deliver);
+    gossipStats.add(lastGossip, !graceful);
+}
+
+/**
+ * @brief 为一个节点重选 PNS finger k：与 applyProximity 相同，从 start_k 的后继起在区间内至多 candidates 个节点中取 RTT 最小者；
+ *        finger 0 保持为后继，只更新 RTT。代价 O(logN + candidates)，gossip 修补时只对受影响的 finger 调用
+ * @param chord 节点
+ * @param k finger 下标
+ * @param rtt RTT 来源
+ */
+void ChordRingManager::repickProximateFinger(Chord *chord, int k, const function<double(const Node &, const Node &)> &rtt)
+{
+    Node self = chord->getSelf();
+    if (k == 0)
+    {
+        chord->setFingerId(0, chord->getFingerId(0), static_cast<float>(rtt(self, chord->getSuccessor())));
+        return;
+    }
+    uint32_t start = chord->getFingerStart(k);
+    auto it = chordNodes.lower_bound(start);
+    if (it == chordNodes.end())
+        it = chordNodes.begin();
+    auto best = it;
+    double bestRtt = rtt(self, best->second->getSelf());
+    size_t candidates = max<size_t>(1, proximity.candidates);
+    for (size_t c = 1; c < candidates; c++)
+    {
+        if (++it == chordNodes.end())
+            it = chordNodes.begin();
+        if (((it->first - start) & (ID_SPACE - 1)) >= (1u << k) || it->first == self.id)
+            break;
+        double r = rtt(self, it->second->getSelf());
+        if (r < bestRtt)
+        {
+            best = it;
+            bestRtt = r;
+        }
+    }
+    chord->setFingerId(k, best->first, static_cast<float>(bestRtt));
+}
+
+// ==================== 布隆过滤器 ====================
+
+/**
+ * @brief 开关管理器的过滤器缓存，关闭时释放所有副本
+ * @param enabled 是否在路由前用缓存的过滤器拒绝不存在的资源
+ */
+void ChordRingManager::setFilterCache(bool enabled)
+{
+    filterCacheEnabled = enabled;
+    if (!enabled)
+        filterCache.clear();
+}
+
+bool ChordRingManager::isFilterCacheEnabled() const { return filterCacheEnabled; }
+
+/**
+ * @brief 获取过滤器统计，内存占用与资源数为当前值
+ * @return FilterStats 统计
+ */
+FilterStats ChordRingManager::getFilterStats() const
+{
+    FilterStats stats = filterStats;
+    for (auto &p : chordNodes)
+    {
+        stats.nodeFilterBytes += p.second->getFilter().memoryBytes();
+        stats.keys += p.second->getResourceCount();
+    }
+    for (auto &p : filterCache)
+        stats.cacheBytes += p.second.memoryBytes();
+    return stats;
+}
+
+void ChordRingManager::resetFilterStats() { filterStats = FilterStats(); }
+
+// ==================== 资源 TTL ====================
+
+void ChordRingManager::setTtlOptions(const TtlOptions &options) { ttlOptions = options; }
+const TtlOptions &ChordRingManager::getTtlOptions() const { return ttlOptions; }
+uint64_t ChordRingManager::nowMs() const { return ttlOptions.clock ? ttlOptions.clock() : systemNowMs(); }
+
+/**
+ * @brief 访问节点时推进其时间轮，回收至多 reclaimBatch 个到期资源，回收代价分摊到各次访问
+ * @param owner 被访问的节点
+ */
+void ChordRingManager::reclaimAt(Chord *owner)
+{
+    if (owner && owner->getWheelEntries() > 0)
+        ttlStats.expired += owner->expireDue(nowMs(), ttlOptions.reclaimBatch);
+}
+
+/**
+ * @brief 读取时惰性删除已过期的资源
+ * @param owner 负责节点
+ * @param rid 资源ID
+ * @return true 若资源已过期并被删除
+ */
+bool ChordRingManager::expireOnRead(Chord *owner, uint32_t rid)
+{
+    if (!owner || owner->getDeadlines().empty() || !owner->dropIfExpired(rid, nowMs()))
+        return false;
+    ttlStats.expiredOnRead++;
+    return true;
+}
+
+/**
+ * @brief 从上次停下的节点开始轮转推进各节点的时间轮，批量回收到期资源；
+ *        没有到期条目的节点只花 O(1)，不扫描资源表
+ * @param maxKeys 本次最多回收的资源数（按刻度整批结算，可能略多），0 表示回收全部
+ * @return size_t 回收的资源数
+ */
+size_t ChordRingManager::expireResources(size_t maxKeys)
+{
+    if (chordNodes.empty())
+        return 0;
+    uint64_t now = nowMs();
+    size_t total = 0;
+    auto it = chordNodes.lower_bound(expireCursor);
+    for (size_t visited = 0; visited < chordNodes.size(); visited++)
+    {
+        if (it == chordNodes.end())
+            it = chordNodes.begin();
+        if (it->second->getWheelEntries() > 0)
+            total += it->second->expireDue(now, maxKeys > 0 ? maxKeys - total : 0);
+        ++it;
+        if (maxKeys > 0 && total >= maxKeys)
+            break;
+    }
+    expireCursor = it == chordNodes.end() ? 0 : it->first;
+    ttlStats.expired += total;
+    if (total > 0)
+        logger.info("回收到期资源 " + to_string(total));
+    return total;
+}
+
+/**
+ * @brief 获取 TTL 统计，带 TTL 的资源数与内存为当前值
+ * @return TtlStats 统计
+ */
+TtlStats ChordRingManager::getTtlStats() const
+{
+    TtlStats stats = ttlStats;
+    for (auto &p : chordNodes)
+    {
+        stats.keysWithTtl += p.second->getDeadlines().size();
+        stats.wheelEntries += p.second->getWheelEntries();
+        stats.wheelBytes += p.second->getTtlMemoryBytes();
+    }
+    return stats;
+}
+
+// ==================== 入口节点与路由负载 ====================
+
+void ChordRingManager::setEntryOptions(const EntryOptions &options)
+{
+    entryOptions = options;
+    entryRng.seed(options.seed);
+    entryCursor = 0;
+}
+
+const EntryOptions &ChordRingManager::getEntryOptions() const { return entryOptions; }
+void ChordRingManager::setCaller(const Node &c) { caller = c; }
+
+/**
+ * @brief 链路 RTT 的来源：优先用 PNS 的实测回调，其次用网络模拟器的时延模型
+ * @return function RTT（毫秒），都没有时为空
+ */
+function<double(const Node &, const Node &)> ChordRingManager::rttSource() const
+{
+    if (proximity.rtt)
+        return proximity.rtt;
+    if (!network)
+        return nullptr;
+    NetworkEmulator *emulator = network.get();
+    return [emulator](const Node &a, const Node &b)
+    { return emulator->link(a, b).rttMs; };
+}
+
+/**
+ * @brief 按入口策略选出本次请求的入口节点，并计入该节点的入口数。
+ *        RANDOM / ROUND_ROBIN 需要按下标访问成员，有序成员数组在成员变化（epoch 递增）后的第一次选择时重建；
+ *        NEAREST 对每个调用方扫描一次全部成员，结果缓存到下一次成员变化
+ * @return Node 入口节点，环为空时返回空节点
+ */
+Node ChordRingManager::getEntryNode()
+{
+    if (chordNodes.empty())
+        return Node();
+    EntryPolicy policy = entryOptions.policy;
+    if (caller.isEmpty() && (policy == EntryPolicy::NEAREST || policy == EntryPolicy::CLIENT_HASH))
+        policy = EntryPolicy::FIRST; // 没有调用方地址时无从就近或哈希
+    if (policy != EntryPolicy::FIRST && entryEpoch != epoch)
+    {
+        entryNodes.clear();
+        entryNodes.reserve(chordNodes.size());
+        for (auto &p : chordNodes)
+            entryNodes.push_back(p.second);
+        nearestEntry.clear();
+        entryEpoch = epoch;
+    }
+
+    Chord *entry = chordNodes.begin()->second;
+    switch (policy)
+    {
+    case EntryPolicy::FIRST:
+        break;
+    case EntryPolicy::RANDOM:
+        entry = entryNodes[uniform_int_distribution<size_t>(0, entryNodes.size() - 1)(entryRng)];
+        break;
+    case EntryPolicy::ROUND_ROBIN:
+        entry = entryNodes[entryCursor++ % entryNodes.size()];
+        break;
+    case EntryPolicy::NEAREST:
+    {
+        auto cached = nearestEntry.find(caller.id);
+        if (cached != nearestEntry.end())
+        {
+            entry = cached->second;
+            break;
+        }
+        function<double(const Node &, const Node &)> rtt = rttSource();
+        if (!rtt)
+        {
+            entry = ownerOf(caller.id);
+            break;
+        }
+        double best = rtt(caller, entry->getSelf());
+        for (Chord *chord : entryNodes)
+        {
+            double r = rtt(caller, chord->getSelf());
+            if (r < best)
+            {
+                best = r;
+                entry = chord;
+            }
+        }
+        nearestEntry.emplace(caller.id, entry);
+        break;
+    }
+    case EntryPolicy::CLIENT_HASH:
+        entry = ownerOf(caller.id); // 调用方ID即其地址的 SHA-1，取其后继
+        break;
+    }
+    entry->recordEntry();
+    return entry->getSelf();
+}
+
+/**
+ * @brief 同步请求进入环：按策略选入口节点；设置了调用方时，请求与最终回复都经过入口节点转发，
+ *        虚拟时钟只累加耗时，因此往返两条消息在这里一并计入
+ * @param payloadBytes 请求负载字节数
+ * @return Node 入口节点，环为空时返回空节点
+ */
+Node ChordRingManager::enterRing(size_t payloadBytes)
+{
+    Node entry = getEntryNode();
+    if (!entry.isEmpty() && !caller.isEmpty())
+    {
+        proxy.sendMessage(caller, entry, payloadBytes);
+        proxy.sendMessage(entry, caller);
+    }
+    return entry;
+}
+
+/**
+ * @brief 汇总各节点的路由负载
+ * @return RoutingLoadStats 负载分布
+ */
+RoutingLoadStats ChordRingManager::getRoutingLoadStats() const
+{
+    RoutingLoadStats stats;
+    stats.nodes = chordNodes.size();
+    if (stats.nodes == 0)
+        return stats;
+    stats.busiestNode = chordNodes.begin()->first;
+    for (auto &p : chordNodes)
+    {
+        const RoutingLoad &load = p.second->getRoutingLoad();
+        stats.entries += load.entries;
+        stats.maxEntries = max(stats.maxEntries, load.entries);
+        stats.totalWork += load.work();
+        if (load.work() > stats.maxWork)
+        {
+            stats.maxWork = load.work();
+            stats.busiestNode = p.first;
+        }
+    }
+    stats.meanWork = static_cast<double>(stats.totalWork) / stats.nodes;
+    double sq = 0;
+    for (auto &p : chordNodes)
+    {
+        double d = p.second->getRoutingLoad().work() - stats.meanWork;
+        sq += d * d;
+    }
+    stats.stddevWork = sqrt(sq / stats.nodes);
+    return stats;
+}
+
+void ChordRingManager::resetRoutingLoad()
+{
+    for (auto &p : chordNodes)
+        p.second->resetRoutingLoad();
+}
+
+// ==================== 客户端路由快照 ====================
+
+size_t RoutingSnapshot::wireBytes() const
+{
+    size_t bytes = sizeof(uint64_t) + sizeof(uint32_t);
+    for (const Node &node : nodes)
+        bytes += sizeof(uint32_t) + 1 + node.ip().size(); // ID + 长度前缀 + IP
+    return bytes;
+}
+
+uint64_t ChordRingManager::getEpoch() const { return epoch; }
+
+/**
+ * @brief 取当前成员的路由快照，O(N)；成员表本身按 ID 有序，无需再排序
+ * @return RoutingSnapshot 快照
+ */
+RoutingSnapshot ChordRingManager::getRoutingSnapshot() const
+{
+    RoutingSnapshot snapshot;
+    snapshot.epoch = epoch;
+    snapshot.placement = placement;
+    snapshot.ids.reserve(chordNodes.size());
+    snapshot.nodes.reserve(chordNodes.size());
+    for (auto &p : chordNodes)
+    {
+        snapshot.ids.push_back(p.first);
+        snapshot.nodes.push_back(p.second->getSelf());
+    }
+    return snapshot;
+}
+
+/**
+ * @brief 节点收到客户端直连请求：节点已离开时请求得不到回复，epoch 不一致时回复 STALE（附带当前 epoch）。
+ *        epoch 相同说明客户端的快照与当前成员一致，按快照定位到的就是负责节点
+ * @param client 客户端地址
+ * @param nodeId 客户端按快照选中的节点
+ * @param clientEpoch 客户端快照的 epoch
+ * @return Chord* 可以执行请求的节点，过时时为 nullptr
+ */
+Chord *ChordRingManager::acceptDirect(const Node &client, uint32_t nodeId, uint64_t clientEpoch)
+{
+    auto it = chordNodes.find(nodeId);
+    if (it == chordNodes.end())
+        return nullptr;
+    if (clientEpoch != epoch)
+    {
+        proxy.sendMessage(it->second->getSelf(), client, sizeof(uint64_t));
+        return nullptr;
+    }
+    return it->second;
+}
+
+/**
+ * @brief 客户端直连查找
+ * @param client 客户端地址
+ * @param nodeId 客户端按快照选中的负责节点
+ * @param clientEpoch 客户端快照的 epoch
+ * @param resource 资源名称
+ * @return DirectStatus OK 表示资源存在，FAILED 表示不存在
+ */
+DirectStatus ChordRingManager::lookupDirect(const Node &client, uint32_t nodeId, uint64_t clientEpoch, const string &resource)
+{
+    Chord *owner = acceptDirect(client, nodeId, clientEpoch);
+    if (!owner)
+        return DirectStatus::STALE;
+    filterStats.lookups++;
+    return lookupAt(owner, resourceIdOf(resource), client) ? DirectStatus::OK : DirectStatus::FAILED;
+}
+
+/**
+ * @brief 客户端直连写入
+ * @param client 客户端地址
+ * @param nodeId 客户端按快照选中的负责节点
+ * @param clientEpoch 客户端快照的 epoch
+ * @param resource 资源名称
+ * @param ttlMs 存活时间（毫秒），0 表示永不过期
+ * @return DirectStatus OK 表示写入成功，FAILED 表示资源已存在
+ */
+DirectStatus ChordRingManager::putDirect(const Node &client, uint32_t nodeId, uint64_t clientEpoch, const string &resource, uint64_t ttlMs)
+{
+    Chord *owner = acceptDirect(client, nodeId, clientEpoch);
+    if (!owner)
+        return DirectStatus::STALE;
+    bool ok = addResourceAt(owner, resource, ttlMs);
+    proxy.sendMessage(owner->getSelf(), client);
+    return ok ? DirectStatus::OK : DirectStatus::FAILED;
+}
+
+/**
+ * @brief 客户端直连删除
+ * @param client 客户端地址
+ * @param nodeId 客户端按快照选中的负责节点
+ * @param clientEpoch 客户端快照的 epoch
+ * @param resource 资源名称
+ * @return DirectStatus OK 表示删除成功，FAILED 表示资源不存在
+ */
+DirectStatus ChordRingManager::removeDirect(const Node &client, uint32_t nodeId, uint64_t clientEpoch, const string &resource)
+{
+    Chord *owner = acceptDirect(client, nodeId, clientEpoch);
+    if (!owner)
+        return DirectStatus::STALE;
+    bool ok = removeResourceAt(owner, resourceIdOf(resource), resource);
+    proxy.sendMessage(owner->getSelf(), client);
+    return ok ? DirectStatus::OK : DirectStatus::FAILED;
+}
+
+// ==================== 一致性校验 ====================
+
+/**
+ * @brief 以有序节点ID集合为参照校验整个环：每个节点的后继、前驱、finger[i].node 是否等于
+ *        startId 的真实后继，每个资源是否位于其负责节点上。
+ *        对固定的 i，各节点的 startId 随节点ID单调（至多绕环一次），在“加倍”的有序ID数组上用单指针推进即可求出全部真实后继，
+ *        总代价 O(N·m + K)，可在基准与负载回放中每隔若干操作调用一次
+ * @param maxProblems 最多记录的问题描述条数
+ * @return VerifyReport 校验结果
+ */
+VerifyReport ChordRingManager::verify(size_t maxProblems) const
+{
+    VerifyReport report;
+    size_t n = chordNodes.size();
+    if (n == 0)
+        return report;
+
+    vector<uint32_t> ids;
+    vector<const Chord *> chords;
+    ids.reserve(n);
+    chords.reserve(n);
+    for (auto &p : chordNodes)
+    {
+        ids.push_back(p.first);
+        chords.push_back(p.second);
+    }
+    auto note = [&](const string &msg)
+    {
+        if (report.problems.size() < maxProblems)
+            report.problems.push_back(msg);
+    };
+
+    // 后继与前驱
+    for (size_t i = 0; i < n; i++)
+    {
+        const Chord *chord = chords[i];
+        uint32_t succ = ids[(i + 1) % n], pred = ids[(i + n - 1) % n];
+        Node s = chord->getSuccessor(), p = chord->getPredecessor();
+        if (s.isEmpty() || s.id != succ)
+        {
+            report.successorErrors++;
+            note("节点 " + to_string(ids[i]) + " 后继为 " + (s.isEmpty() ? string("空") : to_string(s.id)) + "，应为 " + to_string(succ));
+        }
+        if (p.isEmpty() || p.id != pred)
+        {
+            report.predecessorErrors++;
+            note("节点 " + to_string(ids[i]) + " 前驱为 " + (p.isEmpty() ? string("空") : to_string(p.id)) + "，应为 " + to_string(pred));
+        }
+    }
+    report.nodesChecked = n;
+
+    // finger 表：把有序ID数组视为长度 2N、后半段加 ID_SPACE 的单调序列，startId 同样展开后单调，指针只前进
+    for (int k = 0; k < m; k++)
+    {
+        size_t j = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            uint64_t target = static_cast<uint64_t>(ids[i]) + (1u << k);
+            while (static_cast<uint64_t>(ids[j % n]) + (j >= n ? ID_SPACE : 0) < target)
+                j++;
+            uint32_t expected = ids[j % n];
+            uint32_t start = static_cast<uint32_t>(target % ID_SPACE);
+            uint32_t actual = chords[i]->getFingerId(k);
+            report.fingersChecked++;
+            // PNS 开启时 finger 可以是区间 [start, start + 2^k) 内的任意节点
+            bool proximate = proximity.enabled && ((actual - start) & (ID_SPACE - 1)) < (1u << k) &&
+                             binary_search(ids.begin(), ids.end(), actual);
+            if (actual != expected && !proximate)
+            {
+                report.fingerErrors++;
+                note("节点 " + to_string(ids[i]) + " finger[" + to_string(k) + "] start=" + to_string(start) +
+                     " 指向 " + to_string(actual) + "，应为 " + to_string(expected));
+            }
+        }
+    }
+
+    // 非 Chord 几何的链接表：每项都应是环中的其他节点；单跳几何还要求恰好包含全部其他成员
+    bool full = geometry->fullMembership();
+    for (size_t i = 0; i < n; i++)
+    {
+        vector<uint32_t> linked = chords[i]->getLinks();
+        if (full && linked.size() != n - 1)
+        {
+            report.linkErrors++;
+            note("节点 " + to_string(ids[i]) + " 的成员表有 " + to_string(linked.size()) + " 项，应为 " + to_string(n - 1));
+        }
+        for (uint32_t id : linked)
+        {
+            report.linksChecked++;
+            if (id == ids[i] || !binary_search(ids.begin(), ids.end(), id))
+            {
+                report.linkErrors++;
+                note("节点 " + to_string(ids[i]) + " 的链接指向 " + to_string(id) + "，不是环中的其他节点");
+            }
+        }
+    }
+
+    // 资源归属：节点 i 负责 (ids[i-1], ids[i]]，只有一个节点时负责整个环
+    for (size_t i = 0; i < n; i++)
+    {
+        uint32_t lo = ids[(i + n - 1) % n], hi = ids[i];
+        for (auto &res : chords[i]->getResourceMap())
+        {
+            report.keysChecked++;
+            uint32_t rid = res.first;
+            bool owned = n == 1 || (lo < hi ? (rid > lo && rid <= hi) : (rid > lo || rid <= hi));
+            if (!owned)
+            {
+                report.keyErrors++;
+                note("资源 " + res.second + "(" + to_string(rid) + ") 位于节点 " + to_string(hi) + "，不在其负责区间 (" + to_string(lo) + ", " + to_string(hi) + "]");
+            }
+        }
+    }
+    return report;
+}
+
+// ==================== 环镜像 ====================
+
+/**
+ * @brief 将整个环写成二进制镜像
+ * @param path 镜像文件路径
+ * @return true 若写入成功
+ */
+bool ChordRingManager::saveRingImage(const string &path) const
+{
+    return RingImage::write(*this, path);
+}
+
+/**
+ * @brief 从已映射的镜像重建整个环：节点按 ID 升序直接插入，路由表与资源从映射内存复制，
+ *        不执行 join、finger 刷新与资源再分配。这是一次完整的反序列化，代价 O(N·m + K)；
+ *        只读查询直接用 RingImage::lookup，不必载入
+ * @param image 已打开的环镜像
+ * @return true 若恢复成功
+ * @return false 若当前环非空、镜像未打开或内容校验失败
+ */
+bool ChordRingManager::loadRingImage(const RingImage &image)
+{
+    if (!chordNodes.empty() || !image.isOpen() || !image.contentsValid())
+        return false;
+    size_t n = image.nodeCount();
+    vector<Node> nodes;
+    nodes.reserve(n);
+    for (size_t i = 0; i < n; i++)
+        nodes.push_back(Node(image.nodeId(i), image.nodeIp(i)));
+
+    auto nodeAt = [&nodes](uint32_t idx)
+    { return idx < nodes.size() ? nodes[idx] : Node(); }; // 内容已校验，这里只剩 RING_IMAGE_NO_NODE
+
+    // 资源ID按镜像中的放置方式计算，先恢复它，之后的查找与范围查询才与镜像一致
+    placement = image.placement();
+
+    size_t timed = 0; // SEC_DEADLINES 按资源下标升序，与逐节点恢复的顺序一致
+    for (size_t i = 0; i < n; i++)
+    {
+        Chord *chord = createChord(nodes[i]);
+        chordNodes.emplace_hint(chordNodes.end(), nodes[i].id, chord);
+        filterCache.erase(nodes[i].id);
+        chord->restoreRouting(nodeAt(image.predecessorIndex(i)), nodeAt(image.successorIndex(i)));
+        for (int k = 1; k < m; k++)
+            chord->setFingerNode(k, nodeAt(image.fingerIndex(i, k)));
+        for (size_t key = image.keyBegin(i); key < image.keyEnd(i); key++)
+        {
+            chord->restoreResource(image.keyId(key), string(image.valueData(key), image.valueSize(key)));
+            if (timed < image.deadlineCount() && image.deadline(timed).keyIndex == key)
+                chord->setExpiry(image.keyId(key), image.deadline(timed++).deadlineMs);
+        }
+    }
+    epoch++;
+    rebuildLinks(); // 镜像只保存 finger 表，非 Chord 几何的链接表按成员重新计算
+
+    // 启用持久化时整体写一次快照，之后的修改照常追加到 WAL
+    if (storage.isEnabled())
+    {
+        storage.writeMembershipSnapshot(getAllNodeIPs(), placement);
+        for (auto &p : chordNodes)
+            storage.writeNodeSnapshot(p.first, p.second->getResourceMap(), p.second->getDeadlines());
+    }
+    logger.info("从环镜像恢复: 节点 " + to_string(n) + ", 资源 " + to_string(image.keyCount()));
+    return true;
+}
+
+/**
+ * @brief 由成员列表直接构建空环：节点按 ID 排序后一次性算出前驱/后继与 finger 表（每项二分查找），
+ *        代价 O(N·m·logN)，不逐个 join；ID 冲突的 IP 被跳过。用于基准测试等需要快速搭建大环的场景
+ * @param ips 节点 IP 列表
+ * @return size_t 实际加入的节点数，当前环非空时返回 0
+ */
+size_t ChordRingManager::bulkLoad(const vector<string> &ips)
+{
+    if (!chordNodes.empty())
+        return 0;
+    return joinMany(ips);
+}
+
+/**
+ * @brief 按当前有序成员直接重算所有节点的前驱、后继与 finger 表，节点按区间分给多个线程。
+ *        对固定的 k，startId = ids[i] + 2^k 随 i 单调（展开到加倍的 ID 数组上），每个线程先二分定位一次，
+ *        之后指针只前进，总代价 O(N·m)
+ */
+void ChordRingManager::rebuildRouting()
+{
+    size_t n = chordNodes.size();
+    if (n == 0)
+        return;
+    vector<Chord *> chords;
+    vector<uint32_t> ids;
+    chords.reserve(n);
+    ids.reserve(n);
+    for (auto &p : chordNodes)
+    {
+        ids.push_back(p.first);
+        chords.push_back(p.second);
+    }
+
+    parallelFor(n, parallelism, [&](size_t begin, size_t end)
+                {
+        for (size_t i = begin; i < end; i++)
+            chords[i]->restoreRouting(chords[(i + n - 1) % n]->getSelf(), chords[(i + 1) % n]->getSelf());
+
+        auto unfolded = [&](size_t j)
+        { return static_cast<uint64_t>(ids[j % n]) + (j >= n ? ID_SPACE : 0); };
+        for (int k = 1; k < m; k++)
+        {
+            uint64_t first = static_cast<uint64_t>(ids[begin]) + (1u << k);
+            size_t j = first < ID_SPACE ? lower_bound(ids.begin(), ids.end(), static_cast<uint32_t>(first)) - ids.begin()
+                                        : n + (lower_bound(ids.begin(), ids.end(), static_cast<uint32_t>(first - ID_SPACE)) - ids.begin());
+            for (size_t i = begin; i < end; i++)
+            {
+                uint64_t target = static_cast<uint64_t>(ids[i]) + (1u << k);
+                while (unfolded(j) < target)
+                    j++;
+                chords[i]->setFingerId(k, ids[j % n]);
+            }
+        } });
+    applyProximity(ids, chords);
+    rebuildLinks();
+}
+
+/**
+ * @brief 邻近节点选择：对每个节点的每个 finger，从区间 [start_k, start_{k+1}) 的真实后继开始，
+ *        依次取至多 candidates 个仍在区间内的节点，选 RTT 最小者并记录其 RTT。finger 0（后继）保持不变，只记录 RTT。
+ *        区间为空时真实后继落在区间外，仍作为唯一候选，与精确 finger 相同。代价 O(N·m·(logN + candidates))
+ * @param ids 有序节点ID
+ * @param chords 与 ids 一一对应的节点
+ */
+void ChordRingManager::applyProximity(const vector<uint32_t> &ids, const vector<Chord *> &chords)
+{
+    size_t n = ids.size();
+    if (!proximity.enabled || n < 2)
+        return;
+    function<double(const Node &, const Node &)> rtt = rttSource();
+    if (!rtt)
+        return;
+    size_t candidates = max<size_t>(1, proximity.candidates);
+
+    parallelFor(n, parallelism, [&](size_t begin, size_t end)
+                {
+        for (size_t i = begin; i < end; i++)
+        {
+            Chord *chord = chords[i];
+            Node self = chord->getSelf();
+            chord->setFingerId(0, chord->getFingerId(0), static_cast<float>(rtt(self, chord->getSuccessor())));
+            for (int k = 1; k < m; k++)
+            {
+                uint32_t start = chord->getFingerStart(k);
+                size_t j = lower_bound(ids.begin(), ids.end(), start) - ids.begin();
+                size_t best = j % n;
+                double bestRtt = rtt(self, chords[best]->getSelf());
+                for (size_t c = 1; c < candidates; c++)
+                {
+                    size_t idx = (j + c) % n;
+                    if (((ids[idx] - start) & (ID_SPACE - 1)) >= (1u << k) || idx == i)
+                        break;
+                    double r = rtt(self, chords[idx]->getSelf());
+                    if (r < bestRtt)
+                    {
+                        best = idx;
+                        bestRtt = r;
+                    }
+                }
+                chord->setFingerId(k, ids[best], static_cast<float>(bestRtt));
+            }
+        } });
+}
+
+/**
+ * @brief 批量加入节点：并行计算 IP 哈希，按 ID 排序后一次性创建节点，多线程重算全部路由表，
+ *        再把已有资源中新节点负责的区间从原负责节点直接迁移过去（每个资源至多迁移一次）。
+ *        代价 O(N·m / 线程数 + 新节点数·logN + 迁移资源数)，不逐个 join
+ * @param ips 节点 IP 列表
+ * @param rejected 可选，按输入顺序收到未加入的 IP（已在环中、与已有节点或本批前面的节点 ID 冲突）
+ * @return size_t 实际加入的节点数
+ */
+size_t ChordRingManager::joinMany(const vector<string> &ips, vector<string> *rejected)
+{
+    size_t total = ips.size();
+    vector<Node> nodes(total);
+    parallelFor(total, parallelism, [&](size_t begin, size_t end)
+                {
+        for (size_t i = begin; i < end; i++)
+            nodes[i] = Node(ips[i]); });
+
+    // 按 (ID, 输入顺序) 排序，同一 ID 只接受输入中最早且环中尚不存在的一个
+    vector<size_t> order(total);
+    iota(order.begin(), order.end(), 0);
+    sort(order.begin(), order.end(), [&](size_t a, size_t b)
+         { return nodes[a].id != nodes[b].id ? nodes[a].id < nodes[b].id : a < b; });
+    vector<bool> accepted(total, false);
+    vector<pair<Chord *, Chord *>> moves; // (新节点, 加入前负责其区间的节点)
+    size_t added = 0;
+    for (size_t k = 0; k < total; k++)
+    {
+        const Node &node = nodes[order[k]];
+        if ((k > 0 && nodes[order[k - 1]].id == node.id) || chordNodes.count(node.id))
+            continue;
+        Chord *owner = nullptr;
+        if (!chordNodes.empty())
+        {
+            auto it = chordNodes.lower_bound(node.id);
+            owner = it == chordNodes.end() ? chordNodes.begin()->second : it->second;
+        }
+        accepted[order[k]] = true;
+        added++;
+        Chord *chord = createChord(node);
+        moves.push_back(make_pair(chord, owner));
+        storage.logJoin(node.ip());
+    }
+    if (rejected)
+        for (size_t i = 0; i < total; i++)
+            if (!accepted[i])
+                rejected->push_back(ips[i]);
+    if (added == 0)
+        return 0;
+
+    // 原负责节点在插入新节点之前确定，插入后统一重算路由表
+    for (auto &mv : moves)
+        chordNodes.emplace(mv.first->getSelf().id, mv.first);
+    filterCache.clear();
+    epoch++;
+    rebuildRouting();
+
+    // 新节点 X 负责 (X 的新前驱, X]，这些资源此前都在 X 加入前的后继 owner 上，直接整段迁移
+    size_t movedKeys = 0;
+    for (auto &mv : moves)
+    {
+        if (mv.second == nullptr)
+            continue;
+        Chord *chord = mv.first;
+        movedKeys += mv.second->streamRangeTo(chord, chord->getPredecessor().id, chord->getSelf().id, migrationOptions);
+    }
+
+    checkpoint();
+    logger.info("批量加入: 节点 " + to_string(added) + "，迁移资源 " + to_string(movedKeys));
+    return added;
+}
+
+/**
+ * @brief 批量删除节点：先从成员中摘掉全部离开节点得到最终成员，离开节点的资源直接迁移到
+ *        最终成员中的后继（不会在离开节点之间反复搬运），最后多线程重算剩余节点的路由表。
+ *        删除全部节点时等同于 clear()，资源一并丢弃
+ * @param ips 节点 IP 列表
+ * @param missing 可选，按输入顺序收到未删除的 IP（不在环中或在本批中重复）
+ * @return size_t 实际删除的节点数
+ */
+size_t ChordRingManager::removeMany(const vector<string> &ips, vector<string> *missing)
+{
+    vector<Chord *> leaving;
+    for (const auto &ip : ips)
+    {
+        Node node = getNodeByIP(ip);
+        auto it = node.isEmpty() ? chordNodes.end() : chordNodes.find(node.id);
+        if (it == chordNodes.end())
+        {
+            if (missing)
+                missing->push_back(ip);
+            continue;
+        }
+        leaving.push_back(it->second);
+        chordNodes.erase(it); // 摘出后同一批中重复的 IP 自然查不到
+    }
+    if (leaving.empty())
+        return 0;
+    filterCache.clear();
+    epoch++;
+    if (chordNodes.empty())
+    {
+        for (Chord *chord : leaving)
+            chordNodes.emplace(chord->getSelf().id, chord);
+        return clear();
+    }
+
+    // 剩余成员即最终成员：离开节点的全部资源属于其后第一个留下的节点
+    size_t movedKeys = 0;
+    for (Chord *chord : leaving)
+    {
+        uint32_t id = chord->getSelf().id;
+        auto it = chordNodes.lower_bound(id);
+        Chord *owner = it == chordNodes.end() ? chordNodes.begin()->second : it->second;
+        movedKeys += chord->streamRangeTo(owner, id, id, migrationOptions);
+    }
+
+    for (Chord *chord : leaving)
+    {
+        Node node = chord->getSelf();
+        storage.logLeave(node.ip());
+        storage.dropNode(node.id);
+        destroyChord(chord);
+        logger.info("节点移除: " + node.toString());
+    }
+    rebuildRouting();
+    checkpoint();
+    logger.info("批量删除: 节点 " + to_string(leaving.size()) + "，迁移资源 " + to_string(movedKeys));
+    return leaving.size();
 }
@@ -3,15 +3,196 @@
 
 #include "node.h"
 #include "config.h"
+#include "storage.h"
+#include "placement.h"
+#include "finger_simd.h"
+#include "netsim.h"
+#include "bloom.h"
+#include "timer_wheel.h"
+#include "routing_geometry.h"
+#include "gossip.h"
 #include <vector>
 #include <map>
 #include <string>
 #include <cstdint>
+#include <functional>
+#include <utility>
+#include <memory>
+#include <future>
+#include <random>
+#include <unordered_map>
 
 // 前置声明
 class ChordRingManager;
 class Chord;
 class ChordProxy;
+class RingImage;
+class ChordAsyncRuntime;
+
+// 一次区间迁移的进度（每迁移完一个分块回调一次）
+struct MigrationProgress
+{
+    uint32_t fromId;
+    uint32_t toId;
+    size_t movedKeys;
+    size_t movedBytes;
+    size_t chunks;
+    bool done;
+};
+
+// 区间迁移配置
+struct MigrationOptions
+{
+    size_t chunkSize = 256;                                  // 每个分块的资源数
+    double maxKeysPerSecond = 0;                             // 限速（资源数/秒），0 表示不限速
+    std::function<void(const MigrationProgress &)> onProgress; // 进度回调，可为空
+};
+
+// 范围查询的批量回调：每收集满一批结果回调一次，返回 false 时提前结束
+typedef std::function<bool(const std::vector<std::string> &)> ScanCallback;
+
+// 邻近节点选择（PNS）：finger i 可以是 [start_i, start_{i+1}) 内的任意节点，
+// 在该区间的前 candidates 个节点中选 RTT 最小的一个，跳数不变而每跳时延更低
+struct ProximityOptions
+{
+    bool enabled = false;
+    size_t candidates = 4;                                 // 每个 finger 区间最多比较的候选数
+    std::function<double(const Node &, const Node &)> rtt; // 实测 RTT（毫秒），会被多个线程同时调用；为空时使用网络模拟器的时延模型
+};
+
+// 过滤器统计：不存在的键 = 缓存拒绝 + 节点拒绝 + 误判，误判率 = 误判 / 不存在的键
+struct FilterStats
+{
+    uint64_t lookups = 0;
+    uint64_t cacheRejects = 0; // 管理器缓存的过滤器在路由前拒绝
+    uint64_t nodeRejects = 0;  // 负责节点的过滤器拒绝，未访问资源表
+    uint64_t falsePositives = 0; // 过滤器放行但资源不存在
+    uint64_t cacheFetches = 0;   // 缓存未命中时从负责节点取过滤器的次数
+    size_t nodeFilterBytes = 0;  // 各节点过滤器占用的内存
+    size_t cacheBytes = 0;       // 管理器缓存占用的内存
+    size_t keys = 0;             // 环中资源总数
+
+    double falsePositiveRate() const
+    {
+        uint64_t absent = cacheRejects + nodeRejects + falsePositives;
+        return absent ? static_cast<double>(falsePositives) / absent : 0;
+    }
+};
+
+// 资源 TTL 配置；时钟与刻度应在写入第一个带 TTL 的资源之前设置
+struct TtlOptions
+{
+    uint32_t tickMs = 100;               // 时间轮刻度，到期的资源最多晚一个刻度被回收（读取时按精确时刻判断）
+    size_t reclaimBatch = 256;           // 访问节点时顺带回收的到期资源数上限
+    std::function<uint64_t()> clock;     // 当前时刻（毫秒），为空时取系统时间；到期时刻会持久化，因此应与系统时间同基准
+};
+
+// TTL 统计：回收数为累计值，其余为当前值
+struct TtlStats
+{
+    uint64_t expired = 0;       // 由时间轮批量回收的资源数
+    uint64_t expiredOnRead = 0; // 读取或写入时发现已过期而删除的资源数
+    size_t keysWithTtl = 0;     // 当前带 TTL 的资源数
+    size_t wheelEntries = 0;    // 时间轮中的条目数（含删除或迁出后残留的旧条目）
+    size_t wheelBytes = 0;      // 时间轮与到期时间表占用的内存
+};
+
+// 请求的入口节点选择策略：经管理器的 put / lookup / remove / 范围查询与异步请求都从入口节点开始路由
+enum class EntryPolicy
+{
+    FIRST,       // ID 最小的节点（原行为），所有请求集中在同一个入口
+    RANDOM,      // 每个请求随机选一个节点
+    ROUND_ROBIN, // 按 ID 顺序轮流
+    NEAREST,     // 离调用方 RTT 最小的节点；没有 RTT 来源时按 CLIENT_HASH
+    CLIENT_HASH  // 调用方地址哈希的后继，同一调用方固定入口，不同调用方分散
+};
+
+struct EntryOptions
+{
+    EntryPolicy policy = EntryPolicy::FIRST;
+    uint64_t seed = 1; // RANDOM 的随机种子
+};
+
+// 节点的路由负载：作为入口接收的请求数，以及在本节点执行的路由步数（转发给下一跳 / 确定后继）
+struct RoutingLoad
+{
+    uint64_t entries = 0;
+    uint64_t forwards = 0;
+    uint64_t resolves = 0;
+
+    uint64_t work() const { return forwards + resolves; }
+};
+
+// 全环路由负载分布，用于衡量入口与 finger 转发的不均衡
+struct RoutingLoadStats
+{
+    size_t nodes = 0;
+    uint64_t entries = 0;
+    uint64_t maxEntries = 0; // 单个节点的最大入口数
+    uint64_t totalWork = 0;
+    uint64_t maxWork = 0;
+    uint32_t busiestNode = 0; // 路由步数最多的节点ID
+    double meanWork = 0;
+    double stddevWork = 0;
+
+    double maxOverMean() const { return meanWork > 0 ? maxWork / meanWork : 0; }
+};
+
+// 路由表规模：每个节点保存的不同远程节点数（前驱、后继与 finger / 链接表去重），用于比较不同路由几何的状态开销
+struct RoutingStateStats
+{
+    size_t nodes = 0;
+    uint64_t entries = 0;
+    size_t minEntries = 0;
+    size_t maxEntries = 0;
+
+    double meanEntries() const { return nodes ? static_cast<double>(entries) / nodes : 0; }
+};
+
+// 客户端路由快照：某个成员版本下的有序节点ID与对应地址，连同放置方式，足以在客户端本地算出任一资源的负责节点
+struct RoutingSnapshot
+{
+    uint64_t epoch = 0;          // 成员版本，成员或放置方式变化时递增
+    std::vector<uint32_t> ids;   // 升序
+    std::vector<Node> nodes;     // 与 ids 一一对应
+    PlacementOptions placement;
+
+    size_t wireBytes() const; // 传输大小：epoch、节点数、每个节点的 ID 与 IP 字符串
+};
+
+// 客户端直连请求的结果：STALE 表示客户端的 epoch 已过时（或目标节点已离开），请求未执行
+enum class DirectStatus
+{
+    OK,
+    FAILED,
+    STALE
+};
+
+// 累计迁移统计
+struct MigrationStats
+{
+    uint64_t migrations = 0;
+    uint64_t keysMoved = 0;
+    uint64_t bytesMoved = 0;
+    uint64_t chunks = 0;
+};
+
+// 环一致性校验结果：以有序节点ID集合为参照，检查路由状态与资源归属
+struct VerifyReport
+{
+    size_t nodesChecked = 0;
+    size_t fingersChecked = 0;
+    size_t keysChecked = 0;
+    size_t successorErrors = 0;
+    size_t predecessorErrors = 0;
+    size_t fingerErrors = 0;
+    size_t linksChecked = 0; // 非 Chord 几何的链接表项
+    size_t linkErrors = 0;   // 指向自身或已不在环中的链接
+    size_t keyErrors = 0;
+    std::vector<std::string> problems; // 前若干条问题的描述
+
+    bool ok() const { return successorErrors + predecessorErrors + fingerErrors + linkErrors + keyErrors == 0; }
+};
 
 // 使用代理模式来管理 Chord 环，提供统一的接口，间接实现 ChordRingManager 的功能以达到类似节点之间的网络通信效果
 class ChordProxy
@@ -33,23 +214,85 @@ public:
     std::vector<uint32_t> getAllSortedNodeIds();
     void notifyNodeLeave(Node &leftNode);
     Node findSuccessorFromAny(uint32_t id);
+    void logResourcePut(const Node &owner, uint32_t rid, const std::string &resource);
+    void logResourceRemove(const Node &owner, uint32_t rid);
+    void logResourceExpiry(const Node &owner, uint32_t rid, uint64_t deadlineMs);
+    void logResourceRangeRemove(const Node &owner, uint32_t lo, uint32_t hi);
+    void logResourceChunkTransfer(const Node &from, const Node &to, const ResourceChunk &chunk);
+    const MigrationOptions &getMigrationOptions();
+    const TtlOptions &getTtlOptions();
+    uint64_t nowMs(); // TTL 时钟
+    void recordMigration(const MigrationProgress &progress);
+    uint32_t resourceIdOf(const std::string &resource);
+    MemoryArena *getArena();
+    void sendMessage(const Node &from, const Node &to, size_t payloadBytes = 0); // 开启网络模拟时计入消息耗时
+    void sendMessages(const Node &from, const std::vector<Node> &to, size_t payloadBytes = 0); // 并发发送
+    double sendConcurrentMessage(const Node &from, const Node &to, size_t payloadBytes = 0); // 异步请求的消息：返回模拟耗时，不推进时钟
+    bool isNetworkEnabled();
+    const RoutingGeometry *getGeometry(); // 节点创建时取得，切换几何时由管理器统一更新
+    bool isGossipEnabled();               // 为 true 时加入经 notifyNodeUpdate 以 gossip 传播，不直接更新半个环
 };
 
 class ChordRingManager
 {
 private:
+    MemoryArena arena; // Chord 对象与各节点资源表的内存池，拆除整个环时整块释放
     std::map<uint32_t, Chord *> chordNodes;
     ChordProxy proxy;
+    ChordStorage storage;
+    MigrationOptions migrationOptions;
+    MigrationStats migrationStats;
+    PlacementOptions placement;
+    size_t parallelism; // 批量操作的线程数上限，0 表示硬件线程数
+    std::unique_ptr<ChordAsyncRuntime> asyncRuntime; // 异步接口的节点运行时，首次使用时启动
+    std::unique_ptr<NetworkEmulator> network;        // 网络模拟器，为空时节点间通信不计耗时
+    ProximityOptions proximity;
+    bool filterCacheEnabled;
+    std::unordered_map<uint32_t, BlockedBloomFilter> filterCache; // 节点ID → 过滤器副本，成员变化时整体失效
+    FilterStats filterStats;
+    TtlOptions ttlOptions;
+    TtlStats ttlStats;
+    uint32_t expireCursor; // expireResources 的轮转起点（节点ID）
+    uint64_t epoch;        // 成员版本，客户端路由快照据此判断是否过时
+    EntryOptions entryOptions;
+    Node caller;                 // 当前调用方，NEAREST / CLIENT_HASH 使用
+    std::mt19937_64 entryRng;
+    uint64_t entryCursor;        // ROUND_ROBIN 的位置
+    std::vector<Chord *> entryNodes; // 按 ID 有序的成员，随机访问用；entryEpoch 与 epoch 不同时重建
+    uint64_t entryEpoch;
+    std::unordered_map<uint32_t, Chord *> nearestEntry; // 调用方ID → 最近的节点，随 entryNodes 一起失效
+    GeometryOptions geometryOptions;
+    std::unique_ptr<RoutingGeometry> geometry;
+    MembershipGossip gossip;
+    GossipStats gossipStats;
+    GossipRun lastGossip;
+
+    void checkpoint();
+    void releaseAllChords();
+    void rebuildRouting(); // 按有序成员直接重算所有节点的前驱、后继与 finger 表（多线程）
+    void applyProximity(const std::vector<uint32_t> &ids, const std::vector<Chord *> &chords); // 按 PNS 重选 finger（多线程）
+    void rebuildLinks(); // 按当前几何重算各节点的链接表（多线程）
+    void deliverGossip(uint32_t nodeId, const GossipUpdate &update); // 节点得知一条成员更新，就地修补其路由表
+    void gossipLeave(const Node &leftNode, bool graceful);           // 已摘除的节点经 gossip 传播离开或被检测为失效
+    void repickProximateFinger(Chord *chord, int k, const std::function<double(const Node &, const Node &)> &rtt); // 只重选一个 PNS finger
+    Chord *ownerOf(uint32_t rid) const; // 按当前成员直接定位负责节点（客户端缓存的环视图）
+    void reclaimAt(Chord *owner);       // 访问节点时顺带回收一批到期资源
+    bool lookupAt(Chord *owner, uint32_t rid, const Node &from, double *concurrentMs = nullptr); // 负责节点处理查找，回复发给 from
+    Chord *acceptDirect(const Node &client, uint32_t nodeId, uint64_t clientEpoch); // 直连请求的 epoch 校验
+    std::function<double(const Node &, const Node &)> rttSource() const; // PNS 回调或网络模拟器的链路 RTT，都没有时为空
+    Node enterRing(size_t payloadBytes); // 同步请求的入口：选入口节点，设置了调用方时计入调用方与入口之间的往返
 
 public:
     ChordRingManager();
     ~ChordRingManager();
-    bool join(Node &newNode, Chord *chordInstance);
+    Chord *createChord(const Node &node);          // 在管理器的内存池中创建 Chord 实例
+    void destroyChord(Chord *chord);               // 析构并把内存归还内存池
+    bool join(Node &newNode, Chord *chordInstance); // chordInstance 须由 createChord 创建，之后由管理器负责销毁
     bool isRingEmpty() const;
     Node getAnyNode() const;
     std::map<uint32_t, Chord *> getAllChordNodes() const;
     Chord *findChordNode(uint32_t id);
-    Node findSuccessor(Node &currentNode, uint32_t id);
+    Node findSuccessor(Node &currentNode, uint32_t id, int *hops = nullptr);
     Node findPredecessor(Node &currentNode, uint32_t id);
     bool transferResourceToNode(Node &targetNode, const std::string &resource);
     void notifyAllNodesUpdate(Node &newNode);
@@ -57,18 +300,132 @@ public:
     std::vector<uint32_t> getAllSortedNodeIds() const;
     int getTotalNodes() const;
     void notifyAllNodesLeave(Node &leftNode);
-    bool removeNode(Node &leftNode);
+    bool removeNode(Node &leftNode, bool graceful = true); // graceful 为 false 时模拟崩溃：资源不转移直接丢失
     void showChordInfo() const;
-    bool addResource(const std::string &resource);
-    Node lookupResource(const std::string &resource);
+    bool addResource(const std::string &resource, uint64_t ttlMs = 0); // ttlMs 为 0 表示永不过期
+    Node lookupResource(const std::string &resource, int *hops = nullptr); // hops 可选，输出路由跳数
     void showResourceDistribution();
     void refreshAllFingerTables();
     bool removeResource(const std::string &resourceName);
     std::vector<std::string> getAllResourceNames() const;
+    bool addResourceAt(Chord *owner, const std::string &resource, uint64_t ttlMs = 0); // 在已路由到的负责节点上添加资源
+    bool removeResourceAt(Chord *owner, uint32_t rid, const std::string &resourceName); // 在已路由到的负责节点上删除资源
+    bool lookupResourceAt(Chord *owner, uint32_t rid, const Node &from, double *concurrentMs = nullptr); // 在已路由到的负责节点上查找，回复发给 from，计入过滤器统计
+    size_t clear();        // 删除全部节点，资源一并丢弃，内存池整块释放；返回删除的节点数
+    MemoryArena &getArena();
+
+    // ===== 持久化 =====
+    bool openStorage(const StorageOptions &options); // 打开数据目录并恢复快照 + WAL
+    ChordStorage &getStorage();
+    void showStorageStats() const;
+
+    // ===== 放置方式与范围查询 =====
+    bool setPlacement(const PlacementOptions &options); // 仅在环中没有资源时允许切换
+    const PlacementOptions &getPlacement() const;
+    uint32_t resourceIdOf(const std::string &resource) const;
+    size_t scan(const std::string &start, const std::string &end, size_t limit, const ScanCallback &onBatch, size_t batchSize = 64);
+    size_t scanPrefix(const std::string &prefix, size_t limit, const ScanCallback &onBatch, size_t batchSize = 64);
+
+    // ===== 区间迁移 =====
+    void setMigrationOptions(const MigrationOptions &options);
+    const MigrationOptions &getMigrationOptions() const;
+    void recordMigration(const MigrationProgress &progress);
+    const MigrationStats &getMigrationStats() const;
+
+    // ===== 一致性校验 =====
+    VerifyReport verify(size_t maxProblems = 16) const; // O(N·m + K) 校验后继、前驱、finger 表与资源归属
+
+    // ===== 环镜像 =====
+    bool saveRingImage(const std::string &path) const; // 写出整个环的二进制镜像
+    bool loadRingImage(const RingImage &image);        // 从已映射的镜像直接恢复空环，不逐个 join
+    size_t bulkLoad(const std::vector<std::string> &ips); // 由成员列表直接构建空环（路由表一次算好），返回加入的节点数
+
+    // ===== 批量成员变化 =====
+    // 批量加入：并行哈希、一次重算全部路由表、每个资源至多迁移一次；rejected 收到未加入的 IP（已存在或 ID 冲突）
+    size_t joinMany(const std::vector<std::string> &ips, std::vector<std::string> *rejected = nullptr);
+    // 批量删除：先确定最终成员，每个资源直接迁移到最终负责节点，再一次重算路由表；missing 收到不在环中的 IP
+    size_t removeMany(const std::vector<std::string> &ips, std::vector<std::string> *missing = nullptr);
+    void setParallelism(size_t threads); // 0 表示使用硬件线程数
+    size_t getParallelism() const;
+
+    // ===== 异步接口 =====
+    // 请求交给节点运行时逐跳推进，多个请求的路由交错执行；请求在途期间除提交异步请求外不能调用管理器的任何接口
+    // （包括同步查找与统计，工作线程不加锁地修改它们依赖的状态），先 drainAsync()
+    std::future<Node> lookupAsync(const std::string &resource);
+    std::future<bool> putAsync(const std::string &resource);
+    std::future<bool> removeAsync(const std::string &resource);
+    ChordAsyncRuntime &getAsyncRuntime(); // 需要回调或协程接口时直接使用运行时
+    void drainAsync();                    // 等待所有异步请求完成
+
+    // ===== 网络模拟 =====
+    // 开启后代理转发的每条消息按时延模型推进虚拟时钟，操作的模拟耗时为前后两次 getNetwork()->now() 之差
+    bool enableNetwork(const NetworkOptions &options); // MATRIX 模型加载失败时返回 false 并保持原状态
+    void disableNetwork();
+    NetworkEmulator *getNetwork(); // 未开启时返回 nullptr
+
+    // ===== 邻近节点选择 =====
+    // 开启后每次路由表刷新（加入、离开、批量成员变化）都在精确 finger 的基础上按 RTT 重选；
+    // 没有 rtt 回调且未开启网络模拟时无从测量，保持精确 finger
+    void setProximity(const ProximityOptions &options);
+    const ProximityOptions &getProximity() const;
+
+    // ===== 布隆过滤器 =====
+    // 每个节点维护资源ID的分块布隆过滤器，查找不存在的资源时不访问资源表；
+    // 开启缓存后管理器保存各节点过滤器的副本（put 时同步插入），不存在的资源在路由前即被拒绝
+    void setFilterCache(bool enabled);
+    bool isFilterCacheEnabled() const;
+    FilterStats getFilterStats() const; // 含当前内存占用
+    void resetFilterStats();
+
+    // ===== 资源 TTL =====
+    // 每个节点用分层时间轮登记到期时间：访问节点时顺带回收一批到期资源，读取时发现过期的资源立即删除，
+    // expireResources 按节点轮转批量回收；到期删除不写日志，到期时刻随 PUT 持久化，恢复后照常过期
+    void setTtlOptions(const TtlOptions &options);
+    const TtlOptions &getTtlOptions() const;
+    uint64_t nowMs() const;
+    size_t expireResources(size_t maxKeys = 0); // 回收到期资源（0 表示全部），返回回收数
+    bool expireOnRead(Chord *owner, uint32_t rid); // rid 已过期时删除并返回 true
+    TtlStats getTtlStats() const;
+
+    // ===== 入口节点与路由负载 =====
+    // 入口按策略选择并计入该节点的入口数；每个节点在 routeStep 中累计自己执行的路由步数
+    void setEntryOptions(const EntryOptions &options);
+    const EntryOptions &getEntryOptions() const;
+    void setCaller(const Node &caller); // 之后的请求视为由 caller 发出，同步请求计入它与入口之间的往返；空节点表示不区分调用方
+    Node getEntryNode();                // 按策略选出本次请求的入口节点，环为空时返回空节点
+    RoutingLoadStats getRoutingLoadStats() const;
+    void resetRoutingLoad();
+
+    // ===== 路由几何 =====
+    // 默认 Chord finger；切换后立即重算全部路由表，之后每次成员变化都按新几何刷新。
+    // 非 Chord 几何的链接表由管理器按全局成员计算（与 finger 表的全量刷新相同），PNS 只作用于 finger
+    void setGeometry(const GeometryOptions &options);
+    const GeometryOptions &getGeometryOptions() const;
+    const RoutingGeometry *getGeometry() const;
+    RoutingStateStats getRoutingStateStats() const;
+
+    // ===== 成员传播（gossip） =====
+    // 开启后单个节点的加入、离开与崩溃不再由管理器逐个通知全部节点并刷新全部 finger 表，而是以 SWIM 式 gossip 传播：
+    // 各节点得知变化时就地修补自己的路由表，崩溃由 ping / ping-req 检测。传播按轮模拟，不计入网络模拟的时钟；
+    // 批量成员变化、切换几何与载入镜像仍整体重算
+    void setGossipOptions(const GossipOptions &options);
+    const GossipOptions &getGossipOptions() const;
+    const GossipStats &getGossipStats() const;
+    const GossipRun &getLastGossipRun() const; // 最近一次成员变化的传播结果
+    void resetGossipStats();
+
+    // ===== 客户端路由快照 =====
+    // 客户端持有快照后本地定位负责节点并直接发送请求（一跳），节点发现 epoch 不一致时回复 STALE，
+    // 客户端刷新快照后重试；请求消息由客户端计入网络模拟，回复由这里计入
+    uint64_t getEpoch() const;
+    RoutingSnapshot getRoutingSnapshot() const;
+    DirectStatus lookupDirect(const Node &client, uint32_t nodeId, uint64_t clientEpoch, const std::string &resource);
+    DirectStatus putDirect(const Node &client, uint32_t nodeId, uint64_t clientEpoch, const std::string &resource, uint64_t ttlMs = 0);
+    DirectStatus removeDirect(const Node &client, uint32_t nodeId, uint64_t clientEpoch, const std::string &resource);
 
     // ===== 新增 CLI 辅助方法 =====
     bool join(const std::string &ip);               // 通过 IP 添加节点
-    bool removeNodeByIP(const std::string &ip);     // 通过 IP 删除节点
+    bool removeNodeByIP(const std::string &ip, bool graceful = true); // 通过 IP 删除节点（graceful=false 为崩溃）
     Node getNodeByIP(const std::string &ip) const;  // 通过 IP 获取节点（若不存在返回空 Node）
     bool nodeExists(const std::string &ip) const;   // 检查节点是否存在
     std::vector<std::string> getAllNodeIPs() const; // 获取所有节点 IP 列表
@@ -80,19 +437,45 @@ private:
     Node self;
     Node predecessor;
     Node successor;
-    std::vector<FingerEntry> fingerTable;
+    // finger i 指向的节点ID，起点 (self.id + 2^i) mod 2^m 按需计算；IP 仅在展示时解析
+    // 长度补齐到 FINGER_LANES 的倍数供 SIMD 内核整块比较，多出的槽位固定为 self.id
+    static const int FINGER_SLOTS = (m + FINGER_LANES - 1) / FINGER_LANES * FINGER_LANES;
+    uint32_t fingerIds[FINGER_SLOTS];
+    float fingerRtt[m]; // finger i 的 RTT 估计（毫秒），0 表示未测量
     ChordProxy *proxy;
-    std::map<uint32_t, std::string> resources;
+    ResourceMap resources;
+    BlockedBloomFilter filter; // resources 中资源ID的过滤器，容量按资源数翻倍增长
+    uint32_t filterCapacity;
+    uint32_t filterStale; // 删除或迁出后残留在过滤器中的键数，过多时重建
+    DeadlineMap deadlines;            // 带 TTL 的资源的到期时刻
+    mutable RoutingLoad load;         // 路由负载计数，routeStep 为 const（异步接口共用）
+    std::unique_ptr<TimerWheel> wheel; // 有带 TTL 的资源时才分配
+    const RoutingGeometry *geometry;   // 路由几何，决定路由表与下一跳的选择
+    std::vector<uint32_t> links;       // 非 Chord 几何的链接表，按顺时针距离升序，补齐到 FINGER_LANES 的倍数（填 self.id）；为空时使用 finger 数组
 
     void initAsFirstNode();
-    bool isInInterval(uint32_t id, uint32_t start, uint32_t end);
-    bool isInOpenInterval(uint32_t id, uint32_t start, uint32_t end);
+    static bool isInInterval(uint32_t id, uint32_t start, uint32_t end);
+    static bool isInOpenInterval(uint32_t id, uint32_t start, uint32_t end);
+    uint32_t closestPrecedingFinger(uint32_t id) const; // 按几何在路由表中选下一跳
+    Node resolveNode(uint32_t id) const;
+    void filterAdded(uint32_t rid); // 资源已放入 resources 后调用
+    void filterRemoved(size_t count);
+    void rebuildFilter();
+    void handOverDeadlines(Chord *target, const ResourceChunk &chunk); // 迁移分块后把其中资源的到期时刻交给接收方
+    void forgetDeadline(uint32_t rid);
+    void clearDeadlines();
+    size_t linkCount() const;        // 链接表去掉末尾填充后的长度
+    void padLinks(size_t count);     // 截到 count 项后重新补齐到 FINGER_LANES 的倍数
+    uint32_t memberOwner(uint32_t id) const; // 全成员表中 id 的后继，表中没有其他节点时为自身
+    std::vector<uint32_t>::iterator memberSlot(uint32_t id, size_t count); // 全成员表前 count 项中 id 的顺时针插入位置
+    void copyMembership(const Chord *from);  // 单跳加入：从 from 取得全成员表，本地算出 finger
 
 public:
     Chord(Node self, ChordProxy *proxy);
     ~Chord();
 
-    Node findSuccessor(uint32_t id);
+    Node findSuccessor(uint32_t id, int *hops = nullptr);
+    bool routeStep(uint32_t id, uint32_t &next) const; // 单步路由，异步接口逐跳推进时使用
     Node findClosestPrecedingNode(uint32_t id);
     Node findPredecessor(uint32_t id);
     void initWithBootstrapNode(Node &bootstrapNode);
@@ -104,15 +487,46 @@ public:
     void joinRing();
     void redistributeResources();
     bool transferResources();
-    bool leaveRing();
+    size_t streamRangeTo(Chord *target, uint32_t start, uint32_t end, const MigrationOptions &options);
+    void receiveResources(const Node &from, ResourceChunk &chunk);
+    bool leaveRing(bool graceful = true);
     void handleNodeLeave(Node &leftNode);
     bool addResource(std::string resource);
     bool addResourceDirectly(uint32_t rid, const std::string &res);
     std::map<uint32_t, std::string> getAllResources() const;
     bool removeResourceDirectly(uint32_t rid);
+    void setExpiry(uint32_t rid, uint64_t deadlineMs); // 为已存在的资源设置到期时刻并登记到时间轮
+    uint64_t getDeadline(uint32_t rid) const;          // 0 表示没有 TTL
+    bool isExpired(uint32_t rid, uint64_t nowMs) const;
+    bool dropIfExpired(uint32_t rid, uint64_t nowMs);  // 已过期时删除（不写日志）并返回 true
+    size_t expireDue(uint64_t nowMs, size_t limit);    // 推进时间轮并删除到期资源，返回删除数
+    const DeadlineMap &getDeadlines() const;
+    size_t getTtlMemoryBytes() const;
+    size_t getWheelEntries() const;
+    void setRouting(const RoutingGeometry *geometry, const std::vector<uint32_t> &links); // links 为空表示使用 finger 数组
+    std::vector<uint32_t> getLinks() const;          // 链接表（不含填充）
+    std::vector<uint32_t> getRoutingEntries() const; // 路由表中的不同远程节点（含前驱与后继），升序
+    void addMember(Node &node);                      // 单跳：成员加入的增量，插入全成员表并就地修补 finger
+    void handleMemberJoin(Node &node);                              // gossip：新成员加入，就地修补 finger 与链接表
+    void handleMemberLeave(const Node &left, uint32_t successorId); // gossip：离开节点由 successorId 接替，就地修补
+    void removeMember(const Node &node);             // 单跳：成员离开的增量，删除并修补后继、前驱与 finger
+    const RoutingLoad &getRoutingLoad() const;
+    void recordEntry(); // 作为入口接收一个请求
+    void resetRoutingLoad();
     Node getSelf() const;
     Node getSuccessor() const;
     Node getPredecessor() const;
+    Node getFingerNode(int i) const;
+    uint32_t getFingerId(int i) const;
+    uint32_t getFingerStart(int i) const;
+    const ResourceMap &getResourceMap() const;
+    bool mayContainResource(uint32_t rid) const; // false 表示一定不存在
+    const BlockedBloomFilter &getFilter() const;
+    void restoreRouting(const Node &pred, const Node &succ);
+    void setFingerNode(int i, const Node &n);
+    void setFingerId(int i, uint32_t id, float rttMs = 0);
+    float getFingerRtt(int i) const;
+    void restoreResource(uint32_t rid, const std::string &res);
     int getResourceCount() const;
     void setPredecessor(const Node &n);
     void setSuccessor(const Node &n);
@@ -0,0 +1,307 @@
+#include "chord_async.h"
+#include "chord.h"
+#include <memory>
+#include <algorithm>
+
+using namespace std;
+
+ChordAsyncRuntime::ChordAsyncRuntime(ChordRingManager &manager, size_t maxInFlight)
+    : manager(manager), maxInFlight(max<size_t>(1, maxInFlight)), outstanding(0), stopping(false), coalescing(true),
+      roundEndMs(0)
+{
+    worker = thread(&ChordAsyncRuntime::run, this);
+}
+
+ChordAsyncRuntime::~ChordAsyncRuntime()
+{
+    {
+        lock_guard<mutex> lock(mtx);
+        stopping = true;
+    }
+    wakeup.notify_one();
+    worker.join();
+}
+
+/**
+ * @brief 提交一个异步操作，不访问管理器（资源 ID 在工作线程上计算）
+ * @param type 操作类型
+ * @param resource 资源名称
+ * @param done 完成回调，在工作线程上执行
+ */
+void ChordAsyncRuntime::submit(AsyncOpType type, const string &resource, AsyncCallback done)
+{
+    Request *req = new Request{type, resource, 0, nullptr, Node(), 0, 0, 0, std::move(done), nullptr, {}};
+    {
+        lock_guard<mutex> lock(mtx);
+        incoming.push_back(req);
+        outstanding++;
+        counters.submitted++;
+    }
+    wakeup.notify_one();
+}
+
+future<Node> ChordAsyncRuntime::lookup(const string &resource)
+{
+    auto promise = make_shared<std::promise<Node>>();
+    submit(AsyncOpType::LOOKUP, resource, [promise](const AsyncResult &r)
+           { promise->set_value(r.node); });
+    return promise->get_future();
+}
+
+future<bool> ChordAsyncRuntime::put(const string &resource)
+{
+    auto promise = make_shared<std::promise<bool>>();
+    submit(AsyncOpType::PUT, resource, [promise](const AsyncResult &r)
+           { promise->set_value(r.ok); });
+    return promise->get_future();
+}
+
+future<bool> ChordAsyncRuntime::remove(const string &resource)
+{
+    auto promise = make_shared<std::promise<bool>>();
+    submit(AsyncOpType::REMOVE, resource, [promise](const AsyncResult &r)
+           { promise->set_value(r.ok); });
+    return promise->get_future();
+}
+
+void ChordAsyncRuntime::drain()
+{
+    unique_lock<mutex> lock(mtx);
+    idle.wait(lock, [this]
+              { return outstanding == 0; });
+}
+
+void ChordAsyncRuntime::setCoalescing(bool enabled)
+{
+    lock_guard<mutex> lock(mtx);
+    coalescing = enabled;
+}
+
+AsyncStats ChordAsyncRuntime::stats()
+{
+    lock_guard<mutex> lock(mtx);
+    return counters;
+}
+
+/**
+ * @brief 工作线程主循环：取出新请求补满在途窗口，然后让每个在途请求前进一跳，直到全部完成
+ */
+void ChordAsyncRuntime::run()
+{
+    vector<Request *> active;
+    for (;;)
+    {
+        {
+            unique_lock<mutex> lock(mtx);
+            if (active.empty())
+                wakeup.wait(lock, [this]
+                            { return stopping || !incoming.empty(); });
+            while (!incoming.empty() && active.size() < maxInFlight)
+            {
+                Request *req = incoming.front();
+                incoming.pop_front();
+                req->rid = manager.resourceIdOf(req->resource);
+                // 同一资源ID已有查找在途时挂到它下面，不单独路由
+                if (req->type == AsyncOpType::LOOKUP && coalescing)
+                {
+                    auto leader = routing.find(req->rid);
+                    if (leader != routing.end())
+                    {
+                        leader->second->waiters.push_back(req);
+                        continue;
+                    }
+                    routing.emplace(req->rid, req);
+                }
+                active.push_back(req);
+            }
+            if (active.empty())
+                break; // 只有在 stopping 且没有剩余请求时才会走到这里
+            counters.rounds++;
+            counters.maxInFlight = max(counters.maxInFlight, active.size());
+        }
+
+        NetworkEmulator *network = manager.getNetwork();
+        roundEndMs = network ? network->now() : 0;
+        for (Request *req : active)
+        {
+            if (req->current == nullptr)
+                req->startMs = roundEndMs;
+        }
+        for (size_t i = 0; i < active.size();)
+        {
+            if (advance(*active[i]))
+            {
+                active[i] = active.back();
+                active.pop_back();
+            }
+            else
+                i++;
+        }
+        if (network)
+            network->advanceTo(roundEndMs);
+    }
+}
+
+/**
+ * @brief 经代理发送一条消息，模拟耗时只累加到该请求，并更新本轮的最晚时刻
+ */
+void ChordAsyncRuntime::send(Request &req, const Node &from, const Node &to, size_t payloadBytes)
+{
+    req.simulatedMs += manager.getProxy().sendConcurrentMessage(from, to, payloadBytes);
+    roundEndMs = max(roundEndMs, req.startMs + req.simulatedMs);
+}
+
+/**
+ * @brief 让请求前进一跳，路由方式与 Chord::findSuccessor 相同（入口按管理器的入口策略选择），
+ *        每一跳与确定后继后的回复都经代理发送，消息数与同步请求相同，模拟耗时计入该请求自己
+ * @param req 在途请求
+ * @return true 若请求已完成（已调用回调并释放）
+ */
+bool ChordAsyncRuntime::advance(Request &req)
+{
+    if (req.current == nullptr)
+    {
+        req.entry = manager.getEntryNode();
+        req.current = req.entry.isEmpty() ? nullptr : manager.findChordNode(req.entry.id);
+        if (req.current == nullptr)
+        {
+            finish(&req, nullptr);
+            return true;
+        }
+    }
+    // 负责节点已由同区间的查找确定：入口节点直接发给它
+    if (req.owner)
+    {
+        finish(&req, req.owner);
+        return true;
+    }
+
+    uint32_t next;
+    if (req.current->routeStep(req.rid, next))
+    {
+        // 确定后继的节点把结果回给入口节点
+        send(req, req.current->getSelf(), req.entry);
+        finish(&req, manager.findChordNode(next));
+        return true;
+    }
+    Chord *nextChord = manager.findChordNode(next);
+    if (nextChord == nullptr)
+    {
+        finish(&req, manager.findChordNode(req.current->getSuccessor().id));
+        return true;
+    }
+    send(req, req.current->getSelf(), nextChord->getSelf());
+    req.current = nextChord;
+    req.hops++;
+#if defined(__GNUC__)
+    // 下一轮才会访问该节点，提前取入缓存，与其他请求的处理重叠
+    __builtin_prefetch(nextChord);
+#endif
+    return false;
+}
+
+/**
+ * @brief 查找到达负责节点后，把资源ID落在其负责区间 (前驱, owner] 内的其余在途查找转到 owner，
+ *        它们在下一次推进时直接完成，不再继续路由
+ * @param owner 负责节点
+ */
+void ChordAsyncRuntime::shareInterval(Chord *owner)
+{
+    uint32_t hi = owner->getSelf().id;
+    Node pred = owner->getPredecessor();
+    size_t shared = 0;
+    auto take = [&](map<uint32_t, Request *>::iterator begin, map<uint32_t, Request *>::iterator end)
+    {
+        for (auto it = begin; it != end;)
+        {
+            it->second->owner = owner;
+            shared++;
+            it = routing.erase(it);
+        }
+    };
+    if (pred.isEmpty() || pred.id == hi)
+        take(routing.begin(), routing.end()); // 只有一个节点，负责整个环
+    else if (pred.id < hi)
+        take(routing.upper_bound(pred.id), routing.upper_bound(hi));
+    else
+    {
+        take(routing.upper_bound(pred.id), routing.end()); // 区间跨过 0
+        take(routing.begin(), routing.upper_bound(hi));
+    }
+    if (shared == 0)
+        return;
+    lock_guard<mutex> lock(mtx);
+    counters.intervalShared += shared;
+}
+
+/**
+ * @brief 入口节点把请求发给负责节点并执行操作（消息与同步接口相同，查找经 lookupResourceAt 计入过滤器统计），
+ *        回调后释放请求；合并到该请求的同ID查找得到同样的结果
+ * @param req 请求
+ * @param owner 负责节点，环为空时为 nullptr
+ */
+void ChordAsyncRuntime::finish(Request *req, Chord *owner)
+{
+    if (req->type == AsyncOpType::LOOKUP)
+    {
+        auto it = routing.find(req->rid);
+        if (it != routing.end() && it->second == req)
+            routing.erase(it);
+        if (owner && !routing.empty())
+            shareInterval(owner);
+    }
+
+    AsyncResult result;
+    result.hops = req->hops;
+    if (owner)
+    {
+        Node self = owner->getSelf();
+        switch (req->type)
+        {
+        case AsyncOpType::LOOKUP:
+            send(*req, req->entry, self);
+            result.ok = manager.lookupResourceAt(owner, req->rid, req->entry, &req->simulatedMs);
+            roundEndMs = max(roundEndMs, req->startMs + req->simulatedMs);
+            result.node = result.ok ? self : Node();
+            break;
+        case AsyncOpType::PUT:
+            send(*req, req->entry, self, req->resource.size());
+            send(*req, self, req->entry);
+            result.ok = manager.addResourceAt(owner, req->resource);
+            result.node = self;
+            break;
+        case AsyncOpType::REMOVE:
+            send(*req, req->entry, self, req->resource.size());
+            send(*req, self, req->entry);
+            result.ok = manager.removeResourceAt(owner, req->rid, req->resource);
+            result.node = self;
+            break;
+        }
+    }
+    result.simulatedMs = req->simulatedMs;
+    if (req->done)
+        req->done(result);
+    vector<Request *> waiters;
+    waiters.swap(req->waiters);
+    bool lookup = req->type == AsyncOpType::LOOKUP;
+    delete req;
+    for (Request *waiter : waiters)
+    {
+        if (waiter->done)
+            waiter->done(result);
+        delete waiter;
+    }
+
+    lock_guard<mutex> lock(mtx);
+    counters.completed += 1 + waiters.size();
+    counters.hops += result.hops; // 合并的查找没有单独路由，不计跳数与耗时
+    counters.simulatedMs += result.simulatedMs;
+    if (lookup)
+    {
+        counters.lookups += 1 + waiters.size();
+        counters.coalesced += waiters.size();
+    }
+    outstanding -= 1 + waiters.size();
+    if (outstanding == 0)
+        idle.notify_all();
+}
@@ -0,0 +1,149 @@
+#ifndef CHORD_ASYNC_H
+#define CHORD_ASYNC_H
+
+#include "node.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(CHORD_COROUTINES) && defined(__cpp_impl_coroutine)
+#include <coroutine>
+#endif
+
+class ChordRingManager;
+class Chord;
+
+// 异步操作类型
+enum class AsyncOpType
+{
+    LOOKUP,
+    PUT,
+    REMOVE
+};
+
+// 一次异步操作的结果：LOOKUP 的 node 为持有资源的节点（不存在时为空），PUT/REMOVE 的 node 为负责节点
+struct AsyncResult
+{
+    bool ok = false;
+    Node node;
+    int hops = 0;
+    double simulatedMs = 0; // 开启网络模拟时，本请求自身各条消息的模拟耗时之和（与其他请求重叠的部分不计入）
+};
+
+typedef std::function<void(const AsyncResult &)> AsyncCallback;
+
+// 异步运行时统计
+struct AsyncStats
+{
+    uint64_t submitted = 0;
+    uint64_t completed = 0;
+    uint64_t hops = 0;
+    uint64_t rounds = 0;      // 运行时推进轮数（每轮所有在途请求各前进一跳）
+    size_t maxInFlight = 0;   // 同时在途请求数的峰值
+    uint64_t lookups = 0;        // 完成的查找数
+    uint64_t coalesced = 0;      // 与在途的同ID查找合并、没有单独路由的查找数
+    uint64_t intervalShared = 0; // 路由途中因另一个查找确定了同一负责区间而提前结束的查找数
+    double simulatedMs = 0;      // 已完成请求各自模拟耗时之和（合并的查找不重复计入）
+
+    double coalesceRate() const { return lookups ? static_cast<double>(coalesced + intervalShared) / lookups : 0; }
+};
+
+// 节点运行时：一个工作线程持有所有在途请求，每轮让每个请求前进一跳，
+// 不同请求的路由跳交错执行（流水线），单个请求的跳数与同步 findSuccessor 完全相同。
+// 查找合并（默认开启）：同一资源ID已有查找在途时，新查找挂在它下面，不占在途窗口，随它一起完成；
+// 一个查找到达负责节点后，其负责区间 (前驱, 负责节点] 内其余在途查找直接转到该节点，不再继续路由。
+// 开启网络模拟时，每个请求的消息只累加到它自己的模拟耗时，虚拟时钟每轮推进到本轮最晚的请求，流水线上的请求不按先后串行计时。
+// 回调在工作线程上执行。工作线程不加锁地使用管理器（入口选择、过滤器统计、TTL 回收、内存池、WAL、网络模拟），
+// 因此请求在途期间（submit 之后到 drain() 返回之前）调用方不能调用管理器的任何接口，包括同步查找与统计；
+// submit 不访问管理器，资源 ID 在工作线程上计算。
+class ChordAsyncRuntime
+{
+private:
+    struct Request
+    {
+        AsyncOpType type;
+        std::string resource;
+        uint32_t rid;
+        Chord *current; // 当前所在节点，nullptr 表示尚未进入环
+        Node entry;     // 入口节点：路由结果与操作回复都发回这里
+        int hops;
+        double startMs;     // 进入在途窗口时的虚拟时钟
+        double simulatedMs; // 已发送消息的模拟耗时之和
+        AsyncCallback done;
+        Chord *owner;                   // 已由同区间的查找确定的负责节点，下一次推进时直接完成
+        std::vector<Request *> waiters; // 合并到本请求的同ID查找
+    };
+
+    ChordRingManager &manager;
+    size_t maxInFlight;
+    std::mutex mtx;
+    std::condition_variable wakeup; // 有新请求或需要停止
+    std::condition_variable idle;   // 所有请求完成
+    std::deque<Request *> incoming;
+    uint64_t outstanding;
+    bool stopping;
+    bool coalescing;
+    AsyncStats counters;
+    std::map<uint32_t, Request *> routing; // 正在路由的查找：资源ID → 请求（仅工作线程访问）
+    double roundEndMs;                     // 本轮各请求的最晚虚拟时刻（仅工作线程访问）
+    std::thread worker;
+
+    void run();
+    bool advance(Request &req);
+    void finish(Request *req, Chord *owner);
+    void shareInterval(Chord *owner); // 把负责区间内其余在途查找转到 owner
+    void send(Request &req, const Node &from, const Node &to, size_t payloadBytes = 0); // 经代理发送，耗时计入 req
+
+public:
+    explicit ChordAsyncRuntime(ChordRingManager &manager, size_t maxInFlight = 4096);
+    ~ChordAsyncRuntime(); // 完成所有已提交的请求后停止工作线程
+    ChordAsyncRuntime(const ChordAsyncRuntime &) = delete;
+    ChordAsyncRuntime &operator=(const ChordAsyncRuntime &) = delete;
+
+    void submit(AsyncOpType type, const std::string &resource, AsyncCallback done);
+    std::future<Node> lookup(const std::string &resource);
+    std::future<bool> put(const std::string &resource);
+    std::future<bool> remove(const std::string &resource);
+    void drain(); // 阻塞直到所有已提交的请求完成（不能在回调中调用）
+    void setCoalescing(bool enabled); // 只影响之后进入在途窗口的请求
+    AsyncStats stats();
+};
+
+#if defined(CHORD_COROUTINES) && defined(__cpp_impl_coroutine)
+// C++20 协程等待体：co_await awaitLookup(runtime, "a.pdf") 得到 AsyncResult，协程在运行时的工作线程上恢复
+class AsyncAwaitable
+{
+private:
+    ChordAsyncRuntime &runtime;
+    AsyncOpType type;
+    std::string resource;
+    AsyncResult result;
+
+public:
+    AsyncAwaitable(ChordAsyncRuntime &runtime, AsyncOpType type, std::string resource)
+        : runtime(runtime), type(type), resource(std::move(resource)) {}
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        runtime.submit(type, resource, [this, handle](const AsyncResult &r)
+                       {
+            result = r;
+            handle.resume(); });
+    }
+    AsyncResult await_resume() const { return result; }
+};
+
+inline AsyncAwaitable awaitLookup(ChordAsyncRuntime &runtime, const std::string &resource) { return AsyncAwaitable(runtime, AsyncOpType::LOOKUP, resource); }
+inline AsyncAwaitable awaitPut(ChordAsyncRuntime &runtime, const std::string &resource) { return AsyncAwaitable(runtime, AsyncOpType::PUT, resource); }
+inline AsyncAwaitable awaitRemove(ChordAsyncRuntime &runtime, const std::string &resource) { return AsyncAwaitable(runtime, AsyncOpType::REMOVE, resource); }
+#endif
+
+#endif // CHORD_ASYNC_H
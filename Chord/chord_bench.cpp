@@ -0,0 +1,901 @@
+// 环操作基准测试：在 10 / 1k / 100k 节点规模下测量 join、leave、put、lookup、remove 的吞吐与延迟分位数，
+// 以及查找跳数和每节点内存，结果写成 JSON 与 CSV 便于不同版本之间对比。
+// 大环需要更大的标识符空间，编译时加 -DCHORD_M=31。
+
+#include "chord.h"
+#include "logger.h"
+#include "workload.h"
+#include "chord_async.h"
+#include "chord_client.h"
+#include "ring_image.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <string>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <cstdlib>
+#include <cstdio>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// 基准测试配置（均可由命令行覆盖）
+struct BenchOptions
+{
+    vector<size_t> nodeCounts = {10, 1000, 100000};
+    vector<string> distributions = {"uniform", "zipf"};
+    size_t keys = 10000;          // 每轮写入的资源数
+    size_t lookups = 10000;       // 每轮查找次数
+    size_t churn = 20;            // 每轮 join / leave 的节点数
+    size_t maxChurnNodes = 1000;  // 超过该规模的环跳过 join / leave（当前每次加入都会刷新全部 finger 表）
+    double zipfTheta = 0.99;      // Zipf 分布参数
+    size_t verifyEvery = 0;       // 每多少个操作校验一次环（不计入耗时），0 表示只在每轮结束时校验
+    uint64_t seed = 42;
+    string jsonPath = "bench.json";
+    string csvPath = "bench.csv";
+    string net = "off";        // 网络模拟：off / coords / matrix:FILE
+    double netJitterMs = 0;    // 网络模拟：抖动均值
+    double netLoss = 0;        // 网络模拟：丢包率
+    size_t pns = 0;            // 邻近节点选择的候选数，0 表示关闭（需配合 --net）
+    bool filterCache = false;  // 管理器缓存各节点的布隆过滤器，不存在的键在路由前拒绝
+    size_t ttlKeys = 0;        // 每轮写入的带 TTL 的资源数，0 表示跳过 put_ttl / expire
+    string entry = "first";    // 入口策略：first / random / round-robin / nearest / client-hash
+    size_t clients = 64;       // 模拟的调用方数，查找轮流由各调用方发出（nearest / client-hash 按调用方选入口）
+    bool coalesce = true;      // 异步运行时合并在途的同ID / 同负责区间查找
+    string geometry = "chord"; // 路由几何：chord / kademlia / symphony / onehop
+    size_t bucket = 2;         // kademlia：每个桶的节点数
+    size_t links = 4;          // symphony：长链接数
+    size_t maxOneHopNodes = 10000; // onehop 每个节点保存全部成员（共 N² 个 ID），超过该规模的环跳过
+    bool gossip = false;       // 单个节点的加入与离开经 gossip 传播，不逐个通知并刷新全部节点
+    string imagePath;          // 非空时每轮写出环镜像，测量保存、打开（含内容校验）、映射查找与整体载入，用完即删
+};
+
+// 一组操作的测量结果
+struct OpResult
+{
+    size_t nodes;
+    string dist;
+    string op;
+    size_t count = 0;
+    size_t succeeded = 0;
+    double seconds = 0;
+    double p50 = 0, p90 = 0, p99 = 0, p999 = 0, maxUs = 0; // 微秒
+    double hopsMean = 0, hopsP99 = 0, hopsMax = 0;
+    double bytesPerNode = 0;
+    double falsePositiveRate = 0; // lookup_miss：过滤器误判率
+    double filterBytesPerKey = 0; // lookup_miss：过滤器（含缓存）每个资源占用的字节数
+    double loadMaxOverMean = 0;   // lookup：路由步数最多的节点与平均值之比
+    double entryMaxShare = 0;     // lookup：最忙的入口节点接收的请求占比
+    double coalesceRate = 0;      // lookup_async：被合并（未单独走完路由）的查找占比
+    double routingEntries = 0;    // build：每个节点路由表中的不同远程节点数（平均）
+    double entriesChanged = 0;    // join / leave / join_many / remove_many：每个加入或离开的节点引起的路由表项改动数
+    double gossipRounds = 0;      // join / leave（--gossip 1）：每次成员变化传遍全部节点的平均轮数
+    double gossipMessages = 0;    // join / leave（--gossip 1）：每次成员变化的消息数
+    double gossipMaxPerNode = 0;  // join / leave（--gossip 1）：单个节点一轮中发出的最多消息数
+};
+
+namespace
+{
+    uint64_t benchClockMs = 0; // TTL 的虚拟时钟，expire 之前一次拨过全部到期时刻
+
+    /**
+     * @brief 读取当前进程的常驻内存（Linux 下读 /proc/self/statm，其他平台返回 0）
+     * @return size_t 常驻内存字节数
+     */
+    size_t residentBytes()
+    {
+#ifdef __linux__
+        ifstream statm("/proc/self/statm");
+        size_t pages = 0, resident = 0;
+        if (statm >> pages >> resident)
+            return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+        return 0;
+    }
+
+    /**
+     * @brief 计算有序样本的分位数
+     * @param sorted 已升序排列的样本
+     * @param q 分位 [0, 1]
+     * @return double 分位数
+     */
+    double percentile(const vector<double> &sorted, double q)
+    {
+        if (sorted.empty())
+            return 0;
+        size_t idx = static_cast<size_t>(q * (sorted.size() - 1) + 0.5);
+        return sorted[min(idx, sorted.size() - 1)];
+    }
+
+    // 按操作计数调度 ChordRingManager::verify()，校验发生在计时区间之外
+    struct VerifySchedule
+    {
+        size_t every = 0;
+        size_t ops = 0;
+        size_t runs = 0;
+        size_t failures = 0;
+
+        void check(const ChordRingManager &manager)
+        {
+            VerifyReport report = manager.verify(1);
+            runs++;
+            if (!report.ok())
+            {
+                failures++;
+                cerr << "  环校验失败（第 " << ops << " 个操作后）：" << (report.problems.empty() ? "" : report.problems[0]) << endl;
+            }
+        }
+        void tick(const ChordRingManager &manager)
+        {
+            ops++;
+            if (every > 0 && ops % every == 0)
+                check(manager);
+        }
+    };
+
+    // 逐个操作计时，结束时汇总成 OpResult
+    class OpTimer
+    {
+    private:
+        vector<double> samples; // 微秒
+        chrono::steady_clock::time_point begin;
+        double totalSeconds = 0;
+        size_t succeeded = 0;
+
+    public:
+        void start() { begin = chrono::steady_clock::now(); }
+        void stop(bool ok) { record(chrono::duration<double, micro>(chrono::steady_clock::now() - begin).count(), ok); }
+        // 直接记录一个样本（异步完成时间、模拟网络耗时等不由 start/stop 测量的值）
+        void record(double us, bool ok)
+        {
+            samples.push_back(us);
+            totalSeconds += us / 1e6;
+            if (ok)
+                succeeded++;
+        }
+        OpResult finish(size_t nodes, const string &dist, const string &op)
+        {
+            OpResult r;
+            r.nodes = nodes;
+            r.dist = dist;
+            r.op = op;
+            r.count = samples.size();
+            r.succeeded = succeeded;
+            r.seconds = totalSeconds;
+            sort(samples.begin(), samples.end());
+            r.p50 = percentile(samples, 0.50);
+            r.p90 = percentile(samples, 0.90);
+            r.p99 = percentile(samples, 0.99);
+            r.p999 = percentile(samples, 0.999);
+            r.maxUs = samples.empty() ? 0 : samples.back();
+            return r;
+        }
+    };
+
+    typedef map<uint32_t, vector<uint32_t>> RoutingTables;
+
+    // 各节点的路由表项（节点ID → 升序的远程节点ID）
+    RoutingTables routingTables(const ChordRingManager &manager)
+    {
+        RoutingTables tables;
+        for (auto &p : manager.getAllChordNodes())
+            tables.emplace_hint(tables.end(), p.first, p.second->getRoutingEntries());
+        return tables;
+    }
+
+    // 成员变化前后都在环中的节点上新出现的表项数，每一项都要与新的远程节点建立一次联系
+    size_t changedEntries(const RoutingTables &before, const RoutingTables &after)
+    {
+        size_t changed = 0;
+        for (auto &p : after)
+        {
+            auto it = before.find(p.first);
+            if (it == before.end())
+                continue;
+            vector<uint32_t> added;
+            set_difference(p.second.begin(), p.second.end(), it->second.begin(), it->second.end(), back_inserter(added));
+            changed += added.size();
+        }
+        return changed;
+    }
+
+    // 一段操作前后 gossip 累计统计之差
+    void gossipDelta(OpResult &r, const GossipStats &before, const GossipStats &after)
+    {
+        uint64_t events = after.events - before.events;
+        if (events == 0)
+            return;
+        r.gossipRounds = static_cast<double>(after.rounds - before.rounds) / events;
+        r.gossipMessages = static_cast<double>(after.messages - before.messages) / events;
+        r.gossipMaxPerNode = static_cast<double>(after.maxPerNode);
+    }
+
+    string nodeIp(size_t i)
+    {
+        return "10." + to_string((i >> 16) & 0xFF) + "." + to_string((i >> 8) & 0xFF) + "." + to_string(i & 0xFF);
+    }
+
+    string keyName(size_t i) { return "key-" + to_string(i); }
+
+    vector<size_t> parseSizes(const string &s)
+    {
+        vector<size_t> out;
+        stringstream ss(s);
+        string item;
+        while (getline(ss, item, ','))
+            if (!item.empty())
+                out.push_back(static_cast<size_t>(strtoull(item.c_str(), nullptr, 10)));
+        return out;
+    }
+
+    vector<string> parseList(const string &s)
+    {
+        vector<string> out;
+        stringstream ss(s);
+        string item;
+        while (getline(ss, item, ','))
+            if (!item.empty())
+                out.push_back(item);
+        return out;
+    }
+
+    bool parseEntryPolicy(const string &s, EntryPolicy &policy)
+    {
+        static const map<string, EntryPolicy> names = {{"first", EntryPolicy::FIRST},
+                                                       {"random", EntryPolicy::RANDOM},
+                                                       {"round-robin", EntryPolicy::ROUND_ROBIN},
+                                                       {"nearest", EntryPolicy::NEAREST},
+                                                       {"client-hash", EntryPolicy::CLIENT_HASH}};
+        auto it = names.find(s);
+        if (it == names.end())
+            return false;
+        policy = it->second;
+        return true;
+    }
+
+    void printUsage()
+    {
+        cout << "用法: chord_bench [--nodes 10,1000,100000] [--dist uniform,zipf] [--keys N] [--lookups N]\n"
+             << "                  [--churn N] [--max-churn-nodes N] [--zipf THETA] [--seed N] [--verify-every N]\n"
+             << "                  [--json FILE] [--csv FILE] [--net off|coords|matrix:FILE] [--net-jitter MS]\n"
+             << "                  [--net-loss P] [--pns CANDIDATES] [--filter-cache 0|1] [--ttl-keys N]\n"
+             << "                  [--entry first|random|round-robin|nearest|client-hash] [--clients N] [--coalesce 0|1]\n"
+             << "                  [--geometry chord|kademlia|symphony|onehop] [--bucket K] [--links K] [--max-onehop-nodes N]\n"
+             << "                  [--gossip 0|1] [--image FILE]" << endl;
+    }
+
+    bool parseArgs(int argc, char *argv[], BenchOptions &opts)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            string arg = argv[i];
+            if (arg == "--help" || arg == "-h")
+                return false;
+            if (i + 1 >= argc)
+            {
+                cerr << "参数缺少取值：" << arg << endl;
+                return false;
+            }
+            string value = argv[++i];
+            if (arg == "--nodes")
+                opts.nodeCounts = parseSizes(value);
+            else if (arg == "--dist")
+                opts.distributions = parseList(value);
+            else if (arg == "--keys")
+                opts.keys = strtoull(value.c_str(), nullptr, 10);
+            else if (arg == "--lookups")
+                opts.lookups = strtoull(value.c_str(), nullptr, 10);
+            else if (arg == "--churn")
+                opts.churn = strtoull(value.c_str(), nullptr, 10);
+            else if (arg == "--max-churn-nodes")
+                opts.maxChurnNodes = strtoull(value.c_str(), nullptr, 10);
+            else if (arg == "--zipf")
+                opts.zipfTheta = atof(value.c_str());
+            else if (arg == "--seed")
+                opts.seed = strtoull(value.c_str(), nullptr, 10);
+            else if (arg == "--verify-every")
+                opts.verifyEvery = strtoull(value.c_str(), nullptr, 10);
+            else if (arg == "--json")
+                opts.jsonPath = value;
+            else if (arg == "--csv")
+                opts.csvPath = value;
+            else if (arg == "--net")
+                opts.net = value;
+            else if (arg == "--net-jitter")
+                opts.netJitterMs = atof(value.c_str());
+            else if (arg == "--net-loss")
+                opts.netLoss = atof(value.c_str());
+            else if (arg == "--pns")
+                opts.pns = strtoull(value.c_str(), nullptr, 10);
+            else if (arg == "--filter-cache")
+                opts.filterCache = value != "0";
+            else if (arg == "--ttl-keys")
+                opts.ttlKeys = strtoull(value.c_str(), nullptr, 10);
+            else if (arg == "--entry")
+                opts.entry = value;
+            else if (arg == "--clients")
+                opts.clients = max<size_t>(1, strtoull(value.c_str(), nullptr, 10));
+            else if (arg == "--coalesce")
+                opts.coalesce = value != "0";
+            else if (arg == "--geometry")
+                opts.geometry = value;
+            else if (arg == "--max-onehop-nodes")
+                opts.maxOneHopNodes = strtoull(value.c_str(), nullptr, 10);
+            else if (arg == "--gossip")
+                opts.gossip = value != "0";
+            else if (arg == "--bucket")
+                opts.bucket = max<size_t>(1, strtoull(value.c_str(), nullptr, 10));
+            else if (arg == "--links")
+                opts.links = max<size_t>(1, strtoull(value.c_str(), nullptr, 10));
+            else if (arg == "--image")
+                opts.imagePath = value;
+            else
+            {
+                cerr << "未知参数：" << arg << endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief 在一个已构建的环上跑一轮：写入全部资源、按分布查找、join/leave、删除全部资源
+     * @param manager 环管理器（进入时只有节点没有资源，返回时恢复为同样的状态）
+     * @param nodes 环规模
+     * @param dist 查找的键分布 uniform / zipf
+     * @param opts 配置
+     * @param rng 随机数发生器
+     * @param results 结果输出
+     * @param verifier 环校验调度
+     */
+    void runRound(ChordRingManager &manager, size_t nodes, const string &dist, const BenchOptions &opts,
+                  mt19937_64 &rng, vector<OpResult> &results, VerifySchedule &verifier)
+    {
+        vector<size_t> order(opts.keys);
+        for (size_t i = 0; i < order.size(); i++)
+            order[i] = i;
+        shuffle(order.begin(), order.end(), rng);
+
+        // put：键名经哈希后在环上均匀分布，写入顺序随机
+        OpTimer put;
+        for (size_t k : order)
+        {
+            string key = keyName(k);
+            put.start();
+            bool ok = manager.addResource(key);
+            put.stop(ok);
+            verifier.tick(manager);
+        }
+        results.push_back(put.finish(nodes, dist, "put"));
+
+        // lookup：uniform 均匀抽取；zipf 按秩抽取，热点键集中在少数节点
+        ZipfGenerator zipf(opts.keys, opts.zipfTheta);
+        OpTimer lookup, lookupNet;
+        NetworkEmulator *network = manager.getNetwork();
+        vector<double> hops;
+        hops.reserve(opts.lookups);
+        vector<Node> callers;
+        for (size_t c = 0; c < opts.clients; c++)
+            callers.push_back(Node("192.168." + to_string((c >> 8) & 0xFF) + "." + to_string(c & 0xFF)));
+        vector<string> lookedUp;
+        vector<uint32_t> owners;
+        manager.resetRoutingLoad();
+        for (size_t i = 0; i < opts.lookups && opts.keys > 0; i++)
+        {
+            size_t k = dist == "zipf" ? order[zipf(rng)] : order[rng() % opts.keys];
+            string key = keyName(k);
+            manager.setCaller(callers[i % callers.size()]);
+            int h = 0;
+            double simStart = network ? network->now() : 0;
+            lookup.start();
+            Node owner = manager.lookupResource(key, &h);
+            lookup.stop(!owner.isEmpty());
+            if (network)
+                lookupNet.record((network->now() - simStart) * 1000, !owner.isEmpty());
+            lookedUp.push_back(key);
+            owners.push_back(owner.id);
+            hops.push_back(h);
+        }
+        manager.setCaller(Node());
+        RoutingLoadStats load = manager.getRoutingLoadStats();
+        OpResult lr = lookup.finish(nodes, dist, "lookup");
+        lr.loadMaxOverMean = load.maxOverMean();
+        lr.entryMaxShare = load.entries ? static_cast<double>(load.maxEntries) / load.entries : 0;
+        if (!hops.empty())
+        {
+            double sum = 0;
+            for (double h : hops)
+                sum += h;
+            sort(hops.begin(), hops.end());
+            lr.hopsMean = sum / hops.size();
+            lr.hopsP99 = percentile(hops, 0.99);
+            lr.hopsMax = hops.back();
+        }
+        results.push_back(lr);
+        if (network)
+            results.push_back(lookupNet.finish(nodes, dist, "lookup_net"));
+
+        // lookup_client：同一组键由持有路由快照的客户端直连负责节点查找（一跳），结果与同步查找逐个比对；
+        // 快照拉取计入第一次查找
+        {
+            OpTimer direct, directNet;
+            unique_ptr<ChordClient> client;
+            for (size_t i = 0; i < lookedUp.size(); i++)
+            {
+                double simStart = network ? network->now() : 0;
+                direct.start();
+                if (!client)
+                    client.reset(new ChordClient(manager, "10.255.255.254"));
+                Node owner = client->lookup(lookedUp[i]);
+                direct.stop(!owner.isEmpty() && owner.id == owners[i]);
+                if (network)
+                    directNet.record((network->now() - simStart) * 1000, !owner.isEmpty());
+            }
+            OpResult cr = direct.finish(nodes, dist, "lookup_client");
+            cr.hopsMean = cr.hopsP99 = cr.hopsMax = lookedUp.empty() ? 0 : 1;
+            results.push_back(cr);
+            if (network)
+                results.push_back(directNet.finish(nodes, dist, "lookup_client_net"));
+        }
+
+        // lookup_async：同一组键一次性提交给节点运行时，多个查找的路由跳交错执行；
+        // 延迟为提交到完成的时间，结果与同步查找逐个比对；开启合并时报告合并率；
+        // 开启网络模拟时 lookup_async_net 为每个请求自身消息的模拟耗时（流水线上重叠的请求不互相累加）
+        {
+            ChordAsyncRuntime &runtime = manager.getAsyncRuntime();
+            runtime.setCoalescing(opts.coalesce);
+            AsyncStats before = runtime.stats();
+            size_t n = lookedUp.size();
+            vector<chrono::steady_clock::time_point> submitted(n);
+            vector<double> latency(n), simulated(n);
+            vector<char> matched(n, 0);
+            auto begin = chrono::steady_clock::now();
+            for (size_t i = 0; i < n; i++)
+            {
+                submitted[i] = chrono::steady_clock::now();
+                runtime.submit(AsyncOpType::LOOKUP, lookedUp[i], [&, i](const AsyncResult &r)
+                               {
+                    latency[i] = chrono::duration<double, micro>(chrono::steady_clock::now() - submitted[i]).count();
+                    simulated[i] = r.simulatedMs;
+                    matched[i] = r.ok && r.node.id == owners[i]; });
+            }
+            runtime.drain();
+            OpTimer async;
+            for (size_t i = 0; i < n; i++)
+                async.record(latency[i], matched[i] != 0);
+            OpResult ar = async.finish(nodes, dist, "lookup_async");
+            ar.seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+            AsyncStats after = runtime.stats();
+            uint64_t lookups = after.lookups - before.lookups;
+            uint64_t merged = after.coalesced - before.coalesced + after.intervalShared - before.intervalShared;
+            ar.coalesceRate = lookups ? static_cast<double>(merged) / lookups : 0;
+            results.push_back(ar);
+            if (network)
+            {
+                OpTimer asyncNet;
+                for (size_t i = 0; i < n; i++)
+                    asyncNet.record(simulated[i] * 1000, matched[i] != 0);
+                results.push_back(asyncNet.finish(nodes, dist, "lookup_async_net"));
+            }
+        }
+
+        // lookup_miss：查找从未写入的键，由负责节点（或开启缓存时由管理器）的布隆过滤器直接否定
+        {
+            manager.resetFilterStats();
+            OpTimer miss;
+            for (size_t i = 0; i < opts.lookups; i++)
+            {
+                string key = "miss-" + to_string(i);
+                miss.start();
+                Node owner = manager.lookupResource(key);
+                miss.stop(owner.isEmpty());
+            }
+            OpResult mr = miss.finish(nodes, dist, "lookup_miss");
+            FilterStats fs = manager.getFilterStats();
+            mr.falsePositiveRate = fs.falsePositiveRate();
+            mr.filterBytesPerKey = fs.keys ? static_cast<double>(fs.nodeFilterBytes + fs.cacheBytes) / fs.keys : 0;
+            results.push_back(mr);
+        }
+
+        // image_*：写出环镜像后 mmap 打开，直接在映射上查找同一组键（结果与同步查找比对），
+        // 再整体载入到新的管理器。打开与映射查找不随环的规模增长；内容校验与载入都是 O(N·m + K)，
+        // 内容校验单独计时（image_verify），结果缓存，image_load 中不再重复
+        if (!opts.imagePath.empty())
+        {
+            OpTimer save, open, verify, imageLookup, load;
+            save.start();
+            bool saved = manager.saveRingImage(opts.imagePath);
+            save.stop(saved);
+            results.push_back(save.finish(nodes, dist, "image_save"));
+
+            RingImage image;
+            open.start();
+            bool opened = saved && image.open(opts.imagePath);
+            open.stop(opened);
+            results.push_back(open.finish(nodes, dist, "image_open"));
+
+            if (opened)
+            {
+                verify.start();
+                verify.stop(image.contentsValid());
+            }
+            results.push_back(verify.finish(nodes, dist, "image_verify"));
+
+            for (size_t i = 0; i < lookedUp.size() && opened; i++)
+            {
+                size_t index = 0;
+                imageLookup.start();
+                bool found = image.lookup(manager.resourceIdOf(lookedUp[i]), index, nullptr);
+                imageLookup.stop(found && image.nodeId(index) == owners[i]);
+            }
+            results.push_back(imageLookup.finish(nodes, dist, "image_lookup"));
+
+            if (opened)
+            {
+                ChordRingManager restored;
+                load.start();
+                bool loaded = restored.loadRingImage(image);
+                load.stop(loaded && restored.getAllChordNodes().size() == manager.getAllChordNodes().size());
+            }
+            results.push_back(load.finish(nodes, dist, "image_load"));
+            image.close();
+            remove(opts.imagePath.c_str());
+        }
+
+        // join / leave：走完整的加入与离开流程（含资源迁移），大环上单次代价过高时跳过
+        if (nodes <= opts.maxChurnNodes && opts.churn > 0)
+        {
+            RoutingTables tables = routingTables(manager);
+            vector<string> added;
+            OpTimer join, joinNet;
+            GossipStats gossipBefore = manager.getGossipStats();
+            for (size_t i = 0; i < opts.churn; i++)
+            {
+                string ip = "172.16." + to_string((i >> 8) & 0xFF) + "." + to_string(i & 0xFF);
+                double simStart = network ? network->now() : 0;
+                join.start();
+                bool ok = manager.join(ip);
+                join.stop(ok);
+                if (network)
+                    joinNet.record((network->now() - simStart) * 1000, ok);
+                verifier.tick(manager);
+                if (ok)
+                    added.push_back(ip);
+            }
+            OpResult jr = join.finish(nodes, dist, "join");
+            RoutingTables joined = routingTables(manager);
+            jr.entriesChanged = added.empty() ? 0 : static_cast<double>(changedEntries(tables, joined)) / added.size();
+            gossipDelta(jr, gossipBefore, manager.getGossipStats());
+            results.push_back(jr);
+            if (network)
+                results.push_back(joinNet.finish(nodes, dist, "join_net"));
+
+            OpTimer leave;
+            gossipBefore = manager.getGossipStats();
+            for (const auto &ip : added)
+            {
+                leave.start();
+                bool ok = manager.removeNodeByIP(ip);
+                leave.stop(ok);
+                verifier.tick(manager);
+            }
+            OpResult lv = leave.finish(nodes, dist, "leave");
+            lv.entriesChanged = added.empty() ? 0 : static_cast<double>(changedEntries(joined, routingTables(manager))) / added.size();
+            gossipDelta(lv, gossipBefore, manager.getGossipStats());
+            results.push_back(lv);
+        }
+        else
+        {
+            cout << "  跳过 join/leave（" << nodes << " > --max-churn-nodes " << opts.maxChurnNodes << "）" << endl;
+        }
+
+        // remove：随机顺序删除全部资源，环恢复为空资源状态
+        shuffle(order.begin(), order.end(), rng);
+        OpTimer remove;
+        for (size_t k : order)
+        {
+            string key = keyName(k);
+            remove.start();
+            bool ok = manager.removeResource(key);
+            remove.stop(ok);
+            verifier.tick(manager);
+        }
+        results.push_back(remove.finish(nodes, dist, "remove"));
+        verifier.check(manager);
+
+        // put_ttl / expire：写入 TTL 在 [1, 60] 秒内均匀分布的资源，把虚拟时钟拨过 60 秒后一次回收全部到期资源
+        if (opts.ttlKeys > 0)
+        {
+            uniform_int_distribution<uint64_t> ttl(1000, 60000);
+            OpTimer putTtl;
+            size_t added = 0; // 资源ID冲突的写入会失败，回收数与成功写入数比较
+            for (size_t i = 0; i < opts.ttlKeys; i++)
+            {
+                string key = "ttl-" + to_string(i);
+                putTtl.start();
+                bool ok = manager.addResource(key, ttl(rng));
+                putTtl.stop(ok);
+                added += ok;
+            }
+            results.push_back(putTtl.finish(nodes, dist, "put_ttl"));
+
+            benchClockMs += 60000;
+            OpTimer expire;
+            expire.start();
+            size_t reclaimed = manager.expireResources();
+            expire.stop(reclaimed == added);
+            OpResult er = expire.finish(nodes, dist, "expire");
+            er.count = added;
+            er.succeeded = reclaimed;
+            results.push_back(er);
+            verifier.check(manager);
+        }
+    }
+
+    void writeCsv(const string &path, const vector<OpResult> &results)
+    {
+        ofstream out(path);
+        if (!out)
+        {
+            cerr << "无法写入 " << path << endl;
+            return;
+        }
+        out << "m,nodes,dist,op,count,succeeded,seconds,ops_per_sec,p50_us,p90_us,p99_us,p999_us,max_us,"
+               "hops_mean,hops_p99,hops_max,bytes_per_node,false_positive_rate,filter_bytes_per_key,load_max_over_mean,"
+               "entry_max_share,coalesce_rate,routing_entries,entries_changed,gossip_rounds,gossip_messages,"
+               "gossip_max_per_node\n";
+        for (const auto &r : results)
+        {
+            out << m << ',' << r.nodes << ',' << r.dist << ',' << r.op << ',' << r.count << ',' << r.succeeded << ','
+                << r.seconds << ',' << (r.seconds > 0 ? r.count / r.seconds : 0) << ',' << r.p50 << ',' << r.p90 << ','
+                << r.p99 << ',' << r.p999 << ',' << r.maxUs << ',' << r.hopsMean << ',' << r.hopsP99 << ','
+                << r.hopsMax << ',' << r.bytesPerNode << ',' << r.falsePositiveRate << ',' << r.filterBytesPerKey << ','
+                << r.loadMaxOverMean << ',' << r.entryMaxShare << ',' << r.coalesceRate << ',' << r.routingEntries << ','
+                << r.entriesChanged << ',' << r.gossipRounds << ',' << r.gossipMessages << ',' << r.gossipMaxPerNode << '\n';
+        }
+    }
+
+    void writeJson(const string &path, const BenchOptions &opts, const vector<OpResult> &results,
+                   const VerifySchedule &verifier)
+    {
+        ofstream out(path);
+        if (!out)
+        {
+            cerr << "无法写入 " << path << endl;
+            return;
+        }
+        out << "{\n  \"config\": {\"m\": " << m << ", \"keys\": " << opts.keys << ", \"lookups\": " << opts.lookups
+            << ", \"churn\": " << opts.churn << ", \"max_churn_nodes\": " << opts.maxChurnNodes
+            << ", \"zipf_theta\": " << opts.zipfTheta << ", \"seed\": " << opts.seed
+            << ", \"verify_every\": " << opts.verifyEvery << ", \"net\": \"" << opts.net << "\", \"net_jitter_ms\": " << opts.netJitterMs
+            << ", \"net_loss\": " << opts.netLoss << ", \"pns\": " << opts.pns << ", \"filter_cache\": " << opts.filterCache
+            << ", \"ttl_keys\": " << opts.ttlKeys << ", \"entry\": \"" << opts.entry << "\", \"clients\": " << opts.clients << ", \"coalesce\": " << opts.coalesce << ", \"geometry\": \"" << opts.geometry << "\", \"bucket\": " << opts.bucket << ", \"links\": " << opts.links << ", \"max_onehop_nodes\": " << opts.maxOneHopNodes << ", \"gossip\": " << opts.gossip << "},\n  \"verify\": {\"runs\": " << verifier.runs
+            << ", \"failures\": " << verifier.failures << "},\n  \"results\": [";
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const OpResult &r = results[i];
+            out << (i ? ",\n" : "\n") << "    {\"nodes\": " << r.nodes << ", \"dist\": \"" << r.dist << "\", \"op\": \""
+                << r.op << "\", \"count\": " << r.count << ", \"succeeded\": " << r.succeeded
+                << ", \"seconds\": " << r.seconds << ", \"ops_per_sec\": " << (r.seconds > 0 ? r.count / r.seconds : 0)
+                << ", \"p50_us\": " << r.p50 << ", \"p90_us\": " << r.p90 << ", \"p99_us\": " << r.p99
+                << ", \"p999_us\": " << r.p999 << ", \"max_us\": " << r.maxUs << ", \"hops_mean\": " << r.hopsMean
+                << ", \"hops_p99\": " << r.hopsP99 << ", \"hops_max\": " << r.hopsMax
+                << ", \"bytes_per_node\": " << r.bytesPerNode << ", \"false_positive_rate\": " << r.falsePositiveRate
+                << ", \"filter_bytes_per_key\": " << r.filterBytesPerKey << ", \"load_max_over_mean\": " << r.loadMaxOverMean
+                << ", \"entry_max_share\": " << r.entryMaxShare << ", \"coalesce_rate\": " << r.coalesceRate
+                << ", \"routing_entries\": " << r.routingEntries << ", \"entries_changed\": " << r.entriesChanged
+                << ", \"gossip_rounds\": " << r.gossipRounds << ", \"gossip_messages\": " << r.gossipMessages
+                << ", \"gossip_max_per_node\": " << r.gossipMaxPerNode << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    BenchOptions opts;
+    if (!parseArgs(argc, argv, opts))
+    {
+        printUsage();
+        return 1;
+    }
+
+    EntryOptions entryOptions;
+    entryOptions.seed = opts.seed;
+    if (!parseEntryPolicy(opts.entry, entryOptions.policy))
+    {
+        cerr << "未知入口策略：" << opts.entry << endl;
+        return 1;
+    }
+
+    GeometryOptions geometryOptions;
+    geometryOptions.bucketSize = opts.bucket;
+    geometryOptions.links = opts.links;
+    geometryOptions.seed = opts.seed;
+    if (!parseGeometry(opts.geometry, geometryOptions.kind))
+    {
+        cerr << "未知路由几何：" << opts.geometry << endl;
+        return 1;
+    }
+
+    cout << "m = " << m << "，标识符空间 " << ID_SPACE << "，路由几何 " << opts.geometry << endl;
+    mt19937_64 rng(opts.seed);
+    vector<OpResult> results;
+    VerifySchedule verifier;
+    verifier.every = opts.verifyEvery;
+
+    for (size_t n : opts.nodeCounts)
+    {
+        if (n == 0)
+            continue;
+        if (n > ID_SPACE / 4)
+        {
+            cerr << "跳过 " << n << " 个节点：标识符空间太小（m = " << m << "），请用 -DCHORD_M=31 编译" << endl;
+            continue;
+        }
+        if (geometryOptions.kind == GeometryKind::ONE_HOP && n > opts.maxOneHopNodes)
+        {
+            cerr << "跳过 " << n << " 个节点：单跳模式的全成员表过大（--max-onehop-nodes " << opts.maxOneHopNodes << "）" << endl;
+            continue;
+        }
+        cout << "== " << n << " 个节点 ==" << endl;
+
+        vector<string> ips;
+        ips.reserve(n + n / 64 + 16);
+        for (size_t i = 0; ips.size() < n + n / 64 + 16; i++)
+            ips.push_back(nodeIp(i));
+
+        // build：由成员列表直接构建环，ID 冲突被跳过，多生成的 IP 用于补足 n 个节点
+        ChordRingManager manager;
+        if (opts.net != "off")
+        {
+            NetworkOptions netOptions;
+            netOptions.seed = opts.seed;
+            netOptions.jitterMs = opts.netJitterMs;
+            netOptions.lossRate = opts.netLoss;
+            if (opts.net.compare(0, 7, "matrix:") == 0)
+            {
+                netOptions.model = LatencyModelType::MATRIX;
+                netOptions.matrixPath = opts.net.substr(7);
+            }
+            else if (opts.net != "coords")
+            {
+                cerr << "未知网络模型：" << opts.net << endl;
+                return 1;
+            }
+            if (!manager.enableNetwork(netOptions))
+            {
+                cerr << "网络模拟开启失败：" << opts.net << endl;
+                return 1;
+            }
+        }
+        manager.setFilterCache(opts.filterCache);
+        manager.setEntryOptions(entryOptions);
+        manager.setGeometry(geometryOptions);
+        GossipOptions gossipOptions;
+        gossipOptions.enabled = opts.gossip;
+        gossipOptions.seed = opts.seed;
+        manager.setGossipOptions(gossipOptions);
+        TtlOptions ttlOptions;
+        ttlOptions.clock = []
+        { return benchClockMs; };
+        manager.setTtlOptions(ttlOptions);
+        if (opts.pns > 0)
+        {
+            ProximityOptions proximity;
+            proximity.enabled = true;
+            proximity.candidates = opts.pns;
+            manager.setProximity(proximity);
+        }
+        size_t rssBefore = residentBytes();
+        OpTimer build;
+        build.start();
+        vector<string> chosen;
+        {
+            map<uint32_t, string> byId;
+            for (const auto &ip : ips)
+            {
+                if (byId.size() >= n)
+                    break;
+                byId.emplace(Node(ip).id, ip);
+            }
+            for (auto &p : byId)
+                chosen.push_back(p.second);
+        }
+        size_t built = manager.bulkLoad(chosen);
+        build.stop(built == n);
+        size_t rssAfter = residentBytes();
+        OpResult br = build.finish(built, "-", "build");
+        br.count = built;
+        br.succeeded = built;
+        br.bytesPerNode = built && rssAfter > rssBefore ? static_cast<double>(rssAfter - rssBefore) / built : 0;
+        br.routingEntries = manager.getRoutingStateStats().meanEntries();
+        results.push_back(br);
+        cout << "  构建 " << built << " 个节点耗时 " << br.seconds * 1000 << " ms，每节点约 " << br.bytesPerNode
+             << " 字节，路由表项 " << br.routingEntries << endl;
+        verifier.check(manager);
+
+        for (const auto &dist : opts.distributions)
+        {
+            size_t first = results.size();
+            runRound(manager, built, dist, opts, rng, results, verifier);
+            for (size_t i = first; i < results.size(); i++)
+            {
+                const OpResult &r = results[i];
+                printf("  %-7s %-6s %8zu ops %12.0f ops/s  p50 %9.2f us  p99 %9.2f us", r.dist.c_str(), r.op.c_str(),
+                       r.count, r.seconds > 0 ? r.count / r.seconds : 0.0, r.p50, r.p99);
+                if (r.op == "lookup" || r.op == "lookup_client")
+                    printf("  hops %.2f (p99 %.0f)", r.hopsMean, r.hopsP99);
+                if (r.op == "lookup")
+                    printf("  路由负载 max/mean %.1f，最忙入口占 %.1f%%", r.loadMaxOverMean, r.entryMaxShare * 100);
+                if (r.op == "lookup_net" || r.op == "lookup_client_net" || r.op == "lookup_async_net" || r.op == "join_net")
+                    printf("  （模拟）");
+                if (r.op == "lookup_async")
+                    printf("  合并率 %.1f%%", r.coalesceRate * 100);
+                if (r.op == "lookup_miss")
+                    printf("  误判率 %.4f，过滤器 %.1f 字节/资源", r.falsePositiveRate, r.filterBytesPerKey);
+                if (r.op == "join" || r.op == "leave")
+                    printf("  每个节点改动路由表项 %.1f", r.entriesChanged);
+                if ((r.op == "join" || r.op == "leave") && opts.gossip)
+                    printf("  gossip %.2f 轮，%.0f 条消息，单节点每轮最多 %.0f 条", r.gossipRounds, r.gossipMessages,
+                           r.gossipMaxPerNode);
+                if (r.op == "expire")
+                    printf("  回收 %zu，每资源 %.1f ns", r.succeeded, r.count ? r.seconds * 1e9 / r.count : 0.0);
+                printf("\n");
+            }
+        }
+
+        // 批量成员变化：每 10 个节点删除 1 个再全部加回，各计一次（路由表一次重算）
+        vector<string> batch;
+        for (size_t i = 0; i < chosen.size(); i += 10)
+            batch.push_back(chosen[i]);
+        OpTimer removeMany, joinMany;
+        RoutingTables full = routingTables(manager);
+        removeMany.start();
+        size_t removedBatch = manager.removeMany(batch);
+        removeMany.stop(removedBatch == batch.size());
+        verifier.check(manager);
+        RoutingTables shrunk = routingTables(manager);
+        joinMany.start();
+        size_t joinedBatch = manager.joinMany(batch);
+        joinMany.stop(joinedBatch == batch.size());
+        verifier.check(manager);
+        size_t changed[2] = {changedEntries(full, shrunk), changedEntries(shrunk, routingTables(manager))};
+        for (auto *t : {&removeMany, &joinMany})
+        {
+            OpResult r = t->finish(built, "-", t == &removeMany ? "remove_many" : "join_many");
+            r.count = batch.size();
+            r.succeeded = t == &removeMany ? removedBatch : joinedBatch;
+            r.entriesChanged = batch.empty() ? 0 : static_cast<double>(changed[t == &removeMany ? 0 : 1]) / batch.size();
+            results.push_back(r);
+            cout << "  " << r.op << " " << r.count << " 个节点耗时 " << r.seconds * 1000 << " ms，每个节点改动路由表项 "
+                 << r.entriesChanged << endl;
+        }
+
+        // teardown：整环拆除，节点内存随内存池整块释放
+        OpTimer teardown;
+        teardown.start();
+        size_t removed = manager.clear();
+        teardown.stop(removed == built);
+        OpResult tr = teardown.finish(built, "-", "teardown");
+        tr.count = removed;
+        tr.succeeded = removed;
+        results.push_back(tr);
+        cout << "  拆除 " << removed << " 个节点耗时 " << tr.seconds * 1000 << " ms" << endl;
+    }
+
+    writeJson(opts.jsonPath, opts, results, verifier);
+    writeCsv(opts.csvPath, results);
+    cout << "环校验 " << verifier.runs << " 次，失败 " << verifier.failures << endl;
+    cout << "结果已写入 " << opts.jsonPath << " 与 " << opts.csvPath << endl;
+    return verifier.failures == 0 ? 0 : 2;
+}
@@ -1,13 +1,16 @@
 #include "chord_cli.h"
 #include "chord.h" // 确保 Chord 类型可见
+#include "ring_image.h"
 #include <iostream>
 #include <sstream>
 #include <algorithm>
 #include <cctype>
 #include <limits>
 #include <cstdlib>
+#include <cstdio>
 #include <unordered_set>
 #include <unordered_map>
+#include <chrono>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -31,7 +34,23 @@ const std::unordered_map<std::string, CommandType> commandMap = {
     {"frs", CommandType::FIND_RESOURCES},
     {"ln", CommandType::LIST_NODES},
     {"rs", CommandType::RING_STATUS},
-    {"ns", CommandType::NODE_STATUS}};
+    {"ns", CommandType::NODE_STATUS},
+    {"ss", CommandType::STORAGE_STATUS},
+    {"si", CommandType::SAVE_IMAGE},
+    {"li", CommandType::LOAD_IMAGE},
+    {"pm", CommandType::PLACEMENT_MODE},
+    {"sc", CommandType::SCAN},
+    {"sp", CommandType::SCAN_PREFIX},
+    {"vr", CommandType::VERIFY_RING},
+    {"net", CommandType::NETWORK},
+    {"pns", CommandType::PROXIMITY},
+    {"bf", CommandType::FILTER},
+    {"at", CommandType::ADD_RESOURCE_TTL},
+    {"ex", CommandType::EXPIRE},
+    {"fd", CommandType::FIND_DIRECT},
+    {"ep", CommandType::ENTRY_POLICY},
+    {"geo", CommandType::GEOMETRY},
+    {"gs", CommandType::GOSSIP}};
 
 // ---------------------- 工具函数 ----------------------
 
@@ -65,7 +84,7 @@ vector<string> ChordCLI::split(const string &s, char delimiter)
 {
     vector<string> tokens;
     string token;
-    istringstream tokenStream();
+    istringstream tokenStream(s);
     while (getline(tokenStream, token, delimiter))
     {
         string trimmed = trim(token);
@@ -210,8 +229,9 @@ void ChordCLI::execute_command(const CommandResult &cmd)
     case CommandType::ADD_NODE:
     {
         const string &ip = cmd.args[0];
+        double start = network_now();
         if (ringManager.join(ip))
-            print_success("节点 " + ip + " 添加成功");
+            print_success("节点 " + ip + " 添加成功" + network_cost(start));
         else
             print_error("节点 " + ip + " 添加失败（可能已存在或内部错误）");
         break;
@@ -220,12 +240,18 @@ void ChordCLI::execute_command(const CommandResult &cmd)
     case CommandType::ADD_NODES:
     {
         vector<string> success, fail;
+        // 批量加入：一次重算路由表，资源至多迁移一次
+        ringManager.joinMany(cmd.args, &fail);
+        unordered_map<string, size_t> failed;
+        for (const string &ip : fail)
+            failed[ip]++;
         for (const string &ip : cmd.args)
         {
-            if (ringManager.join(ip))
-                success.push_back(ip);
+            auto it = failed.find(ip);
+            if (it != failed.end() && it->second > 0)
+                it->second--;
             else
-                fail.push_back(ip);
+                success.push_back(ip);
         }
         stringstream ss;
         if (!success.empty())
@@ -302,12 +328,27 @@ void ChordCLI::execute_command(const CommandResult &cmd)
         }
 
         vector<string> success, fail;
-        for (const string &ip : cmd.args)
+        if (isRemoveAll && !allIps.empty())
         {
-            if (ringManager.removeNodeByIP(ip))
-                success.push_back(ip);
-            else
-                fail.push_back(ip);
+            // 删除全部节点时不逐个离开，直接整环拆除
+            ringManager.clear();
+            success = allIps;
+        }
+        else
+        {
+            // 批量删除：资源直接迁移到最终负责节点，一次重算路由表
+            ringManager.removeMany(cmd.args, &fail);
+            unordered_map<string, size_t> failed;
+            for (const string &ip : fail)
+                failed[ip]++;
+            for (const string &ip : cmd.args)
+            {
+                auto it = failed.find(ip);
+                if (it != failed.end() && it->second > 0)
+                    it->second--;
+                else
+                    success.push_back(ip);
+            }
         }
         stringstream ss;
         if (!success.empty())
@@ -338,6 +379,19 @@ void ChordCLI::execute_command(const CommandResult &cmd)
         break;
     }
 
+    case CommandType::ADD_RESOURCE_TTL:
+    {
+        const string &name = cmd.args[0];
+        uint64_t ttlMs = strtoull(cmd.args[1].c_str(), nullptr, 10);
+        if (ttlMs == 0)
+            print_error("TTL 须为正整数（毫秒），永不过期的资源请用 ar");
+        else if (ringManager.addResource(name, ttlMs))
+            print_success("资源 '" + name + "' 添加成功，" + cmd.args[1] + " ms 后过期");
+        else
+            print_error("资源 '" + name + "' 添加失败（可能环为空或资源已存在？）");
+        break;
+    }
+
     case CommandType::ADD_RESOURCES:
     {
         vector<string> success, fail;
@@ -446,11 +500,34 @@ void ChordCLI::execute_command(const CommandResult &cmd)
             print_error("环为空，无法查找资源");
             break;
         }
+        double start = network_now();
         Node n = ringManager.lookupResource(name);
         if (n.isEmpty())
-            print_error("资源 '" + name + "' 不存在");
+            print_error("资源 '" + name + "' 不存在" + network_cost(start));
+        else
+            print_success("资源 '" + name + "' 由节点 " + n.toString() + " 负责" + network_cost(start));
+        break;
+    }
+
+    case CommandType::FIND_DIRECT:
+    {
+        const string &name = cmd.args[0];
+        if (ringManager.getTotalNodes() == 0)
+        {
+            print_error("环为空，无法查找资源");
+            break;
+        }
+        double start = network_now();
+        if (!client)
+            client.reset(new ChordClient(ringManager));
+        Node n = client->lookup(name);
+        const ClientStats &stats = client->stats();
+        string info = "（快照 epoch " + to_string(client->getEpoch()) + "，" + to_string(client->getSnapshot().ids.size()) +
+                      " 个节点 " + to_string(stats.snapshotBytes) + " 字节，已刷新 " + to_string(stats.refreshes) + " 次）";
+        if (n.isEmpty())
+            print_error("资源 '" + name + "' 不存在" + info + network_cost(start));
         else
-            print_success("资源 '" + name + "' 由节点 " + n.toString() + " 负责");
+            print_success("资源 '" + name + "' 由节点 " + n.toString() + " 负责" + info + network_cost(start));
         break;
     }
 
@@ -519,11 +596,365 @@ void ChordCLI::execute_command(const CommandResult &cmd)
         break;
     }
 
+    case CommandType::STORAGE_STATUS:
+        ringManager.showStorageStats();
+        break;
+
+    case CommandType::SAVE_IMAGE:
+    {
+        const string &path = cmd.args[0];
+        if (ringManager.saveRingImage(path))
+            print_success("环镜像已写入 " + path);
+        else
+            print_error("环镜像写入失败：" + path);
+        break;
+    }
+
+    case CommandType::LOAD_IMAGE:
+    {
+        const string &path = cmd.args[0];
+        if (ringManager.getTotalNodes() != 0)
+        {
+            print_error("当前环非空，请先执行 rns * 再加载镜像");
+            break;
+        }
+        auto start = chrono::steady_clock::now();
+        RingImage image;
+        if (!image.open(path) || !ringManager.loadRingImage(image))
+        {
+            print_error("环镜像加载失败：" + path);
+            break;
+        }
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        print_success("已从镜像恢复 " + to_string(image.nodeCount()) + " 个节点、" + to_string(image.keyCount()) +
+                      " 个资源，耗时 " + to_string(ms) + " ms");
+        break;
+    }
+
+    case CommandType::PLACEMENT_MODE:
+    {
+        PlacementOptions options;
+        if (cmd.args[0] == "order")
+        {
+            options.mode = PlacementMode::ORDER_PRESERVING;
+            if (cmd.args.size() >= 3)
+            {
+                options.lowKey = cmd.args[1];
+                options.highKey = cmd.args[2];
+            }
+        }
+        else if (cmd.args[0] != "hash")
+        {
+            print_error("未知放置方式：" + cmd.args[0] + "（可选 hash / order）");
+            break;
+        }
+        if (ringManager.setPlacement(options))
+            print_success("放置方式已切换为 " + cmd.args[0]);
+        else
+            print_error("环中已有资源，无法切换放置方式");
+        break;
+    }
+
+    case CommandType::SCAN:
+    case CommandType::SCAN_PREFIX:
+    {
+        if (ringManager.getPlacement().mode != PlacementMode::ORDER_PRESERVING)
+        {
+            print_error("范围查询需要保序放置模式，请先执行 pm order");
+            break;
+        }
+        ScanCallback printBatch = [](const vector<string> &batch)
+        {
+            for (const auto &name : batch)
+                cout << "  " << name << endl;
+            return true;
+        };
+        size_t count;
+        if (cmd.type == CommandType::SCAN)
+            count = ringManager.scan(cmd.args[0], cmd.args[1] == "*" ? string() : cmd.args[1], 0, printBatch);
+        else
+            count = ringManager.scanPrefix(cmd.args[0], 0, printBatch);
+        print_success("共 " + to_string(count) + " 个资源");
+        break;
+    }
+
+    case CommandType::VERIFY_RING:
+    {
+        VerifyReport report = ringManager.verify();
+        string summary = "节点 " + to_string(report.nodesChecked) + "，finger " + to_string(report.fingersChecked) +
+                         (report.linksChecked ? "，链接 " + to_string(report.linksChecked) : "") + "，资源 " +
+                         to_string(report.keysChecked);
+        if (report.ok())
+        {
+            print_success("环校验通过（" + summary + "）");
+            break;
+        }
+        for (const auto &problem : report.problems)
+            print_error(problem);
+        print_error("环校验失败（" + summary + "）：后继 " + to_string(report.successorErrors) + "，前驱 " +
+                    to_string(report.predecessorErrors) + "，finger " + to_string(report.fingerErrors) + "，链接 " +
+                    to_string(report.linkErrors) + "，资源 " +
+                    to_string(report.keyErrors));
+        break;
+    }
+
+    case CommandType::NETWORK:
+    {
+        const string &mode = cmd.args[0];
+        if (mode == "off")
+        {
+            ringManager.disableNetwork();
+            print_success("网络模拟已关闭");
+            break;
+        }
+        if (mode == "stat")
+        {
+            NetworkEmulator *network = ringManager.getNetwork();
+            if (!network)
+            {
+                print_error("网络模拟未开启，使用 net coords 或 net matrix <file> 开启");
+                break;
+            }
+            const NetworkStats &stats = network->getStats();
+            print_success("虚拟时钟 " + to_string(stats.simulatedMs) + " ms，消息 " + to_string(stats.messages) + "，字节 " +
+                          to_string(stats.bytes) + "，重传 " + to_string(stats.retransmits));
+            break;
+        }
+        NetworkOptions options;
+        if (mode == "coords")
+        {
+            if (cmd.args.size() >= 2)
+                options.seed = strtoull(cmd.args[1].c_str(), nullptr, 10);
+        }
+        else if (mode == "matrix" && cmd.args.size() >= 2)
+        {
+            options.model = LatencyModelType::MATRIX;
+            options.matrixPath = cmd.args[1];
+        }
+        else
+        {
+            print_error("用法：" + command_syntax.at("net").second);
+            break;
+        }
+        if (ringManager.enableNetwork(options))
+            print_success("网络模拟已开启（" + mode + "）");
+        else
+            print_error("网络模拟开启失败：无法加载 " + options.matrixPath);
+        break;
+    }
+
+    case CommandType::PROXIMITY:
+    {
+        ProximityOptions options;
+        options.candidates = strtoull(cmd.args[0].c_str(), nullptr, 10);
+        options.enabled = options.candidates > 0;
+        if (options.enabled && !ringManager.getNetwork())
+        {
+            print_error("邻近节点选择需要 RTT，请先执行 net coords 或 net matrix <file>");
+            break;
+        }
+        ringManager.setProximity(options);
+        if (options.enabled)
+            print_success("邻近节点选择已开启，每个 finger 比较 " + cmd.args[0] + " 个候选");
+        else
+            print_success("邻近节点选择已关闭，finger 恢复为区间起点的后继");
+        break;
+    }
+
+    case CommandType::FILTER:
+    {
+        if (cmd.args[0] == "stat")
+        {
+            FilterStats stats = ringManager.getFilterStats();
+            char buf[256];
+            snprintf(buf, sizeof(buf),
+                     "查询 %llu，缓存拒绝 %llu，节点拒绝 %llu，误判 %llu（误判率 %.4f），取过滤器 %llu 次；"
+                     "资源 %zu，节点过滤器 %zu 字节，缓存 %zu 字节",
+                     static_cast<unsigned long long>(stats.lookups), static_cast<unsigned long long>(stats.cacheRejects),
+                     static_cast<unsigned long long>(stats.nodeRejects),
+                     static_cast<unsigned long long>(stats.falsePositives), stats.falsePositiveRate(),
+                     static_cast<unsigned long long>(stats.cacheFetches), stats.keys, stats.nodeFilterBytes,
+                     stats.cacheBytes);
+            print_success(string(buf) + (ringManager.isFilterCacheEnabled() ? "（缓存已开启）" : "（缓存未开启）"));
+        }
+        else if (cmd.args[0] == "cache" && cmd.args.size() >= 2 && (cmd.args[1] == "on" || cmd.args[1] == "off"))
+        {
+            ringManager.setFilterCache(cmd.args[1] == "on");
+            print_success(string("过滤器缓存已") + (cmd.args[1] == "on" ? "开启" : "关闭"));
+        }
+        else
+            print_error("用法：" + command_syntax.at("bf").second);
+        break;
+    }
+
+    case CommandType::ENTRY_POLICY:
+    {
+        static const unordered_map<string, EntryPolicy> policies = {{"first", EntryPolicy::FIRST},
+                                                                    {"random", EntryPolicy::RANDOM},
+                                                                    {"round-robin", EntryPolicy::ROUND_ROBIN},
+                                                                    {"nearest", EntryPolicy::NEAREST},
+                                                                    {"client-hash", EntryPolicy::CLIENT_HASH}};
+        if (cmd.args.empty())
+        {
+            print_error("用法：" + command_syntax.at("ep").second);
+            break;
+        }
+        if (cmd.args[0] == "stat")
+        {
+            RoutingLoadStats stats = ringManager.getRoutingLoadStats();
+            char buf[256];
+            snprintf(buf, sizeof(buf),
+                     "节点 %zu，入口请求 %llu（单节点最多 %llu），路由步数 %llu，平均 %.2f，标准差 %.2f，最多 %llu（max/mean %.2f）",
+                     stats.nodes, static_cast<unsigned long long>(stats.entries),
+                     static_cast<unsigned long long>(stats.maxEntries), static_cast<unsigned long long>(stats.totalWork),
+                     stats.meanWork, stats.stddevWork, static_cast<unsigned long long>(stats.maxWork), stats.maxOverMean());
+            string busiest;
+            if (stats.maxWork > 0)
+            {
+                Chord *chord = ringManager.findChordNode(stats.busiestNode);
+                busiest = chord ? "，最忙节点 " + chord->getSelf().toString() : "";
+            }
+            print_success(string(buf) + busiest);
+            break;
+        }
+        if (cmd.args[0] == "reset")
+        {
+            ringManager.resetRoutingLoad();
+            print_success("路由负载计数已清零");
+            break;
+        }
+        auto it = policies.find(cmd.args[0]);
+        if (it == policies.end())
+        {
+            print_error("用法：" + command_syntax.at("ep").second);
+            break;
+        }
+        EntryOptions options = ringManager.getEntryOptions();
+        options.policy = it->second;
+        ringManager.setEntryOptions(options);
+        if (cmd.args.size() >= 2)
+            ringManager.setCaller(Node(cmd.args[1]));
+        print_success("入口策略: " + cmd.args[0] + (cmd.args.size() >= 2 ? "，调用方 " + cmd.args[1] : ""));
+        break;
+    }
+
+    case CommandType::GEOMETRY:
+    {
+        if (cmd.args.empty())
+        {
+            print_error("用法：" + command_syntax.at("geo").second);
+            break;
+        }
+        if (cmd.args[0] == "stat")
+        {
+            RoutingStateStats stats = ringManager.getRoutingStateStats();
+            char buf[256];
+            snprintf(buf, sizeof(buf), "几何 %s，节点 %zu，路由表项平均 %.2f（最少 %zu，最多 %zu）",
+                     geometryName(ringManager.getGeometryOptions().kind), stats.nodes, stats.meanEntries(), stats.minEntries,
+                     stats.maxEntries);
+            print_success(buf);
+            break;
+        }
+        GeometryOptions options = ringManager.getGeometryOptions();
+        if (!parseGeometry(cmd.args[0], options.kind))
+        {
+            print_error("用法：" + command_syntax.at("geo").second);
+            break;
+        }
+        if (cmd.args.size() >= 2)
+        {
+            size_t k = static_cast<size_t>(strtoull(cmd.args[1].c_str(), nullptr, 10));
+            if (k == 0)
+            {
+                print_error("桶大小 / 链接数必须为正整数");
+                break;
+            }
+            if (options.kind == GeometryKind::SYMPHONY)
+                options.links = k;
+            else
+                options.bucketSize = k;
+        }
+        ringManager.setGeometry(options);
+        RoutingStateStats stats = ringManager.getRoutingStateStats();
+        char buf[128];
+        snprintf(buf, sizeof(buf), "路由几何: %s，路由表项平均 %.2f", cmd.args[0].c_str(), stats.meanEntries());
+        print_success(buf);
+        break;
+    }
+
+    case CommandType::GOSSIP:
+    {
+        GossipOptions options = ringManager.getGossipOptions();
+        if (!cmd.args.empty() && cmd.args[0] == "stat")
+        {
+            const GossipStats &stats = ringManager.getGossipStats();
+            char buf[384];
+            snprintf(buf, sizeof(buf),
+                     "gossip %s：成员变化 %llu（失效 %llu），平均 %.2f 轮（最多 %llu，约 %.0f ms），失效平均 %.2f 轮后被怀疑，"
+                     "每次 %.1f 条消息，捎带 %llu 条，补偿同步 %llu 次，单节点每轮最多 %llu 条，未收敛 %llu",
+                     options.enabled ? "开启" : "关闭", (unsigned long long)stats.events,
+                     (unsigned long long)stats.failures, stats.meanRounds(), (unsigned long long)stats.maxRounds,
+                     stats.meanRounds() * options.periodMs,
+                     stats.failures ? static_cast<double>(stats.detectRounds) / stats.failures : 0.0,
+                     stats.messagesPerEvent(), (unsigned long long)stats.piggybacked, (unsigned long long)stats.syncs,
+                     (unsigned long long)stats.maxPerNode, (unsigned long long)stats.unconverged);
+            print_success(buf);
+            break;
+        }
+        if (cmd.args.empty() || (cmd.args[0] != "on" && cmd.args[0] != "off"))
+        {
+            print_error("用法：" + command_syntax.at("gs").second);
+            break;
+        }
+        options.enabled = cmd.args[0] == "on";
+        if (options.enabled && cmd.args.size() >= 2)
+        {
+            size_t piggyback = static_cast<size_t>(strtoull(cmd.args[1].c_str(), nullptr, 10));
+            if (piggyback == 0)
+            {
+                print_error("捎带条数必须为正整数");
+                break;
+            }
+            options.piggyback = piggyback;
+        }
+        ringManager.setGossipOptions(options);
+        ringManager.resetGossipStats();
+        print_success(options.enabled ? "gossip 成员传播已开启，捎带 " + to_string(options.piggyback) + " 条"
+                                      : "gossip 成员传播已关闭");
+        break;
+    }
+
+    case CommandType::EXPIRE:
+    {
+        size_t reclaimed = ringManager.expireResources();
+        TtlStats stats = ringManager.getTtlStats();
+        print_success("回收到期资源 " + to_string(reclaimed) + "；累计回收 " + to_string(stats.expired) + "，读取时删除 " +
+                      to_string(stats.expiredOnRead) + "；当前带 TTL 的资源 " + to_string(stats.keysWithTtl) + "，时间轮条目 " +
+                      to_string(stats.wheelEntries) + "，占用 " + to_string(stats.wheelBytes) + " 字节");
+        break;
+    }
+
     default:
         break;
     }
 }
 
+double ChordCLI::network_now()
+{
+    NetworkEmulator *network = ringManager.getNetwork();
+    return network ? network->now() : 0;
+}
+
+string ChordCLI::network_cost(double start)
+{
+    NetworkEmulator *network = ringManager.getNetwork();
+    if (!network)
+        return "";
+    char buf[64];
+    snprintf(buf, sizeof(buf), "（模拟耗时 %.2f ms）", network->now() - start);
+    return buf;
+}
+
 void ChordCLI::run()
 {
     print_success("=== Chord CLI ===");
@@ -549,6 +980,9 @@ void ChordCLI::run()
         }
 
         execute_command(cmd_result);
+        // 每条命令返回前把组提交缓冲中的记录写盘，CLI 中看到的成功都已持久
+        if (!ringManager.getStorage().sync())
+            print_error("持久化写盘失败，最近的修改尚未落盘（详见日志）");
         cout << endl;
     }
 }
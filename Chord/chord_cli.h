@@ -4,7 +4,9 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <memory>
 #include "chord.h"
+#include "chord_client.h"
 
 // 命令类型枚举
 enum class CommandType
@@ -25,7 +27,23 @@ enum class CommandType
     FIND_RESOURCES,
     LIST_NODES,
     RING_STATUS,
-    NODE_STATUS
+    NODE_STATUS,
+    STORAGE_STATUS,
+    SAVE_IMAGE,
+    LOAD_IMAGE,
+    PLACEMENT_MODE,
+    SCAN,
+    SCAN_PREFIX,
+    VERIFY_RING,
+    NETWORK,
+    PROXIMITY,
+    FILTER,
+    ADD_RESOURCE_TTL,
+    EXPIRE,
+    FIND_DIRECT,
+    ENTRY_POLICY,
+    GEOMETRY,
+    GOSSIP
 };
 
 // 命令解析结果
@@ -42,6 +60,7 @@ class ChordCLI
 private:
     ChordRingManager &ringManager; // 关联的Chord环管理器
     bool is_running_;              // CLI运行状态
+    std::unique_ptr<ChordClient> client; // fd 使用的智能客户端，首次使用时创建
 
     // 命令语法定义：命令名 -> (参数数量, 语法说明)
     const std::unordered_map<std::string, std::pair<int, std::string>> command_syntax = {
@@ -53,14 +72,30 @@ private:
         {"rn", {1, "rn <ip> - remove_node(eg：rn 192.168.1.101)"}},
         {"rns", {-1, "rns <ip1> <ip2> ... | * - remove_nodes(eg：rns 192.168.1.101 192.168.1.102 或 rns *)"}},
         {"ar", {1, "ar <name> - add_resource(eg：ar document.pdf)"}},
+        {"at", {2, "at <name> <ttl_ms> - add_resource_ttl，到期后资源自动删除(eg：at session42 60000)"}},
+        {"ex", {0, "ex - expire，立即回收全部到期资源并显示 TTL 统计"}},
         {"ars", {-1, "ars <name1> <name2> ... - add_resources(eg：ars doc1.pdf doc2.pdf)"}},
         {"rr", {1, "rr <name> - remove_resource(eg：rr document.pdf)"}},
         {"rrs", {-1, "rrs <name1> <name2> ... | * - remove_resources(eg：rrs doc1.pdf doc2.pdf 或 rrs *)"}},
         {"fr", {1, "fr <name> - find_resource(eg：fr document.pdf)"}},
+        {"fd", {1, "fd <name> - find_direct，客户端按路由快照直连负责节点查找，成员变化后自动刷新快照(eg：fd document.pdf)"}},
         {"frs", {-1, "frs <name1> <name2> ... - find_resources(eg：frs doc1.pdf doc2.pdf)"}},
         {"ln", {0, "ln - list_node"}},
         {"rs", {0, "rs - ring_status"}},
         {"ns", {1, "ns <ip> - node_status(eg：ns 192.168.1.101)"}},
+        {"ss", {0, "ss - storage_status（持久化状态：启动耗时、写放大）"}},
+        {"si", {1, "si <file> - save_image，将整个环写成二进制镜像(eg：si ring.img)"}},
+        {"li", {1, "li <file> - load_image，从镜像恢复整个环，要求当前环为空(eg：li ring.img)"}},
+        {"pm", {-1, "pm hash | order [<low> <high>] - placement_mode，仅在环中没有资源时可切换(eg：pm order a z)"}},
+        {"sc", {2, "sc <start> <end> - scan，返回 [start, end) 内的资源，end 为 * 表示无上界(eg：sc doc1 doc5)"}},
+        {"sp", {1, "sp <prefix> - scan_prefix，返回以 prefix 开头的资源(eg：sp doc)"}},
+        {"vr", {0, "vr - verify_ring，校验所有节点的后继、前驱、finger 表与资源归属"}},
+        {"pns", {1, "pns <k> - 邻近节点选择，每个 finger 在区间内前 k 个节点中选 RTT 最小者，0 关闭；需先开启 net(eg：pns 4)"}},
+        {"net", {-1, "net coords [seed] | matrix <file> | off | stat - 网络模拟，开启后 an/fr 输出模拟耗时(eg：net coords 7)"}},
+        {"ep", {-1, "ep first | random | round-robin | nearest | client-hash [<caller_ip>] | stat | reset - 入口节点策略与各节点路由负载(eg：ep random)"}},
+        {"geo", {-1, "geo chord | kademlia [<k>] | symphony [<links>] | onehop | stat - 路由几何：Chord finger、XOR 桶（每桶 k 个）、小世界长链接或全成员单跳(eg：geo kademlia 2)"}},
+        {"gs", {-1, "gs on [<piggyback>] | off | stat - gossip 成员传播：加入与离开经 SWIM 式 gossip 扩散，不再逐个通知并刷新全部节点(eg：gs on 6)"}},
+        {"bf", {-1, "bf stat | cache on | cache off - 布隆过滤器统计；cache 开启后管理器缓存各节点的过滤器，不存在的资源无需路由(eg：bf cache on)"}},
     };
 
     // 私有方法：拆分命令行输入
@@ -72,6 +107,10 @@ private:
     // 私有方法：执行命令
     void execute_command(const CommandResult &cmd);
 
+    // 网络模拟：开启时返回 "（模拟耗时 x ms）"，start 为操作前的虚拟时钟
+    double network_now();
+    std::string network_cost(double start);
+
     // 工具函数
     static std::string trim(const std::string &s);
     static std::vector<std::string> split(const std::string &s, char delimiter);
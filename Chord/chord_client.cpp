@@ -0,0 +1,92 @@
+#include "chord_client.h"
+#include <algorithm>
+
+using namespace std;
+
+ChordClient::ChordClient(ChordRingManager &manager, const string &ip) : manager(manager), self(ip)
+{
+    refresh();
+}
+
+/**
+ * @brief 拉取路由快照：向任一节点发一次请求，回复按快照大小计入网络模拟；
+ *        拉取次数只与成员变化次数有关，与请求量无关
+ */
+void ChordClient::refresh()
+{
+    Node entry = manager.getAnyNode();
+    if (!entry.isEmpty())
+        manager.getProxy().sendMessage(self, entry);
+    snapshot = manager.getRoutingSnapshot();
+    counters.refreshes++;
+    counters.snapshotBytes = snapshot.wireBytes();
+    if (!entry.isEmpty())
+        manager.getProxy().sendMessage(entry, self, counters.snapshotBytes);
+}
+
+/**
+ * @brief 在快照的有序节点ID上二分查找 rid 的后继（超过最大ID时绕回第一个节点）
+ * @param rid 资源ID
+ * @return Node 负责节点
+ */
+Node ChordClient::locate(uint32_t rid) const
+{
+    auto it = lower_bound(snapshot.ids.begin(), snapshot.ids.end(), rid);
+    return snapshot.nodes[it == snapshot.ids.end() ? 0 : it - snapshot.ids.begin()];
+}
+
+/**
+ * @brief 按快照定位负责节点并直接发送请求，被拒绝时刷新快照后重试
+ * @param resource 资源名称
+ * @param request 节点侧处理，参数为 (节点ID, 快照 epoch)
+ * @param target 输出最后一次发送的目标节点
+ * @return DirectStatus 请求结果，重试用尽或环为空时分别为 STALE / FAILED
+ */
+template <typename Request>
+DirectStatus ChordClient::send(const string &resource, Request request, Node &target)
+{
+    counters.requests++;
+    for (int attempt = 0; attempt < MAX_ATTEMPTS; attempt++)
+    {
+        if (snapshot.ids.empty())
+        {
+            refresh(); // 快照为空时先确认环是否仍为空
+            if (snapshot.ids.empty())
+                return DirectStatus::FAILED;
+        }
+        target = locate(placeKey(resource, snapshot.placement));
+        manager.getProxy().sendMessage(self, target, resource.size());
+        DirectStatus status = request(target.id, snapshot.epoch);
+        if (status != DirectStatus::STALE)
+            return status;
+        counters.staleReplies++;
+        refresh();
+    }
+    return DirectStatus::STALE;
+}
+
+Node ChordClient::lookup(const string &resource)
+{
+    Node target;
+    DirectStatus status = send(resource, [&](uint32_t nodeId, uint64_t epoch)
+                               { return manager.lookupDirect(self, nodeId, epoch, resource); }, target);
+    return status == DirectStatus::OK ? target : Node();
+}
+
+bool ChordClient::put(const string &resource, uint64_t ttlMs)
+{
+    Node target;
+    return send(resource, [&](uint32_t nodeId, uint64_t epoch)
+                { return manager.putDirect(self, nodeId, epoch, resource, ttlMs); }, target) == DirectStatus::OK;
+}
+
+bool ChordClient::remove(const string &resource)
+{
+    Node target;
+    return send(resource, [&](uint32_t nodeId, uint64_t epoch)
+                { return manager.removeDirect(self, nodeId, epoch, resource); }, target) == DirectStatus::OK;
+}
+
+uint64_t ChordClient::getEpoch() const { return snapshot.epoch; }
+const RoutingSnapshot &ChordClient::getSnapshot() const { return snapshot; }
+const ClientStats &ChordClient::stats() const { return counters; }
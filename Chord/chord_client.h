@@ -0,0 +1,47 @@
+#ifndef CHORD_CLIENT_H
+#define CHORD_CLIENT_H
+
+#include "chord.h"
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// 客户端统计
+struct ClientStats
+{
+    uint64_t requests = 0;
+    uint64_t staleReplies = 0; // 被节点以 STALE 拒绝（或目标节点已离开）的次数
+    uint64_t refreshes = 0;    // 拉取快照的次数（含首次）
+    size_t snapshotBytes = 0;  // 当前快照的传输大小
+};
+
+// 智能客户端：持有一份路由快照，本地二分定位负责节点后直接把请求发给它，
+// 每个请求只有一跳，也不再都从同一个入口节点进入环。节点以 STALE 拒绝时刷新快照并重试。
+// 不加锁，每个线程使用自己的客户端；与管理器的同步接口一样，不能与成员变化并发调用
+class ChordClient
+{
+private:
+    static const int MAX_ATTEMPTS = 3; // 每次刷新后快照即为最新，正常情况下至多重试一次
+
+    ChordRingManager &manager;
+    Node self; // 客户端地址，网络模拟中作为请求的发送方
+    RoutingSnapshot snapshot;
+    ClientStats counters;
+
+    Node locate(uint32_t rid) const; // rid 的后继，快照非空时调用
+    template <typename Request>
+    DirectStatus send(const std::string &resource, Request request, Node &target);
+
+public:
+    explicit ChordClient(ChordRingManager &manager, const std::string &ip = "client");
+
+    void refresh(); // 向环中任一节点拉取最新快照
+    Node lookup(const std::string &resource); // 资源不存在时返回空节点
+    bool put(const std::string &resource, uint64_t ttlMs = 0);
+    bool remove(const std::string &resource);
+    uint64_t getEpoch() const;
+    const RoutingSnapshot &getSnapshot() const;
+    const ClientStats &stats() const;
+};
+
+#endif // CHORD_CLIENT_H
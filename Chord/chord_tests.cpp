@@ -0,0 +1,1407 @@
+// 单元测试：持久化恢复与崩溃、环镜像往返、保序放置与范围查询、时间轮、布隆过滤器、gossip 成员传播、客户端 epoch。
+// 用法：chord_tests [测试名 ...]，不带参数时运行全部；任一断言失败时退出码为 1。
+// 持久化相关的测试在当前目录下的 chord_tests_data/ 中建立各自的数据目录，结束时删除。
+
+#include "chord.h"
+#include "chord_client.h"
+#include "ring_image.h"
+#include "timer_wheel.h"
+#include "bloom.h"
+#include "finger_simd.h"
+#include "chord_async.h"
+#include "arena.h"
+#include "SHA_1.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <set>
+#include <map>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <future>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <io.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace
+{
+    size_t failures = 0;
+
+#define CHECK(cond)                                                                  \
+    do                                                                               \
+    {                                                                                \
+        if (!(cond))                                                                 \
+        {                                                                            \
+            failures++;                                                              \
+            cerr << "  " << __FILE__ << ":" << __LINE__ << " 断言失败：" #cond << endl; \
+        }                                                                            \
+    } while (0)
+
+    const string DATA_ROOT = "chord_tests_data";
+    const uint64_t BASE_CLOCK_MS = 1700000000000ULL; // TTL 测试的虚拟时钟起点（与系统时间同基准）
+    uint64_t testClockMs = BASE_CLOCK_MS;
+
+    // ---------------- 文件与目录 ----------------
+
+    void makeDir(const string &path)
+    {
+#ifdef _WIN32
+        _mkdir(path.c_str());
+#else
+        mkdir(path.c_str(), 0755);
+#endif
+    }
+
+    // 目录中的普通文件名（数据目录没有子目录）
+    vector<string> listFiles(const string &dir)
+    {
+        vector<string> names;
+#ifdef _WIN32
+        _finddata_t info;
+        intptr_t handle = _findfirst((dir + "/*").c_str(), &info);
+        if (handle == -1)
+            return names;
+        do
+        {
+            if (!(info.attrib & _A_SUBDIR))
+                names.push_back(info.name);
+        } while (_findnext(handle, &info) == 0);
+        _findclose(handle);
+#else
+        DIR *d = opendir(dir.c_str());
+        if (!d)
+            return names;
+        while (dirent *e = readdir(d))
+        {
+            string name = e->d_name;
+            if (name != "." && name != "..")
+                names.push_back(name);
+        }
+        closedir(d);
+#endif
+        return names;
+    }
+
+    void removeDir(const string &dir)
+    {
+        for (auto &name : listFiles(dir))
+            remove((dir + "/" + name).c_str());
+#ifdef _WIN32
+        _rmdir(dir.c_str());
+#else
+        rmdir(dir.c_str());
+#endif
+    }
+
+    string readFile(const string &path)
+    {
+        ifstream in(path, ios::binary);
+        stringstream ss;
+        ss << in.rdbuf();
+        return ss.str();
+    }
+
+    void writeFile(const string &path, const string &data)
+    {
+        ofstream out(path, ios::binary | ios::trunc);
+        out << data;
+    }
+
+    // 复制整个数据目录，用于模拟在此刻崩溃：之后的恢复只看得到已写盘的内容
+    void copyDir(const string &from, const string &to)
+    {
+        removeDir(to);
+        makeDir(to);
+        for (auto &name : listFiles(from))
+            writeFile(to + "/" + name, readFile(from + "/" + name));
+    }
+
+    // 本测试独占的空数据目录
+    string freshDir(const string &name)
+    {
+        makeDir(DATA_ROOT);
+        string dir = DATA_ROOT + "/" + name;
+        removeDir(dir);
+        return dir;
+    }
+
+    string nodeWal(const string &dir, const string &ip) { return dir + "/node_" + to_string(Node(ip).id) + ".wal"; }
+
+    // ---------------- 环 ----------------
+
+    void useTestClock(ChordRingManager &manager)
+    {
+        TtlOptions ttl;
+        ttl.clock = []
+        { return testClockMs; };
+        manager.setTtlOptions(ttl);
+    }
+
+    string nodeIp(size_t i) { return "10.0." + to_string((i >> 8) & 0xFF) + "." + to_string(i & 0xFF); }
+
+    set<string> resourceNames(const ChordRingManager &manager)
+    {
+        vector<string> names = manager.getAllResourceNames();
+        return set<string>(names.begin(), names.end());
+    }
+
+    // 资源的到期时刻：在持有它的节点上查，没有 TTL 或不存在时为 0
+    uint64_t deadlineOf(ChordRingManager &manager, const string &resource)
+    {
+        uint32_t rid = manager.resourceIdOf(resource);
+        for (auto &p : manager.getAllChordNodes())
+        {
+            if (p.second->getResourceMap().count(rid))
+                return p.second->getDeadline(rid);
+        }
+        return 0;
+    }
+
+    vector<string> scanAll(ChordRingManager &manager, const string &start, const string &end, size_t limit = 0)
+    {
+        vector<string> out;
+        manager.scan(start, end, limit, [&out](const vector<string> &batch)
+                     {
+            out.insert(out.end(), batch.begin(), batch.end());
+            return true; });
+        return out;
+    }
+
+    PlacementOptions orderedPlacement()
+    {
+        PlacementOptions placement;
+        placement.mode = PlacementMode::ORDER_PRESERVING;
+        placement.lowKey = "user";
+        placement.highKey = "userz";
+        return placement;
+    }
+
+    string userKey(size_t i)
+    {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "user%03zu", i);
+        return buf;
+    }
+
+    // 资源应在的节点：有序成员中 rid 的后继
+    uint32_t expectedOwner(const vector<uint32_t> &ids, uint32_t rid)
+    {
+        auto it = lower_bound(ids.begin(), ids.end(), rid);
+        return it == ids.end() ? ids.front() : *it;
+    }
+
+    // 每个资源的查找结果都是环上的后继
+    void checkOwners(ChordRingManager &manager, const vector<string> &keys)
+    {
+        vector<uint32_t> ids = manager.getAllSortedNodeIds();
+        for (auto &key : keys)
+            CHECK(manager.lookupResource(key).id == expectedOwner(ids, manager.resourceIdOf(key)));
+    }
+
+    // ---------------- 持久化 ----------------
+
+    // 写入、删除、成员变化后正常关闭，重启恢复出同样的资源、成员与到期时刻；小阈值时经过多次快照与 WAL 换代
+    void testStorageRecovery()
+    {
+        for (size_t threshold : {size_t(4096), size_t(8)})
+        {
+            string dir = freshDir("recovery_" + to_string(threshold));
+            StorageOptions options;
+            options.dataDir = dir;
+            options.groupCommitSize = 16;
+            options.snapshotThreshold = threshold;
+            testClockMs = BASE_CLOCK_MS;
+            set<string> expected;
+            {
+                ChordRingManager manager;
+                useTestClock(manager);
+                CHECK(manager.openStorage(options));
+                for (size_t i = 0; i < 8; i++)
+                    CHECK(manager.join(nodeIp(i)));
+                for (size_t i = 0; i < 200; i++)
+                {
+                    string key = "key" + to_string(i);
+                    CHECK(manager.addResource(key, i % 4 == 0 ? 60000 : 0));
+                    expected.insert(key);
+                }
+                for (size_t i = 0; i < 200; i += 7)
+                {
+                    CHECK(manager.removeResource("key" + to_string(i)));
+                    expected.erase("key" + to_string(i));
+                }
+                CHECK(manager.join(nodeIp(100)));
+                CHECK(manager.join(nodeIp(101)));
+                CHECK(manager.removeNodeByIP(nodeIp(3)));
+                CHECK(manager.verify().ok());
+                CHECK(manager.getStorage().healthy());
+            }
+            {
+                ChordRingManager manager;
+                useTestClock(manager);
+                CHECK(manager.openStorage(options));
+                CHECK(manager.getTotalNodes() == 9);
+                CHECK(resourceNames(manager) == expected);
+                CHECK(manager.verify().ok());
+                CHECK(deadlineOf(manager, "key4") == BASE_CLOCK_MS + 60000);
+                CHECK(deadlineOf(manager, "key5") == 0);
+                // 到期时刻随 PUT 持久化，恢复后照常过期
+                testClockMs = BASE_CLOCK_MS + 61000;
+                manager.expireResources();
+                CHECK(resourceNames(manager).count("key4") == 0);
+                CHECK(resourceNames(manager).count("key5") == 1);
+            }
+            removeDir(dir);
+        }
+    }
+
+    // 逐条提交时，任一时刻崩溃（复制当时的数据目录）恢复出的都是已确认的全部写入，包括迁移之后的状态
+    void testStorageCrash()
+    {
+        string dir = freshDir("crash");
+        string afterPuts = freshDir("crash_puts"), afterJoin = freshDir("crash_join");
+        StorageOptions options;
+        options.dataDir = dir;
+        options.groupCommitSize = 1;
+        set<string> expected;
+        {
+            ChordRingManager manager;
+            CHECK(manager.openStorage(options));
+            for (size_t i = 0; i < 6; i++)
+                CHECK(manager.join(nodeIp(i)));
+            for (size_t i = 0; i < 100; i++)
+            {
+                CHECK(manager.addResource("key" + to_string(i)));
+                expected.insert("key" + to_string(i));
+            }
+            copyDir(dir, afterPuts);
+            CHECK(manager.join(nodeIp(50))); // 新节点从后继迁入一段资源
+            copyDir(dir, afterJoin);
+        }
+        for (const string &crashed : {afterPuts, afterJoin})
+        {
+            options.dataDir = crashed;
+            ChordRingManager manager;
+            CHECK(manager.openStorage(options));
+            CHECK(resourceNames(manager) == expected);
+            CHECK(manager.verify().ok());
+            removeDir(crashed);
+        }
+        removeDir(dir);
+    }
+
+    // 迁移中途崩溃：接收方的分块与成员变化已落盘、发送方的区间删除未落盘（组提交的写盘顺序保证只会出现这种中间态），
+    // 恢复后每个资源恰好在负责节点上一份
+    void testStorageMigrationOrder()
+    {
+        string dir = freshDir("migration"), before = freshDir("migration_before");
+        StorageOptions options;
+        options.dataDir = dir;
+        options.groupCommitSize = 1000;
+        set<string> expected;
+        string joined = nodeIp(77);
+        uint32_t sender = 0;
+        {
+            ChordRingManager manager;
+            CHECK(manager.openStorage(options));
+            for (size_t i = 0; i < 6; i++)
+                CHECK(manager.join(nodeIp(i)));
+            for (size_t i = 0; i < 300; i++)
+            {
+                CHECK(manager.addResource("key" + to_string(i)));
+                expected.insert("key" + to_string(i));
+            }
+            CHECK(manager.getStorage().sync());
+            copyDir(dir, before);
+            CHECK(manager.join(joined));
+            CHECK(manager.getStorage().sync());
+            Chord *chord = manager.findChordNode(Node(joined).id);
+            CHECK(chord != nullptr);
+            if (chord)
+            {
+                sender = chord->getSuccessor().id;
+                CHECK(chord->getResourceCount() > 0);
+            }
+        }
+        // 发送方的 WAL 回到迁移之前
+        string senderWal = "/node_" + to_string(sender) + ".wal";
+        writeFile(dir + senderWal, readFile(before + senderWal));
+        {
+            ChordRingManager manager;
+            CHECK(manager.openStorage(options));
+            CHECK(manager.getTotalNodes() == 7);
+            CHECK(resourceNames(manager) == expected);
+            VerifyReport report = manager.verify();
+            CHECK(report.ok());
+            CHECK(report.keysChecked == expected.size());
+        }
+        removeDir(before);
+        removeDir(dir);
+    }
+
+    // WAL 尾部写坏（崩溃时写了一半的记录）：恢复时截掉，之前的记录保留，之后照常追加
+    void testStorageTornTail()
+    {
+        string dir = freshDir("torn");
+        StorageOptions options;
+        options.dataDir = dir;
+        options.groupCommitSize = 1;
+        string ip = nodeIp(1);
+        {
+            ChordRingManager manager;
+            CHECK(manager.openStorage(options));
+            CHECK(manager.join(ip));
+            CHECK(manager.addResource("a"));
+            CHECK(manager.addResource("b"));
+        }
+        string wal = nodeWal(dir, ip);
+        writeFile(wal, readFile(wal) + string("\x20\x00\x00\x00garbage", 11));
+        {
+            ChordRingManager manager;
+            CHECK(manager.openStorage(options));
+            CHECK(resourceNames(manager) == set<string>({"a", "b"}));
+            CHECK(manager.addResource("c"));
+        }
+        {
+            ChordRingManager manager;
+            CHECK(manager.openStorage(options));
+            CHECK(resourceNames(manager) == set<string>({"a", "b", "c"}));
+        }
+        removeDir(dir);
+    }
+
+    // 快照之后 WAL 的重建没有落盘（磁盘上仍是旧一代的 WAL）：恢复时按代号跳过，已删除的资源不会重放回来
+    void testStorageStaleWal()
+    {
+        string dir = freshDir("stale");
+        StorageOptions options;
+        options.dataDir = dir;
+        options.groupCommitSize = 1;
+        options.snapshotThreshold = 8;
+        string ip = nodeIp(1);
+        string wal = nodeWal(dir, ip), old;
+        {
+            ChordRingManager manager;
+            CHECK(manager.openStorage(options));
+            CHECK(manager.join(ip));
+            for (int i = 0; i < 5; i++)
+                CHECK(manager.addResource("k" + to_string(i)));
+            old = readFile(wal);
+            for (int i = 0; i < 3; i++)
+                CHECK(manager.removeResource("k" + to_string(i))); // 第 8 条记录时写快照
+            CHECK(manager.getStorage().getStats().snapshotsWritten > 0);
+        }
+        writeFile(wal, old);
+        {
+            ChordRingManager manager;
+            CHECK(manager.openStorage(options));
+            CHECK(resourceNames(manager) == set<string>({"k3", "k4"}));
+            CHECK(manager.getStorage().getStats().staleLogs == 1);
+            CHECK(manager.addResource("k5"));
+        }
+        {
+            ChordRingManager manager;
+            CHECK(manager.openStorage(options));
+            CHECK(resourceNames(manager) == set<string>({"k3", "k4", "k5"}));
+        }
+        removeDir(dir);
+    }
+
+    // 节点数远多于可用的文件描述符：组提交逐个打开、追加后关闭，不会因描述符耗尽丢失写入
+    void testStorageFdLimit()
+    {
+#ifdef _WIN32
+        cout << "  跳过（仅在 POSIX 上限制文件描述符）" << endl;
+#else
+        struct rlimit saved;
+        CHECK(getrlimit(RLIMIT_NOFILE, &saved) == 0);
+        struct rlimit limited = saved;
+        limited.rlim_cur = 64;
+        CHECK(setrlimit(RLIMIT_NOFILE, &limited) == 0);
+
+        string dir = freshDir("fdlimit");
+        StorageOptions options;
+        options.dataDir = dir;
+        set<string> expected;
+        {
+            ChordRingManager manager;
+            CHECK(manager.openStorage(options));
+            for (size_t i = 0; i < 300; i++)
+                CHECK(manager.join(nodeIp(i)));
+            for (size_t i = 0; i < 1000; i++)
+            {
+                CHECK(manager.addResource("key" + to_string(i)));
+                expected.insert("key" + to_string(i));
+            }
+            CHECK(manager.getStorage().sync());
+            CHECK(manager.getStorage().healthy());
+        }
+        {
+            ChordRingManager manager;
+            CHECK(manager.openStorage(options));
+            CHECK(manager.getTotalNodes() == 300);
+            CHECK(resourceNames(manager) == expected);
+        }
+        setrlimit(RLIMIT_NOFILE, &saved);
+        removeDir(dir);
+#endif
+    }
+
+    // ---------------- 环镜像 ----------------
+
+    // 保存、打开、载入后与原环一致：成员、资源、到期时刻、放置方式；映射上的查找与原环的负责节点一致；
+    // 改坏 finger 下标后完整校验拒绝打开，默认只做结构校验打开的镜像也不能载入；
+    // 改坏资源区间与内容偏移后，未做内容校验的映射查找只会查不到，不会越界
+    void testRingImage()
+    {
+        makeDir(DATA_ROOT);
+        string path = DATA_ROOT + "/ring.img";
+        testClockMs = BASE_CLOCK_MS;
+        ChordRingManager source;
+        useTestClock(source);
+        CHECK(source.setPlacement(orderedPlacement()));
+        vector<string> ips;
+        for (size_t i = 0; i < 30; i++)
+            ips.push_back(nodeIp(i));
+        CHECK(source.bulkLoad(ips) == 30);
+        for (size_t i = 0; i < 200; i++)
+            CHECK(source.addResource(userKey(i), i % 5 == 0 ? 30000 : 0));
+        CHECK(source.saveRingImage(path));
+
+        RingImage image;
+        CHECK(image.open(path));
+        CHECK(image.nodeCount() == 30);
+        CHECK(image.keyCount() == 200);
+        CHECK(image.deadlineCount() == 40);
+        for (size_t i = 0; i < 200; i++)
+        {
+            size_t index = 0;
+            string value;
+            CHECK(image.lookup(source.resourceIdOf(userKey(i)), index, &value));
+            CHECK(value == userKey(i));
+            CHECK(image.nodeId(index) == source.lookupResource(userKey(i)).id);
+        }
+
+        ChordRingManager restored;
+        useTestClock(restored);
+        CHECK(restored.loadRingImage(image));
+        CHECK(restored.getAllSortedNodeIds() == source.getAllSortedNodeIds());
+        CHECK(resourceNames(restored) == resourceNames(source));
+        CHECK(restored.getPlacement().mode == PlacementMode::ORDER_PRESERVING);
+        CHECK(restored.getPlacement().lowKey == "user" && restored.getPlacement().highKey == "userz");
+        CHECK(restored.verify().ok());
+        for (size_t i = 0; i < 200; i += 5)
+            CHECK(deadlineOf(restored, userKey(i)) == BASE_CLOCK_MS + 30000);
+        CHECK(deadlineOf(restored, userKey(1)) == 0);
+        CHECK(scanAll(restored, "user000", "user100") == scanAll(source, "user000", "user100"));
+        image.close();
+
+        // finger 下标越界
+        string bytes = readFile(path);
+        RingImageHeader header;
+        memcpy(&header, bytes.data(), sizeof(header));
+        uint32_t bad = 1000;
+        memcpy(&bytes[header.offsets[SEC_FINGERS] + 4 * 3], &bad, sizeof(bad));
+        string corrupt = DATA_ROOT + "/corrupt.img";
+        writeFile(corrupt, bytes);
+        RingImage checked, trusted;
+        CHECK(!checked.open(corrupt, true));
+        CHECK(trusted.open(corrupt));
+        CHECK(!trusted.contentsValid());
+        ChordRingManager rejected;
+        CHECK(!rejected.loadRingImage(trusted));
+        CHECK(rejected.getTotalNodes() == 0);
+        trusted.close();
+
+        // 资源区间与内容偏移越界
+        bytes = readFile(path);
+        uint64_t huge = 1ULL << 40;
+        for (size_t i = 1; i < 30; i += 2)
+            memcpy(&bytes[header.offsets[SEC_KEY_STARTS] + 8 * i], &huge, sizeof(huge));
+        for (size_t i = 1; i < 200; i += 2)
+            memcpy(&bytes[header.offsets[SEC_VALUE_OFFSETS] + 8 * i], &huge, sizeof(huge));
+        writeFile(corrupt, bytes);
+        CHECK(!checked.open(corrupt, true));
+        CHECK(trusted.open(corrupt));
+        size_t found = 0;
+        for (size_t i = 0; i < 200; i++)
+        {
+            size_t index = 0;
+            string value;
+            if (trusted.lookup(source.resourceIdOf(userKey(i)), index, &value))
+            {
+                found++;
+                CHECK(value == userKey(i));
+            }
+        }
+        CHECK(found < 200);
+        CHECK(!trusted.contentsValid());
+        trusted.close();
+
+        // 节点数大到会让段大小计算溢出
+        memcpy(&bytes[0], readFile(path).data(), sizeof(header));
+        header.nodeCount = ~0ULL / 3;
+        memcpy(&bytes[0], &header, sizeof(header));
+        writeFile(corrupt, bytes);
+        CHECK(!checked.open(corrupt, false));
+        remove(path.c_str());
+        remove(corrupt.c_str());
+    }
+
+    // ---------------- 路由几何 ----------------
+
+    // 各前驱选择内核在超过 32 个槽位的表上逐块比较，结果与标量扫描相同
+    void testFingerKernelsLong()
+    {
+        mt19937 rng(5);
+        for (int slots : {8, 16, 32, 40, 48, 64, 128, 256})
+        {
+            for (int round = 0; round < 50; round++)
+            {
+                uint32_t self = rng();
+                vector<uint32_t> table(slots);
+                for (auto &f : table)
+                    f = rng() % 4 == 0 ? self : rng();
+                vector<uint32_t> targets(64);
+                for (auto &t : targets)
+                    t = rng();
+                targets[0] = self;
+                vector<int> sse2(targets.size()), avx2(targets.size());
+                closestPrecedingBatchSse2(table.data(), slots, self, targets.data(), targets.size(), ~0u, sse2.data());
+                if (fingerKernelSupported(FingerKernel::AVX2))
+                    closestPrecedingBatchAvx2(table.data(), slots, self, targets.data(), targets.size(), ~0u, avx2.data());
+                for (size_t t = 0; t < targets.size(); t++)
+                {
+                    int expected = closestPrecedingScalar(table.data(), slots, self, targets[t], ~0u);
+                    CHECK(closestPrecedingSse2(table.data(), slots, self, targets[t], ~0u) == expected);
+                    CHECK(sse2[t] == expected);
+                    CHECK(closestPrecedingIndex(table.data(), slots, self, targets[t], ~0u) == expected);
+                    if (fingerKernelSupported(FingerKernel::AVX2))
+                    {
+                        CHECK(closestPrecedingAvx2(table.data(), slots, self, targets[t], ~0u) == expected);
+                        CHECK(avx2[t] == expected);
+                    }
+                }
+            }
+        }
+    }
+
+    // 各几何（含超过 32 条长链接的 Symphony 与大桶 Kademlia）下查找都落在后继上，加入、离开与批量变化后路由表一致
+    void testGeometryRouting()
+    {
+        vector<GeometryOptions> geometries(5);
+        geometries[1].kind = GeometryKind::KADEMLIA;
+        geometries[1].bucketSize = 8;
+        geometries[2].kind = GeometryKind::SYMPHONY;
+        geometries[2].links = 4;
+        geometries[3].kind = GeometryKind::SYMPHONY;
+        geometries[3].links = 40;
+        geometries[4].kind = GeometryKind::ONE_HOP;
+        vector<string> keys;
+        for (size_t i = 0; i < 300; i++)
+            keys.push_back("key" + to_string(i));
+        for (auto &geometry : geometries)
+        {
+            ChordRingManager manager;
+            manager.setGeometry(geometry);
+            vector<string> ips;
+            for (size_t i = 0; i < 200; i++)
+                ips.push_back(nodeIp(i));
+            CHECK(manager.bulkLoad(ips) == 200);
+            for (auto &key : keys)
+                CHECK(manager.addResource(key));
+            checkOwners(manager, keys);
+            CHECK(manager.join(nodeIp(500)));
+            CHECK(manager.removeNodeByIP(nodeIp(7)));
+            CHECK(manager.removeNodeByIP(nodeIp(8), false));
+            checkOwners(manager, keys);
+            CHECK(manager.verify().ok());
+        }
+    }
+
+    // ---------------- 保序放置与范围查询 ----------------
+
+    // 范围查询按字典序返回区间内的全部键，limit 截断，前缀查询等价于右开上界；重启后结果不变
+    void testPlacementScan()
+    {
+        string dir = freshDir("placement");
+        StorageOptions options;
+        options.dataDir = dir;
+        vector<string> expected;
+        for (size_t i = 50; i < 100; i++)
+            expected.push_back(userKey(i));
+        {
+            ChordRingManager manager;
+            CHECK(manager.openStorage(options));
+            CHECK(manager.setPlacement(orderedPlacement()));
+            for (size_t i = 0; i < 16; i++)
+                CHECK(manager.join(nodeIp(i)));
+            for (size_t i = 0; i < 200; i++)
+                CHECK(manager.addResource(userKey(i)));
+            CHECK(manager.addResource("other"));
+            CHECK(!manager.setPlacement(PlacementOptions())); // 已有资源时不能切换
+            CHECK(scanAll(manager, "user050", "user100") == expected);
+            CHECK(scanAll(manager, "user050", "user100", 10) == vector<string>(expected.begin(), expected.begin() + 10));
+            CHECK(manager.scanPrefix("user1", 0, [](const vector<string> &)
+                                     { return true; }) == 100);
+            CHECK(manager.verify().ok());
+        }
+        {
+            ChordRingManager manager;
+            CHECK(manager.openStorage(options));
+            CHECK(manager.getPlacement().mode == PlacementMode::ORDER_PRESERVING);
+            CHECK(scanAll(manager, "user050", "user100") == expected);
+            CHECK(!manager.lookupResource(userKey(7)).isEmpty());
+            CHECK(!manager.lookupResource("other").isEmpty());
+        }
+        removeDir(dir);
+    }
+
+    // ---------------- 时间轮 ----------------
+
+    // 每个条目恰好到期一次，不早于到期时刻，也不晚于到期后的第一次推进；limit 在刻度边界上截断
+    void testTimerWheel()
+    {
+        const uint32_t tick = 10;
+        uint64_t start = 1000000;
+        TimerWheel wheel(tick);
+        mt19937_64 rng(7);
+        map<uint32_t, uint64_t> deadlines;
+        uint64_t spans[] = {0, 1, 9, 10, 11, 640, 40960, 2621440, 167772160, 2000000000};
+        uint32_t key = 0;
+        for (uint64_t span : spans)
+        {
+            for (int r = 0; r < 20; r++)
+            {
+                uint64_t deadline = start + (span ? rng() % span : 0);
+                wheel.schedule(key, deadline, start);
+                deadlines[key++] = deadline;
+            }
+        }
+        CHECK(wheel.size() == deadlines.size());
+
+        map<uint32_t, int> fired;
+        uint64_t now = start, previous = start;
+        uint64_t last = start + 2000000000 + tick;
+        vector<pair<uint32_t, uint64_t>> due;
+        while (now < last)
+        {
+            // 推进步长从几毫秒到约一天，覆盖各层的级联
+            now = min(last, now + 1 + rng() % (now - start < 100000 ? 5000 : 90000000));
+            due.clear();
+            wheel.advance(now, due);
+            for (auto &d : due)
+            {
+                fired[d.first]++;
+                CHECK(d.second == deadlines[d.first]);
+                CHECK(d.second <= now);
+                CHECK(d.second + tick > previous); // 上一次推进时尚未到期（到期时刻向上取整到刻度）
+            }
+            previous = now;
+        }
+        CHECK(fired.size() == deadlines.size());
+        for (auto &f : fired)
+            CHECK(f.second == 1);
+        CHECK(wheel.size() == 0);
+
+        TimerWheel limited(tick);
+        for (uint32_t k = 0; k < 100; k++)
+            limited.schedule(k, start + tick * (k + 1), start);
+        due.clear();
+        limited.advance(start + tick * 200, due, 10);
+        CHECK(due.size() == 10);
+        limited.advance(start + tick * 200, due);
+        CHECK(due.size() == 100);
+    }
+
+    // ---------------- 布隆过滤器 ----------------
+
+    // 插入过的键总能通过；未插入的键误判率接近设计值；节点过滤器在迁移与删除后仍不漏判
+    void testBloomFilter()
+    {
+        BlockedBloomFilter filter;
+        filter.reset(5000);
+        mt19937 rng(11);
+        set<uint32_t> inserted;
+        while (inserted.size() < 5000)
+        {
+            uint32_t k = rng();
+            inserted.insert(k);
+            filter.insert(k);
+        }
+        for (uint32_t k : inserted)
+            CHECK(filter.mayContain(k));
+        size_t probes = 0, falsePositives = 0;
+        while (probes < 20000)
+        {
+            uint32_t k = rng();
+            if (inserted.count(k))
+                continue;
+            probes++;
+            falsePositives += filter.mayContain(k);
+        }
+        CHECK(falsePositives < probes * 3 / 100);
+        filter.clear();
+        CHECK(!filter.mayContain(*inserted.begin()));
+
+        for (bool cached : {false, true})
+        {
+            ChordRingManager manager;
+            manager.setFilterCache(cached);
+            for (size_t i = 0; i < 12; i++)
+                CHECK(manager.join(nodeIp(i)));
+            for (size_t i = 0; i < 500; i++)
+                CHECK(manager.addResource("key" + to_string(i)));
+            for (size_t i = 0; i < 500; i += 3)
+                CHECK(manager.removeResource("key" + to_string(i)));
+            CHECK(manager.join(nodeIp(40)));
+            CHECK(manager.removeNodeByIP(nodeIp(5)));
+            for (size_t i = 0; i < 500; i++)
+            {
+                bool present = i % 3 != 0;
+                CHECK(manager.lookupResource("key" + to_string(i)).isEmpty() != present);
+            }
+            CHECK(manager.getFilterStats().lookups == 500);
+        }
+    }
+
+    // ---------------- gossip ----------------
+
+    // 加入、离开、崩溃都经 gossip 传播，每次传播收敛且路由状态与全局成员一致
+    // 各几何（Kademlia、Symphony 链接表与 PNS finger 都在收到更新时就地修补）下同样成立，现存资源的查找都落在后继上
+    void testGossip()
+    {
+        vector<GeometryOptions> geometries(5);
+        geometries[1].kind = GeometryKind::KADEMLIA;
+        geometries[1].bucketSize = 4;
+        geometries[2].kind = GeometryKind::SYMPHONY;
+        geometries[3].kind = GeometryKind::SYMPHONY;
+        geometries[3].links = 40;
+        for (size_t g = 0; g < geometries.size(); g++)
+        {
+            ChordRingManager manager;
+            GossipOptions options;
+            options.enabled = true;
+            manager.setGossipOptions(options);
+            manager.setGeometry(geometries[g]);
+            if (g == 4)
+            {
+                // PNS：RTT 取节点ID低位之差，与环上位置无关
+                ProximityOptions proximity;
+                proximity.enabled = true;
+                proximity.rtt = [](const Node &a, const Node &b)
+                { return 1.0 + ((a.id ^ b.id) & 0xFF); };
+                manager.setProximity(proximity);
+            }
+            vector<string> ips;
+            for (size_t i = 0; i < 64; i++)
+                ips.push_back(nodeIp(i));
+            CHECK(manager.bulkLoad(ips) == 64);
+            for (size_t i = 0; i < 200; i++)
+                CHECK(manager.addResource("key" + to_string(i)));
+            manager.resetGossipStats();
+
+            auto check = [&manager]
+            {
+                CHECK(manager.getLastGossipRun().converged);
+                CHECK(manager.verify().ok());
+                checkOwners(manager, manager.getAllResourceNames());
+            };
+            for (size_t i = 0; i < 8; i++)
+            {
+                CHECK(manager.join(nodeIp(100 + i)));
+                check();
+            }
+            for (size_t i = 0; i < 4; i++)
+            {
+                CHECK(manager.removeNodeByIP(nodeIp(i)));
+                check();
+            }
+            for (size_t i = 10; i < 13; i++)
+            {
+                CHECK(manager.removeNodeByIP(nodeIp(i), false));
+                CHECK(manager.getLastGossipRun().detectRounds > 0);
+                check();
+            }
+            const GossipStats &stats = manager.getGossipStats();
+            CHECK(stats.events == 15);
+            CHECK(stats.failures == 3);
+            CHECK(stats.unconverged == 0);
+            CHECK(manager.getTotalNodes() == 64 + 8 - 4 - 3);
+        }
+
+        // 捎带条数按配置限制：失效检测同时有 SUSPECT 与 DEAD 两条更新在途，每条消息只捎带 1 条时仍收敛
+        for (size_t piggyback : {size_t(1), size_t(16)})
+        {
+            ChordRingManager manager;
+            GossipOptions options;
+            options.enabled = true;
+            options.piggyback = piggyback;
+            manager.setGossipOptions(options);
+            vector<string> ips;
+            for (size_t i = 0; i < 64; i++)
+                ips.push_back(nodeIp(i));
+            CHECK(manager.bulkLoad(ips) == 64);
+            CHECK(manager.removeNodeByIP(nodeIp(5), false));
+            const GossipRun &run = manager.getLastGossipRun();
+            CHECK(run.converged);
+            CHECK(run.piggybacked <= run.messages * piggyback);
+            CHECK(manager.verify().ok());
+        }
+    }
+
+    // ---------------- 内存池与节点注册表 ----------------
+
+    // 分配按 16 字节对齐，释放的小块按等级复用，拆除阶段不回收，超过 MAX_SMALL 的分配不计入用量；
+    // 作为容器分配器时容器清空后用量归零
+    void testArena()
+    {
+        MemoryArena arena(4096);
+        vector<void *> blocks;
+        for (size_t bytes = 1; bytes <= MemoryArena::MAX_SMALL; bytes += 37)
+        {
+            void *p = arena.allocate(bytes);
+            CHECK(reinterpret_cast<uintptr_t>(p) % MemoryArena::ALIGN == 0);
+            memset(p, 0xAB, bytes);
+            blocks.push_back(p);
+        }
+        CHECK(arena.reservedBytes() > 4096); // 超出一个大块后申请了新块
+        size_t used = arena.usedBytes();
+        CHECK(used > 0);
+
+        void *a = arena.allocate(40);
+        CHECK(arena.usedBytes() == used + 48); // 按 16 字节取整
+        arena.deallocate(a, 40);
+        CHECK(arena.usedBytes() == used);
+        CHECK(arena.allocate(33) == a); // 同一等级复用刚释放的块
+        CHECK(arena.allocate(40) != a);
+        used = arena.usedBytes();
+
+        void *big = arena.allocate(MemoryArena::MAX_SMALL + 1);
+        CHECK(arena.usedBytes() == used);
+        arena.deallocate(big, MemoryArena::MAX_SMALL + 1);
+
+        arena.setDiscarding(true);
+        void *b = arena.allocate(64);
+        arena.deallocate(b, 64);
+        arena.setDiscarding(false);
+        CHECK(arena.allocate(64) != b); // 拆除阶段释放的块不进空闲链表
+
+        arena.release();
+        CHECK(arena.usedBytes() == 0);
+        CHECK(arena.reservedBytes() == 0);
+
+        {
+            typedef ArenaAllocator<pair<const int, string>> Alloc;
+            map<int, string, less<int>, Alloc> table{less<int>(), Alloc(&arena)};
+            for (int i = 0; i < 1000; i++)
+                table[i] = to_string(i);
+            CHECK(arena.usedBytes() > 0);
+            for (int i = 0; i < 1000; i += 2)
+                table.erase(i);
+            for (int i = 0; i < 1000; i += 2)
+                table[i] = to_string(i);
+            bool intact = table.size() == 1000;
+            for (auto &p : table)
+                intact = intact && p.second == to_string(p.first);
+            CHECK(intact);
+        }
+        CHECK(arena.usedBytes() == 0);
+    }
+
+    // 同一 IP 只驻留一次：记录地址与 ID 稳定，多个线程同时驻留得到同一记录，未驻留的 IP 查不到
+    void testNodeRegistry()
+    {
+        NodeRegistry &registry = NodeRegistry::instance();
+        CHECK(registry.find("registry.test.0") == nullptr);
+        size_t before = registry.size();
+        const NodeRecord *record = registry.intern("registry.test.0");
+        CHECK(registry.size() == before + 1);
+        CHECK(registry.intern("registry.test.0") == record);
+        CHECK(registry.find("registry.test.0") == record);
+        CHECK(registry.size() == before + 1);
+        CHECK(record->ip == "registry.test.0");
+        CHECK(record->id == sha1_hash_to_uint32("registry.test.0") % ID_SPACE);
+
+        Node node("registry.test.0");
+        CHECK(node.record == record);
+        CHECK(node.id == record->id);
+        Node copy = node;
+        CHECK(&copy.ip() == &record->ip); // 复制句柄不复制 IP 字符串
+        CHECK(Node(record->id, "registry.test.0").record == record);
+        CHECK(Node().ip().empty());
+
+        const size_t threads = 4, perThread = 500;
+        vector<future<vector<const NodeRecord *>>> workers;
+        for (size_t t = 0; t < threads; t++)
+            workers.push_back(async(launch::async, [perThread]
+                                    {
+                vector<const NodeRecord *> out;
+                for (size_t i = 0; i < perThread; i++)
+                    out.push_back(NodeRegistry::instance().intern("registry.test.shared." + to_string(i)));
+                return out; }));
+        vector<vector<const NodeRecord *>> results;
+        for (auto &w : workers)
+            results.push_back(w.get());
+        CHECK(registry.size() == before + 1 + perThread);
+        bool same = true;
+        for (size_t t = 1; t < threads; t++)
+            same = same && results[t] == results[0];
+        CHECK(same);
+        for (size_t i = 0; i < perThread; i++)
+            CHECK(registry.find("registry.test.shared." + to_string(i)) == results[0][i]);
+    }
+
+    // ---------------- 批量成员变更 ----------------
+
+    // joinMany/removeMany 与逐个 join/remove 得到同样的成员与资源归属；重复、已在环中与不在环中的 IP
+    // 按输入顺序报告；删除全部节点时资源一并丢弃
+    void testJoinRemoveMany()
+    {
+        vector<string> keys;
+        for (size_t i = 0; i < 300; i++)
+            keys.push_back("key" + to_string(i));
+        ChordRingManager batch, single;
+        for (ChordRingManager *manager : {&batch, &single})
+        {
+            vector<string> ips;
+            for (size_t i = 0; i < 10; i++)
+                ips.push_back(nodeIp(i));
+            CHECK(manager->bulkLoad(ips) == 10);
+            for (auto &key : keys)
+                CHECK(manager->addResource(key));
+        }
+
+        vector<string> joining;
+        for (size_t i = 10; i < 40; i++)
+            joining.push_back(nodeIp(i));
+        joining.push_back(nodeIp(3));  // 已在环中
+        joining.push_back(nodeIp(12)); // 本批中重复
+        vector<string> rejected;
+        CHECK(batch.joinMany(joining, &rejected) == 30);
+        CHECK(rejected == vector<string>({nodeIp(3), nodeIp(12)}));
+        for (size_t i = 10; i < 40; i++)
+            CHECK(single.join(nodeIp(i)));
+        CHECK(batch.getTotalNodes() == 40);
+        CHECK(batch.getAllSortedNodeIds() == single.getAllSortedNodeIds());
+        CHECK(resourceNames(batch) == resourceNames(single));
+        checkOwners(batch, keys);
+        CHECK(batch.verify().ok());
+
+        vector<string> leaving;
+        for (size_t i = 0; i < 40; i += 3)
+            leaving.push_back(nodeIp(i));
+        leaving.push_back(nodeIp(999)); // 不在环中
+        leaving.push_back(nodeIp(0));   // 本批中重复
+        vector<string> missing;
+        CHECK(batch.removeMany(leaving, &missing) == 14);
+        CHECK(missing == vector<string>({nodeIp(999), nodeIp(0)}));
+        for (size_t i = 0; i < 40; i += 3)
+            CHECK(single.removeNodeByIP(nodeIp(i)));
+        CHECK(batch.getTotalNodes() == 26);
+        CHECK(batch.getAllSortedNodeIds() == single.getAllSortedNodeIds());
+        CHECK(resourceNames(batch) == set<string>(keys.begin(), keys.end()));
+        checkOwners(batch, keys);
+        CHECK(batch.verify().ok());
+
+        CHECK(batch.joinMany({}) == 0);
+        CHECK(batch.removeMany({nodeIp(999)}) == 0);
+        vector<string> rest;
+        for (size_t i = 0; i < 40; i++)
+            if (i % 3 != 0)
+                rest.push_back(nodeIp(i));
+        CHECK(batch.removeMany(rest) == 26);
+        CHECK(batch.getTotalNodes() == 0);
+        CHECK(batch.getAllResourceNames().empty());
+    }
+
+    // ---------------- 一致性校验 ----------------
+
+    // verify() 能发现每一类损坏：改坏 finger、后继与前驱、资源位置与链接表后对应的计数非零，改回后恢复通过
+    void testVerifyDetectsCorruption()
+    {
+        ChordRingManager manager;
+        vector<string> ips;
+        for (size_t i = 0; i < 20; i++)
+            ips.push_back(nodeIp(i));
+        CHECK(manager.bulkLoad(ips) == 20);
+        for (size_t i = 0; i < 100; i++)
+            CHECK(manager.addResource("key" + to_string(i)));
+        CHECK(manager.verify().ok());
+        vector<uint32_t> ids = manager.getAllSortedNodeIds();
+        Chord *victim = manager.findChordNode(ids[3]);
+        Chord *other = manager.findChordNode(ids[11]);
+
+        // finger：指向一个不是 start 后继的成员
+        int k = m - 1;
+        uint32_t original = victim->getFingerId(k);
+        uint32_t wrong = original == ids[3 + 1] ? ids[3 + 2] : ids[3 + 1];
+        victim->setFingerId(k, wrong);
+        VerifyReport report = manager.verify();
+        CHECK(!report.ok());
+        CHECK(report.fingerErrors == 1);
+        CHECK(report.successorErrors + report.predecessorErrors + report.keyErrors + report.linkErrors == 0);
+        CHECK(!report.problems.empty());
+        victim->setFingerId(k, original);
+        CHECK(manager.verify().ok());
+
+        // 后继与前驱：互换
+        Node pred = victim->getPredecessor(), succ = victim->getSuccessor();
+        victim->restoreRouting(succ, pred);
+        report = manager.verify();
+        CHECK(report.successorErrors == 1);
+        CHECK(report.predecessorErrors == 1);
+        CHECK(report.fingerErrors >= 1); // finger 0 随后继一起改了
+        victim->restoreRouting(pred, succ);
+        CHECK(manager.verify().ok());
+
+        // 资源位置：把 victim 负责的资源复制到另一个节点
+        auto &owned = victim->getResourceMap();
+        CHECK(!owned.empty());
+        if (!owned.empty())
+        {
+            uint32_t rid = owned.begin()->first;
+            string name = owned.begin()->second;
+            CHECK(other->addResourceDirectly(rid, name));
+            report = manager.verify();
+            CHECK(report.keyErrors == 1);
+            CHECK(report.successorErrors + report.predecessorErrors + report.fingerErrors == 0);
+            CHECK(other->removeResourceDirectly(rid));
+            CHECK(manager.verify().ok());
+        }
+
+        // 链接表：指向自身与不在环中的节点
+        GeometryOptions symphony;
+        symphony.kind = GeometryKind::SYMPHONY;
+        manager.setGeometry(symphony);
+        CHECK(manager.verify().ok());
+        vector<uint32_t> links = victim->getLinks();
+        vector<uint32_t> broken = links;
+        broken.push_back(victim->getSelf().id + 1 == ids[4] ? victim->getSelf().id + 2 : victim->getSelf().id + 1);
+        victim->setRouting(manager.getGeometry(), broken);
+        report = manager.verify();
+        CHECK(report.linkErrors == 1);
+        victim->setRouting(manager.getGeometry(), links);
+        CHECK(manager.verify().ok());
+    }
+
+    // ---------------- 客户端 epoch ----------------
+
+    // 客户端按快照直连负责节点；成员变化后旧 epoch 的请求被拒绝，客户端刷新快照后重试得到正确结果
+    void testClientEpoch()
+    {
+        ChordRingManager manager;
+        vector<string> ips;
+        for (size_t i = 0; i < 20; i++)
+            ips.push_back(nodeIp(i));
+        CHECK(manager.bulkLoad(ips) == 20);
+        for (size_t i = 0; i < 100; i++)
+            CHECK(manager.addResource("key" + to_string(i)));
+
+        ChordClient client(manager, "10.9.9.9");
+        for (size_t i = 0; i < 100; i++)
+            CHECK(client.lookup("key" + to_string(i)).id == manager.lookupResource("key" + to_string(i)).id);
+        CHECK(client.stats().refreshes == 1);
+        CHECK(client.stats().staleReplies == 0);
+        CHECK(client.getEpoch() == manager.getEpoch());
+
+        uint64_t oldEpoch = manager.getEpoch();
+        CHECK(manager.join(nodeIp(60)));
+        CHECK(manager.getEpoch() != oldEpoch);
+        uint32_t anyNode = manager.getAllSortedNodeIds().front();
+        CHECK(manager.lookupDirect(Node("10.9.9.9"), anyNode, oldEpoch, "key1") == DirectStatus::STALE);
+
+        for (size_t i = 0; i < 100; i++)
+            CHECK(client.lookup("key" + to_string(i)).id == manager.lookupResource("key" + to_string(i)).id);
+        CHECK(client.stats().staleReplies == 1);
+        CHECK(client.stats().refreshes == 2);
+        CHECK(client.getEpoch() == manager.getEpoch());
+
+        CHECK(client.put("fresh"));
+        CHECK(!manager.lookupResource("fresh").isEmpty());
+        CHECK(client.remove("fresh"));
+        CHECK(manager.lookupResource("fresh").isEmpty());
+        CHECK(client.lookup("missing").isEmpty());
+    }
+
+    // ---------------- 异步接口 ----------------
+
+    // 异步查找、写入、删除的结果与同步接口一致（请求在途期间不调用管理器，drain 之后再比对）
+    void testAsyncResults()
+    {
+        ChordRingManager manager;
+        vector<string> ips;
+        for (size_t i = 0; i < 50; i++)
+            ips.push_back(nodeIp(i));
+        CHECK(manager.bulkLoad(ips) == 50);
+        for (size_t i = 0; i < 200; i++)
+            CHECK(manager.addResource("key" + to_string(i)));
+        vector<uint32_t> ids = manager.getAllSortedNodeIds();
+        map<string, uint32_t> owners;
+        for (size_t i = 0; i < 300; i++)
+            owners["key" + to_string(i)] = expectedOwner(ids, manager.resourceIdOf("key" + to_string(i)));
+        for (size_t i = 0; i < 100; i++)
+            owners["new" + to_string(i)] = expectedOwner(ids, manager.resourceIdOf("new" + to_string(i)));
+
+        for (bool coalescing : {false, true})
+        {
+            ChordAsyncRuntime &runtime = manager.getAsyncRuntime();
+            runtime.setCoalescing(coalescing);
+            AsyncStats before = runtime.stats();
+            // 回调都在工作线程上执行，各写各的槽位；drain 返回后读取
+            vector<AsyncResult> found(300);
+            vector<char> called(300, 0);
+            for (size_t i = 0; i < 300; i++)
+            {
+                runtime.submit(AsyncOpType::LOOKUP, "key" + to_string(i), [&, i](const AsyncResult &r)
+                               {
+                    found[i] = r;
+                    called[i]++; });
+            }
+            runtime.drain();
+            for (size_t i = 0; i < 300; i++)
+            {
+                string key = "key" + to_string(i);
+                bool present = i < 200;
+                CHECK(called[i] == 1);
+                CHECK(found[i].ok == present);
+                CHECK(found[i].node.id == (present ? owners[key] : Node().id));
+                CHECK(found[i].node.id == manager.lookupResource(key).id);
+            }
+            AsyncStats after = runtime.stats();
+            CHECK(after.completed - before.completed == 300);
+            CHECK(after.lookups - before.lookups == 300);
+            CHECK(after.submitted == after.completed);
+            if (!coalescing)
+                CHECK(after.coalesced == before.coalesced && after.intervalShared == before.intervalShared);
+        }
+
+        // 写入新键与删除已有键；重复删除与删除不存在的键失败
+        vector<future<bool>> puts, removes, missing;
+        for (size_t i = 0; i < 100; i++)
+            puts.push_back(manager.putAsync("new" + to_string(i)));
+        for (size_t i = 0; i < 50; i++)
+            removes.push_back(manager.removeAsync("key" + to_string(i)));
+        manager.drainAsync();
+        for (auto &f : puts)
+            CHECK(f.get());
+        for (auto &f : removes)
+            CHECK(f.get());
+        for (size_t i = 0; i < 50; i++)
+            missing.push_back(manager.removeAsync("key" + to_string(i)));
+        missing.push_back(manager.removeAsync("never-written"));
+        manager.drainAsync();
+        for (auto &f : missing)
+            CHECK(!f.get());
+
+        vector<future<Node>> lookups;
+        for (size_t i = 0; i < 100; i++)
+            lookups.push_back(manager.lookupAsync("new" + to_string(i)));
+        for (size_t i = 0; i < 200; i++)
+            lookups.push_back(manager.lookupAsync("key" + to_string(i)));
+        manager.drainAsync();
+        for (size_t i = 0; i < 100; i++)
+            CHECK(lookups[i].get().id == owners["new" + to_string(i)]);
+        for (size_t i = 0; i < 200; i++)
+        {
+            Node node = lookups[100 + i].get();
+            CHECK(node.id == (i < 50 ? Node().id : owners["key" + to_string(i)]));
+        }
+        for (size_t i = 0; i < 100; i++)
+            CHECK(manager.lookupResource("new" + to_string(i)).id == owners["new" + to_string(i)]);
+        for (size_t i = 0; i < 50; i++)
+            CHECK(manager.lookupResource("key" + to_string(i)).isEmpty());
+        CHECK(resourceNames(manager).size() == 250);
+        CHECK(manager.verify().ok());
+    }
+
+    // 让工作线程停在一个查找的回调里：其间提交的请求在放行后同一次进入在途窗口，合并的情形因此确定
+    class WorkerGate
+    {
+    private:
+        promise<void> entered, released;
+
+    public:
+        explicit WorkerGate(ChordAsyncRuntime &runtime)
+        {
+            shared_future<void> wait = released.get_future().share();
+            runtime.submit(AsyncOpType::LOOKUP, "gate", [this, wait](const AsyncResult &)
+                           {
+                entered.set_value();
+                wait.wait(); });
+            entered.get_future().wait();
+        }
+        void open() { released.set_value(); }
+    };
+
+    // 同ID查找合并、负责区间共享，以及与合并查找交错的 PUT/REMOVE
+    void testAsyncCoalescing()
+    {
+        ChordRingManager manager;
+        vector<string> ips;
+        for (size_t i = 0; i < 64; i++)
+            ips.push_back(nodeIp(i));
+        CHECK(manager.bulkLoad(ips) == 64);
+        for (size_t i = 0; i < 100; i++)
+            CHECK(manager.addResource("key" + to_string(i)));
+        vector<uint32_t> ids = manager.getAllSortedNodeIds();
+        ChordAsyncRuntime &runtime = manager.getAsyncRuntime();
+        runtime.setCoalescing(true);
+
+        // 同ID：每个键 10 个查找，1 个路由，9 个挂在它下面，结果相同
+        {
+            AsyncStats before = runtime.stats();
+            vector<AsyncResult> found(50);
+            WorkerGate gate(runtime);
+            for (size_t i = 0; i < 50; i++)
+                runtime.submit(AsyncOpType::LOOKUP, "key" + to_string(i / 10), [&, i](const AsyncResult &r)
+                               { found[i] = r; });
+            gate.open();
+            runtime.drain();
+            AsyncStats after = runtime.stats();
+            CHECK(after.coalesced - before.coalesced == 45);
+            CHECK(after.lookups - before.lookups == 51);
+            for (size_t i = 0; i < 50; i++)
+            {
+                CHECK(found[i].ok);
+                CHECK(found[i].node.id == expectedOwner(ids, manager.resourceIdOf("key" + to_string(i / 10))));
+                if (i % 10) // 挂在领头查找下的请求得到它的结果
+                    CHECK(found[i].hops == found[i - i % 10].hops);
+            }
+        }
+
+        // 区间共享：4 个节点上 200 个不同的键同时路由，先到达负责节点的查找把同区间的其余查找直接转过去
+        {
+            ChordRingManager small;
+            CHECK(small.bulkLoad(vector<string>(ips.begin(), ips.begin() + 4)) == 4);
+            for (size_t i = 0; i < 100; i++)
+                CHECK(small.addResource("key" + to_string(i)));
+            vector<uint32_t> smallIds = small.getAllSortedNodeIds();
+            ChordAsyncRuntime &smallRuntime = small.getAsyncRuntime();
+            vector<AsyncResult> found(200);
+            WorkerGate gate(smallRuntime);
+            for (size_t i = 0; i < 200; i++)
+                smallRuntime.submit(AsyncOpType::LOOKUP, "key" + to_string(i), [&, i](const AsyncResult &r)
+                                    { found[i] = r; });
+            gate.open();
+            smallRuntime.drain();
+            AsyncStats stats = smallRuntime.stats();
+            CHECK(stats.intervalShared > 0);
+            CHECK(stats.coalesced == 0);
+            for (size_t i = 0; i < 200; i++)
+            {
+                CHECK(found[i].ok == (i < 100));
+                if (i < 100)
+                    CHECK(found[i].node.id == expectedOwner(smallIds, small.resourceIdOf("key" + to_string(i))));
+            }
+        }
+
+        // 交错：新键 fresh 的查找前后各有 3 个、中间一个 PUT；已有键 key50 的查找中间一个 REMOVE。
+        // 合并的查找与领头的查找结果相同（写入前或写入后之一），写入与删除本身不合并，都成功
+        {
+            AsyncStats before = runtime.stats();
+            vector<AsyncResult> fresh(6), removed(4);
+            bool putOk = false, removeOk = false;
+            WorkerGate gate(runtime);
+            auto lookupInto = [&](const string &key, AsyncResult &slot)
+            {
+                runtime.submit(AsyncOpType::LOOKUP, key, [&slot](const AsyncResult &r)
+                               { slot = r; });
+            };
+            for (size_t i = 0; i < 3; i++)
+                lookupInto("fresh", fresh[i]);
+            lookupInto("key50", removed[0]);
+            lookupInto("key50", removed[1]);
+            runtime.submit(AsyncOpType::PUT, "fresh", [&](const AsyncResult &r)
+                           { putOk = r.ok; });
+            runtime.submit(AsyncOpType::REMOVE, "key50", [&](const AsyncResult &r)
+                           { removeOk = r.ok; });
+            for (size_t i = 3; i < 6; i++)
+                lookupInto("fresh", fresh[i]);
+            lookupInto("key50", removed[2]);
+            lookupInto("key50", removed[3]);
+            gate.open();
+            runtime.drain();
+            AsyncStats after = runtime.stats();
+            CHECK(putOk);
+            CHECK(removeOk);
+            CHECK(after.coalesced - before.coalesced == 5 + 3);
+            for (size_t i = 1; i < 6; i++)
+                CHECK(fresh[i].ok == fresh[0].ok && fresh[i].node.id == fresh[0].node.id);
+            for (size_t i = 1; i < 4; i++)
+                CHECK(removed[i].ok == removed[0].ok && removed[i].node.id == removed[0].node.id);
+            CHECK(!manager.lookupResource("fresh").isEmpty());
+            CHECK(manager.lookupResource("key50").isEmpty());
+
+            // 写入与删除完成之后的查找看到新状态
+            future<Node> afterPut = manager.lookupAsync("fresh"), afterRemove = manager.lookupAsync("key50");
+            manager.drainAsync();
+            CHECK(afterPut.get().id == expectedOwner(ids, manager.resourceIdOf("fresh")));
+            CHECK(afterRemove.get().isEmpty());
+        }
+        CHECK(manager.verify().ok());
+    }
+
+    struct TestCase
+    {
+        const char *name;
+        void (*run)();
+    };
+
+    const TestCase TESTS[] = {
+        {"storage_recovery", testStorageRecovery},
+        {"storage_crash", testStorageCrash},
+        {"storage_migration_order", testStorageMigrationOrder},
+        {"storage_torn_tail", testStorageTornTail},
+        {"storage_stale_wal", testStorageStaleWal},
+        {"storage_fd_limit", testStorageFdLimit},
+        {"ring_image", testRingImage},
+        {"placement_scan", testPlacementScan},
+        {"finger_kernels_long", testFingerKernelsLong},
+        {"geometry_routing", testGeometryRouting},
+        {"timer_wheel", testTimerWheel},
+        {"bloom_filter", testBloomFilter},
+        {"gossip", testGossip},
+        {"arena", testArena},
+        {"node_registry", testNodeRegistry},
+        {"join_remove_many", testJoinRemoveMany},
+        {"verify_detects_corruption", testVerifyDetectsCorruption},
+        {"client_epoch", testClientEpoch},
+        {"async_results", testAsyncResults},
+        {"async_coalescing", testAsyncCoalescing},
+    };
+}
+
+int main(int argc, char *argv[])
+{
+    set<string> selected(argv + 1, argv + argc);
+    size_t run = 0;
+    for (const TestCase &test : TESTS)
+    {
+        if (!selected.empty() && !selected.count(test.name))
+            continue;
+        size_t before = failures;
+        test.run();
+        run++;
+        cout << (failures == before ? "[通过] " : "[失败] ") << test.name << endl;
+    }
+    if (run == 0)
+    {
+        cerr << "没有匹配的测试" << endl;
+        return 1;
+    }
+    removeDir(DATA_ROOT);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,143 @@
+// 流失（churn）负载工具：生成确定性轨迹、回放轨迹，报告吞吐、与参照模型比对的正确性以及每次成员变化的数据迁移量。
+// 用法：
+//   chord_workload gen <trace> [选项]     生成轨迹写入文件
+//   chord_workload replay <trace> [--verify-every N]  回放轨迹文件
+//   chord_workload run [选项]             生成后直接回放
+
+#include "chord.h"
+#include "workload.h"
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+using namespace std;
+
+namespace
+{
+    void printUsage()
+    {
+        cout << "用法: chord_workload gen <trace> [选项] | replay <trace> [--verify-every N] | run [选项]\n"
+             << "选项: --verify-every N（每 N 个操作校验一次环，0 为只在结束时校验）\n"
+             << "      --seed N --ops N --nodes N --min-nodes N --keys N --dist uniform|zipf --zipf THETA\n"
+             << "      --join W --leave W --crash W --put W --get W --remove W（各操作的相对权重）\n"
+             << "      --gossip 0|1（回放时以 gossip 传播成员变化，崩溃经失效检测得知）" << endl;
+    }
+
+    bool parseOptions(int argc, char *argv[], int first, WorkloadOptions &opts, size_t &verifyEvery, GossipOptions &gossip)
+    {
+        for (int i = first; i < argc; i++)
+        {
+            string arg = argv[i];
+            if (i + 1 >= argc)
+            {
+                cerr << "参数缺少取值：" << arg << endl;
+                return false;
+            }
+            string value = argv[++i];
+            if (arg == "--verify-every")
+                verifyEvery = strtoull(value.c_str(), nullptr, 10);
+            else if (arg == "--gossip")
+                gossip.enabled = value != "0";
+            else if (arg == "--seed")
+                opts.seed = strtoull(value.c_str(), nullptr, 10);
+            else if (arg == "--ops")
+                opts.operations = strtoull(value.c_str(), nullptr, 10);
+            else if (arg == "--nodes")
+                opts.initialNodes = strtoull(value.c_str(), nullptr, 10);
+            else if (arg == "--min-nodes")
+                opts.minNodes = strtoull(value.c_str(), nullptr, 10);
+            else if (arg == "--keys")
+                opts.keySpace = strtoull(value.c_str(), nullptr, 10);
+            else if (arg == "--dist")
+                opts.keyDistribution = value;
+            else if (arg == "--zipf")
+                opts.zipfTheta = atof(value.c_str());
+            else if (arg == "--join")
+                opts.joinRate = atof(value.c_str());
+            else if (arg == "--leave")
+                opts.leaveRate = atof(value.c_str());
+            else if (arg == "--crash")
+                opts.crashRate = atof(value.c_str());
+            else if (arg == "--put")
+                opts.putRate = atof(value.c_str());
+            else if (arg == "--get")
+                opts.getRate = atof(value.c_str());
+            else if (arg == "--remove")
+                opts.removeRate = atof(value.c_str());
+            else
+            {
+                cerr << "未知参数：" << arg << endl;
+                return false;
+            }
+        }
+        if (opts.keyDistribution != "uniform" && opts.keyDistribution != "zipf")
+        {
+            cerr << "未知键分布：" << opts.keyDistribution << endl;
+            return false;
+        }
+        return true;
+    }
+
+    int replay(const vector<TraceOp> &trace, size_t verifyEvery, const GossipOptions &gossip)
+    {
+        ChordRingManager manager;
+        manager.setGossipOptions(gossip);
+        ReplayReport report = replayTrace(manager, trace, verifyEvery);
+        printReport(report, cout);
+        if (gossip.enabled)
+        {
+            const GossipStats &stats = manager.getGossipStats();
+            cout << "gossip: " << stats.events << " 次成员变化（" << stats.failures << " 次失效检测），平均 "
+                 << stats.meanRounds() << " 轮（最多 " << stats.maxRounds << "），每次 " << stats.messagesPerEvent()
+                 << " 条消息，未收敛 " << stats.unconverged << endl;
+        }
+        return report.mismatches == 0 && report.verifyFailures == 0 ? 0 : 2;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        printUsage();
+        return 1;
+    }
+    string mode = argv[1];
+    WorkloadOptions opts;
+    size_t verifyEvery = 0;
+    GossipOptions gossip;
+    vector<TraceOp> trace;
+
+    if (mode == "gen" && argc >= 3)
+    {
+        if (!parseOptions(argc, argv, 3, opts, verifyEvery, gossip))
+            return 1;
+        trace = generateTrace(opts);
+        if (!saveTrace(trace, argv[2]))
+        {
+            cerr << "无法写入轨迹：" << argv[2] << endl;
+            return 1;
+        }
+        cout << "已生成 " << trace.size() << " 条操作 -> " << argv[2] << endl;
+        return 0;
+    }
+    if (mode == "replay" && argc >= 3)
+    {
+        if (!parseOptions(argc, argv, 3, opts, verifyEvery, gossip))
+            return 1;
+        if (!loadTrace(argv[2], trace))
+        {
+            cerr << "无法读取轨迹：" << argv[2] << endl;
+            return 1;
+        }
+        return replay(trace, verifyEvery, gossip);
+    }
+    if (mode == "run")
+    {
+        if (!parseOptions(argc, argv, 2, opts, verifyEvery, gossip))
+            return 1;
+        return replay(generateTrace(opts), verifyEvery, gossip);
+    }
+    printUsage();
+    return 1;
+}
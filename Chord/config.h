@@ -3,7 +3,13 @@
 
 #include <cstdint>
 
-const int m = 8;
+// 标识符位数，默认 8；基准测试等需要更大的环时可在编译时用 -DCHORD_M=<位数> 覆盖（不超过 31）
+#ifndef CHORD_M
+#define CHORD_M 8
+#endif
+static_assert(CHORD_M >= 1 && CHORD_M <= 31, "CHORD_M must be in [1, 31]");
+
+const int m = CHORD_M;
 const uint32_t ID_SPACE = (1u << m);
 
 #endif // CONFIG_H
\ No newline at end of file
@@ -0,0 +1,212 @@
+// finger 表最接近前驱选择的微基准：在随机环上为每个节点构建正确的 finger 表，
+// 分别用标量、SSE2、AVX2 内核（单个与批量接口）查询随机 target，比较吞吐，
+// 并校验所有内核的结果与原来逐个区间判断的扫描完全一致，不一致时退出码为 2。
+
+#include "config.h"
+#include "finger_simd.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+
+using namespace std;
+
+struct FingerBenchOptions
+{
+    size_t nodes = 1024;      // 环上节点数
+    size_t targets = 4096;    // 每个节点查询的 target 数
+    size_t rounds = 5;        // 每个内核重复次数，取最快一轮
+    uint64_t seed = 7;
+};
+
+namespace
+{
+    const int SLOTS = (m + FINGER_LANES - 1) / FINGER_LANES * FINGER_LANES;
+    const uint32_t MASK = ID_SPACE - 1;
+
+    // 随机环：ids 为升序节点ID，fingers 按节点顺序存放 SLOTS 个槽位
+    struct Ring
+    {
+        vector<uint32_t> ids;
+        vector<uint32_t> fingers;
+        vector<uint32_t> targets;
+    };
+
+    Ring buildRing(const FingerBenchOptions &opts)
+    {
+        Ring ring;
+        mt19937_64 rng(opts.seed);
+        size_t n = min<size_t>(opts.nodes, ID_SPACE / 2);
+        while (ring.ids.size() < n)
+        {
+            ring.ids.push_back(static_cast<uint32_t>(rng() & MASK));
+            if (ring.ids.size() == n)
+            {
+                sort(ring.ids.begin(), ring.ids.end());
+                ring.ids.erase(unique(ring.ids.begin(), ring.ids.end()), ring.ids.end());
+            }
+        }
+
+        ring.fingers.assign(ring.ids.size() * SLOTS, 0);
+        for (size_t k = 0; k < ring.ids.size(); k++)
+        {
+            uint32_t self = ring.ids[k];
+            uint32_t *f = &ring.fingers[k * SLOTS];
+            for (int i = 0; i < SLOTS; i++)
+                f[i] = self;
+            for (int i = 0; i < m; i++)
+            {
+                uint32_t start = (self + (1u << i)) & MASK;
+                auto it = lower_bound(ring.ids.begin(), ring.ids.end(), start);
+                f[i] = it == ring.ids.end() ? ring.ids.front() : *it;
+            }
+        }
+
+        ring.targets.resize(opts.targets);
+        for (auto &t : ring.targets)
+            t = static_cast<uint32_t>(rng() & MASK);
+        return ring;
+    }
+
+    // 原来的实现：从 m-1 向下扫描，跳过 self，取第一个落在 (self, target] 且不等于 target 的 finger
+    int referenceScan(const uint32_t *f, uint32_t self, uint32_t target)
+    {
+        for (int i = m - 1; i >= 0; i--)
+        {
+            uint32_t x = f[i];
+            if (x == self || x == target)
+                continue;
+            bool inside = self == target ? true : self < target ? (x > self && x <= target) : (x > self || x <= target);
+            if (inside)
+                return i;
+        }
+        return -1;
+    }
+
+    typedef int (*SingleKernel)(const uint32_t *, int, uint32_t, uint32_t, uint32_t);
+    typedef void (*BatchKernel)(const uint32_t *, int, uint32_t, const uint32_t *, size_t, uint32_t, int *);
+
+    struct KernelEntry
+    {
+        FingerKernel kernel;
+        SingleKernel single;
+        BatchKernel batch;
+    };
+
+    double seconds(chrono::steady_clock::time_point begin)
+    {
+        return chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    }
+
+    void printUsage()
+    {
+        cerr << "用法: chord_finger_bench [--nodes N] [--targets N] [--rounds N] [--seed S]" << endl;
+    }
+
+    bool parseArgs(int argc, char *argv[], FingerBenchOptions &opts)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            string arg = argv[i];
+            if (i + 1 >= argc)
+                return false;
+            string value = argv[++i];
+            if (arg == "--nodes")
+                opts.nodes = strtoull(value.c_str(), nullptr, 10);
+            else if (arg == "--targets")
+                opts.targets = strtoull(value.c_str(), nullptr, 10);
+            else if (arg == "--rounds")
+                opts.rounds = strtoull(value.c_str(), nullptr, 10);
+            else if (arg == "--seed")
+                opts.seed = strtoull(value.c_str(), nullptr, 10);
+            else
+                return false;
+        }
+        return opts.nodes > 0 && opts.targets > 0 && opts.rounds > 0;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    FingerBenchOptions opts;
+    if (!parseArgs(argc, argv, opts))
+    {
+        printUsage();
+        return 1;
+    }
+
+    Ring ring = buildRing(opts);
+    size_t queries = ring.ids.size() * ring.targets.size();
+    cout << "m = " << m << "，槽位 " << SLOTS << "，节点 " << ring.ids.size() << "，每节点 target "
+         << ring.targets.size() << "，当前内核 " << fingerKernelName(activeFingerKernel()) << endl;
+
+    const KernelEntry kernels[] = {
+        {FingerKernel::SCALAR, closestPrecedingScalar, closestPrecedingBatchScalar},
+        {FingerKernel::SSE2, closestPrecedingSse2, closestPrecedingBatchSse2},
+        {FingerKernel::AVX2, closestPrecedingAvx2, closestPrecedingBatchAvx2},
+    };
+
+    // 原实现选中的下标作为参照，各内核须返回相同下标
+    vector<int> expected(queries);
+    for (size_t k = 0; k < ring.ids.size(); k++)
+        for (size_t t = 0; t < ring.targets.size(); t++)
+            expected[k * ring.targets.size() + t] = referenceScan(&ring.fingers[k * SLOTS], ring.ids[k], ring.targets[t]);
+
+    size_t mismatches = 0;
+    vector<int> got(queries);
+    cout << left << setw(8) << "kernel" << setw(8) << "api" << right << setw(14) << "Mq/s" << setw(12) << "ns/q"
+         << endl;
+    for (const auto &entry : kernels)
+    {
+        if (!fingerKernelSupported(entry.kernel))
+        {
+            cout << left << setw(8) << fingerKernelName(entry.kernel) << "不支持，跳过" << endl;
+            continue;
+        }
+        for (int batched = 0; batched < 2; batched++)
+        {
+            double best = 0;
+            for (size_t r = 0; r < opts.rounds; r++)
+            {
+                auto begin = chrono::steady_clock::now();
+                for (size_t k = 0; k < ring.ids.size(); k++)
+                {
+                    const uint32_t *f = &ring.fingers[k * SLOTS];
+                    int *out = &got[k * ring.targets.size()];
+                    if (batched)
+                        entry.batch(f, SLOTS, ring.ids[k], ring.targets.data(), ring.targets.size(), MASK, out);
+                    else
+                        for (size_t t = 0; t < ring.targets.size(); t++)
+                            out[t] = entry.single(f, SLOTS, ring.ids[k], ring.targets[t], MASK);
+                }
+                double s = seconds(begin);
+                if (r == 0 || s < best)
+                    best = s;
+            }
+
+            size_t bad = 0;
+            for (size_t q = 0; q < queries; q++)
+                if (got[q] != expected[q])
+                    bad++;
+            mismatches += bad;
+
+            cout << left << setw(8) << fingerKernelName(entry.kernel) << setw(8) << (batched ? "batch" : "single")
+                 << right << fixed << setprecision(1) << setw(14) << queries / best / 1e6 << setw(12)
+                 << best * 1e9 / queries;
+            if (bad)
+                cout << "  不一致 " << bad;
+            cout << endl;
+        }
+    }
+
+    if (mismatches)
+    {
+        cerr << "内核结果与原实现不一致: " << mismatches << endl;
+        return 2;
+    }
+    return 0;
+}
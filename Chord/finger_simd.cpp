@@ -0,0 +1,293 @@
+#include "finger_simd.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CHORD_X86 1
+#endif
+
+#if defined(CHORD_X86) && !defined(CHORD_NO_SIMD) && \
+    (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define CHORD_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// GCC/Clang 用函数级 target 属性编译 AVX2 版本并在运行时检测；MSVC 只有在 /arch:AVX2 下才启用
+#if defined(CHORD_HAVE_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#define CHORD_HAVE_AVX2 1
+#define CHORD_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(CHORD_HAVE_SSE2) && defined(__AVX2__)
+#define CHORD_HAVE_AVX2 1
+#define CHORD_TARGET_AVX2
+#include <immintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+    // 最高置位的下标，bits 为 0 时返回 -1
+    inline int highestBit(uint32_t bits)
+    {
+        if (bits == 0)
+            return -1;
+#ifdef _MSC_VER
+        unsigned long idx;
+        _BitScanReverse(&idx, bits);
+        return static_cast<int>(idx);
+#else
+        return 31 - __builtin_clz(bits);
+#endif
+    }
+
+#ifdef CHORD_HAVE_SSE2
+    // fingers 的距离 (f - self - 1) & mask 与 limit 做无符号小于比较，返回按下标排列的位掩码
+    inline uint32_t laneMaskSse2(const __m128i *regs, int vectors, __m128i selfPlusOne, __m128i maskv, __m128i limitBiased)
+    {
+        const __m128i bias = _mm_set1_epi32(static_cast<int>(0x80000000u));
+        uint32_t bits = 0;
+        for (int v = 0; v < vectors; v++)
+        {
+            __m128i dist = _mm_and_si128(_mm_sub_epi32(regs[v], selfPlusOne), maskv);
+            __m128i lt = _mm_cmplt_epi32(_mm_xor_si128(dist, bias), limitBiased);
+            bits |= static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(lt))) << (4 * v);
+        }
+        return bits;
+    }
+#endif
+
+#ifdef CHORD_HAVE_AVX2
+    CHORD_TARGET_AVX2 inline uint32_t laneMaskAvx2(const __m256i *regs, int vectors, __m256i selfPlusOne, __m256i maskv,
+                                                   __m256i limitBiased)
+    {
+        const __m256i bias = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+        uint32_t bits = 0;
+        for (int v = 0; v < vectors; v++)
+        {
+            __m256i dist = _mm256_and_si256(_mm256_sub_epi32(regs[v], selfPlusOne), maskv);
+            __m256i lt = _mm256_cmpgt_epi32(limitBiased, _mm256_xor_si256(dist, bias));
+            bits |= static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(lt))) << (8 * v);
+        }
+        return bits;
+    }
+#endif
+
+    // 一次比较的槽位数上限（位掩码为 32 位）；m <= 31 的 finger 表补齐后正好一块，
+    // 更长的表（Symphony 长链接、Kademlia 桶）从高位块向低位块逐块比较，第一个命中的块即含最大下标
+    const int MAX_SLOTS = 32;
+
+    // 最后一块的起始下标
+    inline int lastChunk(int slots) { return slots > 0 ? (slots - 1) / MAX_SLOTS * MAX_SLOTS : 0; }
+}
+
+/**
+ * @brief 标量版本：从高到低扫描，返回第一个满足条件的下标
+ */
+int closestPrecedingScalar(const uint32_t *fingers, int slots, uint32_t self, uint32_t target, uint32_t mask)
+{
+    uint32_t limit = (target - self - 1) & mask;
+    for (int i = slots - 1; i >= 0; i--)
+    {
+        if (((fingers[i] - self - 1) & mask) < limit)
+            return i;
+    }
+    return -1;
+}
+
+void closestPrecedingBatchScalar(const uint32_t *fingers, int slots, uint32_t self, const uint32_t *targets, size_t n,
+                                 uint32_t mask, int *out)
+{
+    for (size_t t = 0; t < n; t++)
+        out[t] = closestPrecedingScalar(fingers, slots, self, targets[t], mask);
+}
+
+/**
+ * @brief SSE2 版本：每次比较 4 个 finger，所有比较结果拼成一个位掩码后取最高位
+ */
+int closestPrecedingSse2(const uint32_t *fingers, int slots, uint32_t self, uint32_t target, uint32_t mask)
+{
+#ifdef CHORD_HAVE_SSE2
+    uint32_t limit = (target - self - 1) & mask;
+    const __m128i selfPlusOne = _mm_set1_epi32(static_cast<int>(self + 1));
+    const __m128i maskv = _mm_set1_epi32(static_cast<int>(mask));
+    const __m128i limitBiased = _mm_set1_epi32(static_cast<int>(limit ^ 0x80000000u));
+    for (int base = lastChunk(slots); base >= 0; base -= MAX_SLOTS)
+    {
+        __m128i regs[MAX_SLOTS / 4];
+        int vectors = (slots - base < MAX_SLOTS ? slots - base : MAX_SLOTS) / 4;
+        for (int v = 0; v < vectors; v++)
+            regs[v] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(fingers + base + 4 * v));
+        uint32_t bits = laneMaskSse2(regs, vectors, selfPlusOne, maskv, limitBiased);
+        if (bits)
+            return base + highestBit(bits);
+    }
+    return -1;
+#else
+    return closestPrecedingScalar(fingers, slots, self, target, mask);
+#endif
+}
+
+void closestPrecedingBatchSse2(const uint32_t *fingers, int slots, uint32_t self, const uint32_t *targets, size_t n,
+                               uint32_t mask, int *out)
+{
+#ifdef CHORD_HAVE_SSE2
+    if (slots > MAX_SLOTS)
+    {
+        for (size_t t = 0; t < n; t++)
+            out[t] = closestPrecedingSse2(fingers, slots, self, targets[t], mask);
+        return;
+    }
+    __m128i regs[MAX_SLOTS / 4];
+    int vectors = slots / 4;
+    for (int v = 0; v < vectors; v++)
+        regs[v] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(fingers + 4 * v));
+    const __m128i selfPlusOne = _mm_set1_epi32(static_cast<int>(self + 1));
+    const __m128i maskv = _mm_set1_epi32(static_cast<int>(mask));
+    for (size_t t = 0; t < n; t++)
+    {
+        uint32_t limit = (targets[t] - self - 1) & mask;
+        out[t] = highestBit(laneMaskSse2(regs, vectors, selfPlusOne, maskv,
+                                         _mm_set1_epi32(static_cast<int>(limit ^ 0x80000000u))));
+    }
+#else
+    closestPrecedingBatchScalar(fingers, slots, self, targets, n, mask, out);
+#endif
+}
+
+/**
+ * @brief AVX2 版本：每次比较 8 个 finger
+ */
+#ifdef CHORD_HAVE_AVX2
+CHORD_TARGET_AVX2
+#endif
+int closestPrecedingAvx2(const uint32_t *fingers, int slots, uint32_t self, uint32_t target, uint32_t mask)
+{
+#ifdef CHORD_HAVE_AVX2
+    uint32_t limit = (target - self - 1) & mask;
+    const __m256i selfPlusOne = _mm256_set1_epi32(static_cast<int>(self + 1));
+    const __m256i maskv = _mm256_set1_epi32(static_cast<int>(mask));
+    const __m256i limitBiased = _mm256_set1_epi32(static_cast<int>(limit ^ 0x80000000u));
+    for (int base = lastChunk(slots); base >= 0; base -= MAX_SLOTS)
+    {
+        __m256i regs[MAX_SLOTS / 8];
+        int vectors = (slots - base < MAX_SLOTS ? slots - base : MAX_SLOTS) / 8;
+        for (int v = 0; v < vectors; v++)
+            regs[v] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(fingers + base + 8 * v));
+        uint32_t bits = laneMaskAvx2(regs, vectors, selfPlusOne, maskv, limitBiased);
+        if (bits)
+            return base + highestBit(bits);
+    }
+    return -1;
+#else
+    return closestPrecedingSse2(fingers, slots, self, target, mask);
+#endif
+}
+
+#ifdef CHORD_HAVE_AVX2
+CHORD_TARGET_AVX2
+#endif
+void closestPrecedingBatchAvx2(const uint32_t *fingers, int slots, uint32_t self, const uint32_t *targets, size_t n,
+                               uint32_t mask, int *out)
+{
+#ifdef CHORD_HAVE_AVX2
+    if (slots > MAX_SLOTS)
+    {
+        for (size_t t = 0; t < n; t++)
+            out[t] = closestPrecedingAvx2(fingers, slots, self, targets[t], mask);
+        return;
+    }
+    __m256i regs[MAX_SLOTS / 8];
+    int vectors = slots / 8;
+    for (int v = 0; v < vectors; v++)
+        regs[v] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(fingers + 8 * v));
+    const __m256i selfPlusOne = _mm256_set1_epi32(static_cast<int>(self + 1));
+    const __m256i maskv = _mm256_set1_epi32(static_cast<int>(mask));
+    for (size_t t = 0; t < n; t++)
+    {
+        uint32_t limit = (targets[t] - self - 1) & mask;
+        out[t] = highestBit(laneMaskAvx2(regs, vectors, selfPlusOne, maskv,
+                                         _mm256_set1_epi32(static_cast<int>(limit ^ 0x80000000u))));
+    }
+#else
+    closestPrecedingBatchSse2(fingers, slots, self, targets, n, mask, out);
+#endif
+}
+
+/**
+ * @brief 检查当前 CPU 与构建是否支持指定内核
+ */
+bool fingerKernelSupported(FingerKernel kernel)
+{
+    switch (kernel)
+    {
+    case FingerKernel::SCALAR:
+        return true;
+    case FingerKernel::SSE2:
+#ifdef CHORD_HAVE_SSE2
+        return true;
+#else
+        return false;
+#endif
+    case FingerKernel::AVX2:
+#if defined(CHORD_HAVE_AVX2) && (defined(__GNUC__) || defined(__clang__))
+        return __builtin_cpu_supports("avx2");
+#elif defined(CHORD_HAVE_AVX2)
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+FingerKernel activeFingerKernel()
+{
+    static const FingerKernel kernel = fingerKernelSupported(FingerKernel::AVX2)   ? FingerKernel::AVX2
+                                       : fingerKernelSupported(FingerKernel::SSE2) ? FingerKernel::SSE2
+                                                                                   : FingerKernel::SCALAR;
+    return kernel;
+}
+
+const char *fingerKernelName(FingerKernel kernel)
+{
+    switch (kernel)
+    {
+    case FingerKernel::AVX2:
+        return "avx2";
+    case FingerKernel::SSE2:
+        return "sse2";
+    default:
+        return "scalar";
+    }
+}
+
+int closestPrecedingIndex(const uint32_t *fingers, int slots, uint32_t self, uint32_t target, uint32_t mask)
+{
+    switch (activeFingerKernel())
+    {
+    case FingerKernel::AVX2:
+        return closestPrecedingAvx2(fingers, slots, self, target, mask);
+    case FingerKernel::SSE2:
+        return closestPrecedingSse2(fingers, slots, self, target, mask);
+    default:
+        return closestPrecedingScalar(fingers, slots, self, target, mask);
+    }
+}
+
+void closestPrecedingIndexBatch(const uint32_t *fingers, int slots, uint32_t self, const uint32_t *targets, size_t n,
+                                uint32_t mask, int *out)
+{
+    switch (activeFingerKernel())
+    {
+    case FingerKernel::AVX2:
+        closestPrecedingBatchAvx2(fingers, slots, self, targets, n, mask, out);
+        break;
+    case FingerKernel::SSE2:
+        closestPrecedingBatchSse2(fingers, slots, self, targets, n, mask, out);
+        break;
+    default:
+        closestPrecedingBatchScalar(fingers, slots, self, targets, n, mask, out);
+        break;
+    }
+}
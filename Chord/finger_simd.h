@@ -0,0 +1,43 @@
+#ifndef FINGER_SIMD_H
+#define FINGER_SIMD_H
+
+#include <cstdint>
+#include <cstddef>
+
+// 最接近前驱 finger 的选择内核。
+// finger f 可作为 target 的前驱当且仅当 f 落在开区间 (self, target) 内（target == self 时为整个环去掉 self），
+// 等价于无符号比较 ((f - self - 1) & mask) < ((target - self - 1) & mask)，与原来的两次区间判断结果一致；
+// 多个 finger 满足时取下标最大的一个，与从 m-1 向下扫描的顺序相同。
+// fingers 数组长度需为 FINGER_LANES 的整数倍，多出的槽位填 self（永远不满足条件）；长度不限，超过 32 个槽位时分块比较。
+
+const int FINGER_LANES = 8;
+
+enum class FingerKernel
+{
+    SCALAR,
+    SSE2,
+    AVX2
+};
+
+int closestPrecedingScalar(const uint32_t *fingers, int slots, uint32_t self, uint32_t target, uint32_t mask);
+int closestPrecedingSse2(const uint32_t *fingers, int slots, uint32_t self, uint32_t target, uint32_t mask);
+int closestPrecedingAvx2(const uint32_t *fingers, int slots, uint32_t self, uint32_t target, uint32_t mask);
+
+// 批量版本：fingers 只加载一次，依次处理多个 target，结果下标写入 out（-1 表示没有满足条件的 finger）
+void closestPrecedingBatchScalar(const uint32_t *fingers, int slots, uint32_t self, const uint32_t *targets, size_t n,
+                                 uint32_t mask, int *out);
+void closestPrecedingBatchSse2(const uint32_t *fingers, int slots, uint32_t self, const uint32_t *targets, size_t n,
+                               uint32_t mask, int *out);
+void closestPrecedingBatchAvx2(const uint32_t *fingers, int slots, uint32_t self, const uint32_t *targets, size_t n,
+                               uint32_t mask, int *out);
+
+bool fingerKernelSupported(FingerKernel kernel);
+FingerKernel activeFingerKernel(); // 当前 CPU 上可用的最快内核，首次调用时检测
+const char *fingerKernelName(FingerKernel kernel);
+
+// 按 activeFingerKernel() 分派
+int closestPrecedingIndex(const uint32_t *fingers, int slots, uint32_t self, uint32_t target, uint32_t mask);
+void closestPrecedingIndexBatch(const uint32_t *fingers, int slots, uint32_t self, const uint32_t *targets, size_t n,
+                                uint32_t mask, int *out);
+
+#endif // FINGER_SIMD_H
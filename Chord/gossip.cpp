@@ -0,0 +1,285 @@
+#include "gossip.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+using namespace std;
+
+void GossipStats::add(const GossipRun &run, bool failure)
+{
+    events++;
+    if (failure)
+        failures++;
+    rounds += run.rounds;
+    maxRounds = max<uint64_t>(maxRounds, run.rounds);
+    detectRounds += run.detectRounds;
+    messages += run.messages;
+    piggybacked += run.piggybacked;
+    syncs += run.syncs;
+    maxPerNode = max<uint64_t>(maxPerNode, run.maxPerNode);
+    if (!run.converged)
+        unconverged++;
+}
+
+// 一次传播的状态：成员按下标编号，下标 n 表示已崩溃、仍被其他成员当作成员的节点
+struct MembershipGossip::Run
+{
+    const vector<uint32_t> *members;
+    size_t n;
+    size_t joined;        // 新加入成员的下标，SIZE_MAX 表示没有
+    bool crashed;         // 是否有已崩溃的目标
+    uint32_t crashedId;
+    uint32_t successorId;
+    uint16_t budget;      // 每个节点对每条更新的转发次数
+    const Deliver *deliver;
+    vector<Rumor> rumors; // 至多 SUSPECT 与 DEAD 两条，或一条加入 / 离开
+    int main;             // 全部成员得知即结束本次传播的更新，-1 表示尚未产生
+    int suspect;
+    size_t suspectRound;
+    size_t suspecter;
+    vector<uint32_t> sent; // 本轮各成员发出的消息数
+    vector<int> picked;    // carry 的候选更新（复用，避免每条消息分配）
+    GossipRun result;
+
+    bool knows(int rumor, size_t member) const { return rumor >= 0 && rumors[rumor].knownAt[member] != 0; }
+};
+
+MembershipGossip::MembershipGossip(const GossipOptions &options) : options(options), rng(options.seed) {}
+
+void MembershipGossip::setOptions(const GossipOptions &options)
+{
+    this->options = options;
+    rng.seed(options.seed);
+}
+
+const GossipOptions &MembershipGossip::getOptions() const { return options; }
+
+/**
+ * @brief 成员第一次得知一条更新：从下一轮起可以转发，转发次数重新计满
+ * @return true 若此前不知道
+ */
+bool MembershipGossip::learn(Run &run, Rumor &rumor, size_t member, size_t round) const
+{
+    if (rumor.knownAt[member] != 0)
+        return false;
+    rumor.knownAt[member] = static_cast<uint32_t>(round + 1);
+    rumor.budget[member] = run.budget;
+    rumor.informed++;
+    (*run.deliver)((*run.members)[member], rumor.update);
+    return true;
+}
+
+/**
+ * @brief 一条消息从 from 发到 to：捎带 from 本轮可转发、剩余转发次数最多的至多 piggyback 条更新
+ */
+void MembershipGossip::carry(Run &run, size_t from, size_t to, size_t round) const
+{
+    vector<int> &picked = run.picked;
+    picked.clear();
+    for (size_t r = 0; r < run.rumors.size(); r++)
+    {
+        const Rumor &rumor = run.rumors[r];
+        if (rumor.knownAt[from] != 0 && rumor.knownAt[from] <= round && rumor.budget[from] > 0)
+            picked.push_back(static_cast<int>(r));
+    }
+    size_t count = picked.size();
+    for (size_t a = 1; a < count; a++) // 至多几条，插入排序
+        for (size_t b = a; b > 0 && run.rumors[picked[b]].budget[from] > run.rumors[picked[b - 1]].budget[from]; b--)
+            swap(picked[b], picked[b - 1]);
+    count = min(count, options.piggyback);
+    for (size_t k = 0; k < count; k++)
+    {
+        Rumor &rumor = run.rumors[picked[k]];
+        rumor.budget[from]--;
+        run.result.piggybacked++;
+        learn(run, rumor, to, round);
+    }
+}
+
+/**
+ * @brief 推进一轮：每个存活成员 ping 一个随机成员（不 ping 自己尚不知道的新成员与已知失效的成员）
+ * @return size_t 主更新已得知的成员数
+ */
+size_t MembershipGossip::step(Run &run, size_t round)
+{
+    size_t n = run.n;
+    fill(run.sent.begin(), run.sent.end(), 0);
+    for (size_t i = 0; i < n; i++)
+    {
+        bool seesCrashed = run.crashed && !(run.main >= 0 && run.knows(run.main, i));
+        size_t pool = n + (seesCrashed ? 1 : 0);
+        if (pool < 2)
+            continue;
+        size_t j = i;
+        for (int tries = 0; tries < 4 && j == i; tries++)
+        {
+            size_t pick = rng() % pool;
+            if (pick != i && !(pick == run.joined && !run.knows(0, i)))
+                j = pick;
+        }
+        if (j == i)
+            continue;
+
+        if (j < n)
+        {
+            // ping 与 ack 各捎带发送方的更新
+            run.result.messages += 2;
+            run.sent[i]++;
+            run.sent[j]++;
+            carry(run, i, j, round);
+            carry(run, j, i, round);
+            continue;
+        }
+
+        // 目标已崩溃：ping 超时后经 indirect 个成员发 ping-req，它们的间接 ping 同样没有应答
+        run.result.messages++;
+        run.sent[i]++;
+        for (size_t k = 0; k < options.indirect && n > 1; k++)
+        {
+            size_t relay = rng() % n;
+            if (relay == i)
+                continue;
+            run.result.messages += 2;
+            run.sent[i]++;
+            run.sent[relay]++;
+            carry(run, i, relay, round);
+        }
+        if (run.suspect < 0)
+        {
+            Rumor rumor;
+            rumor.update.id = run.crashedId;
+            rumor.update.state = MemberState::SUSPECT;
+            rumor.update.successorId = run.successorId;
+            rumor.knownAt.assign(n, 0);
+            rumor.budget.assign(n, 0);
+            rumor.informed = 0;
+            run.rumors.push_back(rumor);
+            run.suspect = static_cast<int>(run.rumors.size() - 1);
+            run.suspectRound = round;
+            run.suspecter = i;
+            run.result.detectRounds = round;
+        }
+        learn(run, run.rumors[run.suspect], i, round);
+    }
+    for (uint32_t s : run.sent)
+        run.result.maxPerNode = max<size_t>(run.result.maxPerNode, s);
+
+    // 怀疑期满没有反驳：最先怀疑的成员确认失效，开始传播 DEAD
+    if (run.suspect >= 0 && run.main < 0 && round >= run.suspectRound + options.suspectRounds)
+    {
+        Rumor rumor;
+        rumor.update.id = run.crashedId;
+        rumor.update.state = MemberState::DEAD;
+        rumor.update.successorId = run.successorId;
+        rumor.knownAt.assign(n, 0);
+        rumor.budget.assign(n, 0);
+        rumor.informed = 0;
+        run.rumors.push_back(rumor);
+        run.main = static_cast<int>(run.rumors.size() - 1);
+        learn(run, run.rumors[run.main], run.suspecter, round);
+    }
+    if (run.main < 0)
+        return 0;
+
+    // 所有得知者的转发次数都已用完而仍有成员不知道：这些成员与随机成员做一次 push-pull 同步
+    Rumor &main = run.rumors[run.main];
+    if (main.informed < n)
+    {
+        bool active = false;
+        for (size_t i = 0; i < n && !active; i++)
+            active = main.knownAt[i] != 0 && main.budget[i] > 0;
+        if (!active)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                if (main.knownAt[i] != 0)
+                    continue;
+                size_t peer = rng() % n;
+                if (peer == i)
+                    continue;
+                run.result.messages += 2;
+                run.result.syncs++;
+                if (main.knownAt[peer] != 0 && main.knownAt[peer] <= round)
+                    learn(run, main, i, round);
+            }
+        }
+    }
+    return main.informed;
+}
+
+GossipRun MembershipGossip::disseminate(const vector<uint32_t> &members, size_t origin, size_t joined,
+                                        const GossipUpdate &update, const Deliver &deliver)
+{
+    Run run;
+    run.members = &members;
+    run.n = members.size();
+    run.joined = joined;
+    run.crashed = false;
+    run.crashedId = 0;
+    run.successorId = update.successorId;
+    run.budget = static_cast<uint16_t>(min(65535.0, max(1.0, ceil(options.retransmitMult * log2(run.n + 1.0)))));
+    run.deliver = &deliver;
+    run.suspect = -1;
+    run.suspectRound = 0;
+    run.suspecter = 0;
+    run.sent.assign(run.n, 0);
+    if (run.n == 0)
+        return run.result;
+
+    Rumor rumor;
+    rumor.update = update;
+    rumor.knownAt.assign(run.n, 0);
+    rumor.budget.assign(run.n, 0);
+    rumor.informed = 0;
+    run.rumors.push_back(rumor);
+    run.main = 0;
+    learn(run, run.rumors[0], origin, 0);
+
+    size_t round = 0;
+    while (run.rumors[0].informed < run.n && round < options.maxRounds)
+        step(run, ++round);
+    run.result.rounds = round;
+    if (run.rumors[0].informed < run.n)
+    {
+        run.result.converged = false;
+        for (size_t i = 0; i < run.n; i++)
+            learn(run, run.rumors[0], i, round);
+    }
+    return run.result;
+}
+
+GossipRun MembershipGossip::detectFailure(const vector<uint32_t> &members, uint32_t crashed, uint32_t successorId,
+                                          const Deliver &deliver)
+{
+    Run run;
+    run.members = &members;
+    run.n = members.size();
+    run.joined = SIZE_MAX;
+    run.crashed = true;
+    run.crashedId = crashed;
+    run.successorId = successorId;
+    run.budget = static_cast<uint16_t>(min(65535.0, max(1.0, ceil(options.retransmitMult * log2(run.n + 1.0)))));
+    run.deliver = &deliver;
+    run.rumors.reserve(2);
+    run.main = -1;
+    run.suspect = -1;
+    run.suspectRound = 0;
+    run.suspecter = 0;
+    run.sent.assign(run.n, 0);
+    if (run.n == 0)
+        return run.result;
+
+    size_t round = 0;
+    while ((run.main < 0 || run.rumors[run.main].informed < run.n) && round < options.maxRounds)
+        step(run, ++round);
+    run.result.rounds = round;
+    if (run.main < 0 || run.rumors[run.main].informed < run.n)
+    {
+        run.result.converged = false;
+        GossipUpdate dead = {crashed, MemberState::DEAD, successorId};
+        for (size_t i = 0; i < run.n; i++)
+            if (!run.knows(run.main, i))
+                deliver(members[i], dead);
+    }
+    return run.result;
+}
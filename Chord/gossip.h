@@ -0,0 +1,114 @@
+#ifndef GOSSIP_H
+#define GOSSIP_H
+
+#include <vector>
+#include <random>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+// 成员状态：ALIVE 为加入，SUSPECT 为怀疑（ping 与 ping-req 均无应答），DEAD 为确认失效，LEFT 为正常离开
+enum class MemberState : uint8_t
+{
+    ALIVE,
+    SUSPECT,
+    DEAD,
+    LEFT
+};
+
+// 一条成员更新，捎带在 ping / ack / ping-req 上传播
+struct GossipUpdate
+{
+    uint32_t id;          // 变化的成员
+    MemberState state;
+    uint32_t successorId; // DEAD / LEFT：该成员离开后环上接替它的节点，收到者据此就地修补指向它的 finger
+};
+
+// SWIM 式成员传播配置
+struct GossipOptions
+{
+    bool enabled = false;
+    size_t piggyback = 6;        // 每条消息最多捎带的更新数
+    double retransmitMult = 3;   // 每个节点转发同一条更新 ceil(retransmitMult·log2(N+1)) 次后不再捎带（SWIM 的 λ）
+    size_t indirect = 3;         // ping 无应答时经多少个成员发 ping-req
+    size_t suspectRounds = 3;    // 怀疑后多少轮未被反驳即确认失效
+    size_t maxRounds = 1000;     // 一次传播最多推进的轮数，超过后其余成员直接得知并计为未收敛
+    double periodMs = 200;       // 协议周期，传播时延 = 轮数 × periodMs
+    uint64_t seed = 1;
+};
+
+// 一次成员变化的传播结果
+struct GossipRun
+{
+    size_t rounds = 0;       // 从变化发生到全部存活成员得知的轮数
+    size_t detectRounds = 0; // 失效：从崩溃到首次怀疑的轮数
+    size_t messages = 0;     // ping、ack、ping-req、间接 ping 与补偿同步的消息总数
+    size_t piggybacked = 0;  // 捎带的更新条数
+    size_t syncs = 0;        // 捎带次数用尽后仍未得知的成员发起的 push-pull 同步数
+    size_t maxPerNode = 0;   // 单个节点在一轮中发出的最多消息数
+    bool converged = true;
+};
+
+// 累计统计
+struct GossipStats
+{
+    uint64_t events = 0;     // 传播的成员变化数（加入、离开、失效）
+    uint64_t failures = 0;   // 其中经失效检测的崩溃数
+    uint64_t rounds = 0;
+    uint64_t maxRounds = 0;
+    uint64_t detectRounds = 0;
+    uint64_t messages = 0;
+    uint64_t piggybacked = 0;
+    uint64_t syncs = 0;
+    uint64_t maxPerNode = 0;
+    uint64_t unconverged = 0;
+
+    double meanRounds() const { return events ? static_cast<double>(rounds) / events : 0; }
+    double messagesPerEvent() const { return events ? static_cast<double>(messages) / events : 0; }
+    void add(const GossipRun &run, bool failure);
+};
+
+// SWIM 式传播模拟：每轮每个存活成员随机 ping 一个它所知的成员，ping 与 ack 各捎带发送方至多 piggyback 条
+// 尚未用完转发次数的更新；目标无应答时经 indirect 个成员发 ping-req，仍无应答则怀疑目标，suspectRounds 轮后确认失效。
+// 一轮中新得知的更新从下一轮起才转发。每个节点每轮发 1 个 ping，并回复收到的 ping，消息数与 N 无关，
+// 更新在 O(log N) 轮内传遍全部成员。不模拟丢包，因此没有误判，也不需要 incarnation 反驳
+class MembershipGossip
+{
+public:
+    // 节点第一次得知一条更新时回调（发起者也会收到），由管理器据此修补该节点的路由表
+    typedef std::function<void(uint32_t nodeId, const GossipUpdate &update)> Deliver;
+
+private:
+    GossipOptions options;
+    std::mt19937_64 rng;
+
+    // 一条在途更新：knownAt[i] 为成员 i 可以开始转发的轮次（0 表示尚未得知），budget[i] 为剩余转发次数
+    struct Rumor
+    {
+        GossipUpdate update;
+        std::vector<uint32_t> knownAt;
+        std::vector<uint16_t> budget;
+        size_t informed;
+    };
+
+    struct Run;
+    bool learn(Run &run, Rumor &rumor, size_t member, size_t round) const;
+    void carry(Run &run, size_t from, size_t to, size_t round) const;
+    size_t step(Run &run, size_t round);
+
+public:
+    explicit MembershipGossip(const GossipOptions &options);
+    void setOptions(const GossipOptions &options);
+    const GossipOptions &getOptions() const;
+
+    // 传播一条加入或离开：members 为变化后的有序存活成员，origin 是最先得知的成员，
+    // joined 为新加入成员的下标（尚未得知的成员不会 ping 它），没有时传 SIZE_MAX
+    GossipRun disseminate(const std::vector<uint32_t> &members, size_t origin, size_t joined,
+                          const GossipUpdate &update, const Deliver &deliver);
+    // 检测并传播一次崩溃：crashed 已不在 members 中，但在得知其失效前其余成员仍会 ping 它；
+    // successorId 随 DEAD 更新一起传播
+    GossipRun detectFailure(const std::vector<uint32_t> &members, uint32_t crashed, uint32_t successorId,
+                            const Deliver &deliver);
+};
+
+#endif // GOSSIP_H
@@ -48,6 +48,8 @@ void Logger::log(const string &message)
     }
 }
 
+bool Logger::isEnabled() const { return enabled && logFile.is_open(); }
+
 void Logger::error(const string &message) { log("[ERROR] " + message); }
 void Logger::warning(const string &message) { log("[WARNING] " + message); }
 void Logger::info(const string &message) { log("[INFO] " + message); }
@@ -14,6 +14,7 @@ public:
     Logger() : enabled(false) {}
     void init(const std::string &filename);
     void close();
+    bool isEnabled() const;
     void log(const std::string &message);
     void error(const std::string &message);
     void warning(const std::string &message);
@@ -68,6 +68,7 @@
 #include "chord.h"
 #include "logger.h"
 #include "chord_cli.h"
+#include <iostream>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -75,7 +76,7 @@
 #include <fcntl.h>
 #endif
 
-int main()
+int main(int argc, char *argv[])
 {
 #ifdef _WIN32
     SetConsoleOutputCP(65001);
@@ -86,6 +87,22 @@ int main()
     try
     {
         ChordRingManager manager; // 使用默认 m=8
+
+        // 可选参数：数据目录，指定后启用持久化（WAL + 快照），启动时恢复上次的环
+        if (argc > 1)
+        {
+            StorageOptions options;
+            options.dataDir = argv[1];
+            if (manager.openStorage(options))
+            {
+                const StorageStats &stats = manager.getStorage().getStats();
+                std::cout << "已从 " << options.dataDir << " 恢复 " << stats.recoveredNodes << " 个节点、"
+                          << stats.recoveredResources << " 个资源，耗时 " << stats.recoveryMs << " ms" << std::endl;
+            }
+            else
+                std::cerr << "无法打开数据目录：" << options.dataDir << std::endl;
+        }
+
         ChordCLI cli(manager);
         cli.run();
         logger.close();
@@ -0,0 +1,232 @@
+#include "netsim.h"
+#include "logger.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace
+{
+    // splitmix64：由节点ID与种子得到与调用顺序无关的伪随机数
+    uint64_t mix(uint64_t x)
+    {
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    // 取 [0, 1) 内的小数
+    double unit(uint64_t x)
+    {
+        return (x >> 11) * (1.0 / 9007199254740992.0);
+    }
+}
+
+// ==================== CoordinateLatencyModel 实现 ====================
+
+CoordinateLatencyModel::CoordinateLatencyModel(uint64_t seed, double baseRttMs, double diameterMs, double maxAccessMs,
+                                               double minBandwidthMbps, double maxBandwidthMbps)
+    : seed(seed), baseRttMs(baseRttMs), diameterMs(diameterMs), maxAccessMs(maxAccessMs),
+      minBandwidthMbps(max(minBandwidthMbps, 1e-3)), maxBandwidthMbps(max(maxBandwidthMbps, minBandwidthMbps))
+{
+}
+
+/**
+ * @brief 计算两个节点之间的链路属性，坐标、接入时延与接入带宽都由节点ID与种子直接算出，无需保存
+ * @param a 节点
+ * @param b 节点
+ * @return LinkProfile 链路属性
+ */
+LinkProfile CoordinateLatencyModel::link(const Node &a, const Node &b) const
+{
+    uint64_t ha = mix(seed ^ a.id), hb = mix(seed ^ b.id);
+    double ax = unit(ha), ay = unit(mix(ha)), bx = unit(hb), by = unit(mix(hb));
+    double accessA = maxAccessMs * unit(mix(ha + 1)), accessB = maxAccessMs * unit(mix(hb + 1));
+    double ratio = log(maxBandwidthMbps / minBandwidthMbps);
+    double bwA = minBandwidthMbps * exp(ratio * unit(mix(ha + 2)));
+    double bwB = minBandwidthMbps * exp(ratio * unit(mix(hb + 2)));
+
+    LinkProfile p;
+    p.rttMs = baseRttMs + diameterMs * hypot(ax - bx, ay - by) + accessA + accessB;
+    p.bandwidthMbps = min(bwA, bwB);
+    return p;
+}
+
+// ==================== MatrixLatencyModel 实现 ====================
+
+MatrixLatencyModel::MatrixLatencyModel(const LinkProfile &fallback) : fallback(fallback) {}
+
+uint64_t MatrixLatencyModel::key(uint32_t a, uint32_t b)
+{
+    if (a > b)
+        swap(a, b);
+    return (static_cast<uint64_t>(a) << 32) | b;
+}
+
+/**
+ * @brief 加载 RTT 文件，IP 按节点ID的计算方式转换为ID后保存，之后查询不再访问字符串
+ * @param path 文件路径
+ * @return true 若加载成功（格式错误的行会使加载失败）
+ */
+bool MatrixLatencyModel::load(const string &path)
+{
+    ifstream in(path);
+    if (!in)
+    {
+        logger.error("无法打开 RTT 矩阵文件: " + path);
+        return false;
+    }
+    string line;
+    size_t lineNo = 0;
+    while (getline(in, line))
+    {
+        lineNo++;
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        size_t first = line.find_first_not_of(" \t");
+        if (first == string::npos || line[first] == '#')
+            continue;
+        istringstream ss(line);
+        string ipA, ipB;
+        LinkProfile p = fallback;
+        if (!(ss >> ipA >> ipB >> p.rttMs) || p.rttMs < 0)
+        {
+            logger.error("RTT 矩阵文件格式错误: " + path + " 第 " + to_string(lineNo) + " 行");
+            return false;
+        }
+        double bw;
+        if (ss >> bw && bw > 0)
+            p.bandwidthMbps = bw;
+        links[key(Node(ipA).id, Node(ipB).id)] = p;
+    }
+    logger.info("已加载 RTT 矩阵 " + path + "，链路 " + to_string(links.size()));
+    return true;
+}
+
+size_t MatrixLatencyModel::size() const { return links.size(); }
+
+LinkProfile MatrixLatencyModel::link(const Node &a, const Node &b) const
+{
+    auto it = links.find(key(a.id, b.id));
+    return it != links.end() ? it->second : fallback;
+}
+
+// ==================== NetworkEmulator 实现 ====================
+
+NetworkEmulator::NetworkEmulator(const NetworkOptions &options) : options(options), rng(options.seed) {}
+
+/**
+ * @brief 按配置创建时延模型
+ * @return true 若创建成功
+ */
+bool NetworkEmulator::init()
+{
+    if (options.model == LatencyModelType::MATRIX)
+    {
+        LinkProfile fallback = {options.defaultRttMs, options.defaultBandwidthMbps};
+        unique_ptr<MatrixLatencyModel> matrix(new MatrixLatencyModel(fallback));
+        if (!matrix->load(options.matrixPath))
+            return false;
+        model = std::move(matrix);
+    }
+    else
+    {
+        model.reset(new CoordinateLatencyModel(options.seed, options.baseRttMs, options.diameterMs, options.maxAccessMs,
+                                               options.minBandwidthMbps, options.maxBandwidthMbps));
+    }
+    return true;
+}
+
+/**
+ * @brief 计算一条从 from 到 to 的消息的单程耗时：RTT/2 + 抖动 + 传输时间（报头 + 负载按链路带宽），
+ *        每次发送以 lossRate 的概率丢失，丢失时再等待一个 RTO 后重传
+ * @param from 发送方
+ * @param to 接收方，与发送方相同时视为本地调用，不计耗时
+ * @param payloadBytes 负载字节数
+ * @return double 单程耗时（毫秒）
+ */
+double NetworkEmulator::delay(const Node &from, const Node &to, size_t payloadBytes)
+{
+    if (!model || from.id == to.id)
+        return 0;
+    LinkProfile p = model->link(from, to);
+    size_t bytes = NET_HEADER_BYTES + payloadBytes;
+    double ms = p.rttMs / 2 + bytes * 8 / (p.bandwidthMbps * 1000);
+    if (options.jitterMs > 0)
+        ms += exponential_distribution<double>(1.0 / options.jitterMs)(rng);
+    if (options.lossRate > 0)
+    {
+        double rto = max(options.minRtoMs, 2 * p.rttMs);
+        uniform_real_distribution<double> coin(0, 1);
+        for (int i = 0; i < options.maxRetransmits && coin(rng) < options.lossRate; i++)
+        {
+            ms += rto;
+            stats.retransmits++;
+        }
+    }
+    stats.messages++;
+    stats.bytes += bytes;
+    return ms;
+}
+
+/**
+ * @brief 模拟一条消息并把耗时计入虚拟时钟
+ * @param from 发送方
+ * @param to 接收方
+ * @param payloadBytes 负载字节数
+ * @return double 单程耗时（毫秒）
+ */
+double NetworkEmulator::send(const Node &from, const Node &to, size_t payloadBytes)
+{
+    double ms = delay(from, to, payloadBytes);
+    clock.advance(ms);
+    stats.simulatedMs = clock.now();
+    return ms;
+}
+
+/**
+ * @brief 向多个节点同时发送互不依赖的消息（如加入时通知其他节点更新 finger 表），时钟推进最慢的一条
+ * @param from 发送方
+ * @param to 接收方列表
+ * @param payloadBytes 每条消息的负载字节数
+ * @return double 最慢一条的单程耗时（毫秒）
+ */
+double NetworkEmulator::sendParallel(const Node &from, const vector<Node> &to, size_t payloadBytes)
+{
+    double slowest = 0;
+    for (const Node &n : to)
+        slowest = max(slowest, delay(from, n, payloadBytes));
+    clock.advance(slowest);
+    stats.simulatedMs = clock.now();
+    return slowest;
+}
+
+/**
+ * @brief 模拟一条与其他在途请求重叠的消息（异步运行时），只计入统计，不推进时钟
+ * @param from 发送方
+ * @param to 接收方
+ * @param payloadBytes 负载字节数
+ * @return double 单程耗时（毫秒），由调用方累加到所属请求
+ */
+double NetworkEmulator::sendConcurrent(const Node &from, const Node &to, size_t payloadBytes)
+{
+    return delay(from, to, payloadBytes);
+}
+
+void NetworkEmulator::advanceTo(double ms)
+{
+    clock.advanceTo(ms);
+    stats.simulatedMs = clock.now();
+}
+
+double NetworkEmulator::now() const { return clock.now(); }
+const NetworkStats &NetworkEmulator::getStats() const { return stats; }
+const NetworkOptions &NetworkEmulator::getOptions() const { return options; }
+
+LinkProfile NetworkEmulator::link(const Node &a, const Node &b) const
+{
+    return model ? model->link(a, b) : LinkProfile{0, 0};
+}
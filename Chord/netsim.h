@@ -0,0 +1,141 @@
+#ifndef NETSIM_H
+#define NETSIM_H
+
+#include "node.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+// 每条消息的固定开销（报头、节点ID等），负载另计
+const size_t NET_HEADER_BYTES = 64;
+
+// 节点对之间链路的静态属性
+struct LinkProfile
+{
+    double rttMs;         // 往返时延（不含抖动）
+    double bandwidthMbps; // 链路带宽
+};
+
+// 时延模型：给出任意两个节点之间的链路属性，必须对称且对同一对节点始终返回相同结果
+class LatencyModel
+{
+public:
+    virtual ~LatencyModel() {}
+    virtual LinkProfile link(const Node &a, const Node &b) const = 0;
+};
+
+// 合成坐标模型：每个节点由 (ID, seed) 确定一个单位平面上的坐标和接入时延（类似 Vivaldi 的高度），
+// RTT = baseRttMs + diameterMs·欧氏距离 + 两端接入时延；每个节点的接入带宽在 [min, max] 上对数均匀分布，链路取两端较小者
+class CoordinateLatencyModel : public LatencyModel
+{
+private:
+    uint64_t seed;
+    double baseRttMs;
+    double diameterMs;
+    double maxAccessMs;
+    double minBandwidthMbps;
+    double maxBandwidthMbps;
+
+public:
+    CoordinateLatencyModel(uint64_t seed, double baseRttMs, double diameterMs, double maxAccessMs,
+                           double minBandwidthMbps, double maxBandwidthMbps);
+    LinkProfile link(const Node &a, const Node &b) const override;
+};
+
+// 矩阵模型：从文件加载实测的节点对 RTT，每行 "<ipA> <ipB> <rtt_ms> [bandwidth_mbps]"，# 开头为注释；
+// 链路对称，文件中没有的节点对使用默认值
+class MatrixLatencyModel : public LatencyModel
+{
+private:
+    std::unordered_map<uint64_t, LinkProfile> links; // 键为 (较小ID << 32) | 较大ID
+    LinkProfile fallback;
+
+    static uint64_t key(uint32_t a, uint32_t b);
+
+public:
+    explicit MatrixLatencyModel(const LinkProfile &fallback);
+    bool load(const std::string &path);
+    size_t size() const;
+    LinkProfile link(const Node &a, const Node &b) const override;
+};
+
+// 时延模型类型
+enum class LatencyModelType
+{
+    COORDINATES,
+    MATRIX
+};
+
+// 网络模拟配置
+struct NetworkOptions
+{
+    LatencyModelType model = LatencyModelType::COORDINATES;
+    std::string matrixPath;        // MATRIX 模型的 RTT 文件
+    uint64_t seed = 1;             // 坐标与抖动、丢包的随机种子
+    double baseRttMs = 1;          // 坐标模型：最小 RTT
+    double diameterMs = 150;       // 坐标模型：单位距离对应的 RTT
+    double maxAccessMs = 10;       // 坐标模型：每个节点的接入时延上限
+    double minBandwidthMbps = 10;  // 坐标模型：节点接入带宽下限
+    double maxBandwidthMbps = 1000; // 坐标模型：节点接入带宽上限
+    double defaultRttMs = 50;      // 矩阵模型：文件中没有的节点对
+    double defaultBandwidthMbps = 100;
+    double jitterMs = 0;           // 每条消息附加的指数分布抖动的均值
+    double lossRate = 0;           // 每次发送的丢失概率，丢失后等待 RTO 重传
+    double minRtoMs = 200;         // 重传超时下限，实际取 max(minRtoMs, 2·RTT)
+    int maxRetransmits = 8;        // 单条消息的重传上限，超过后按送达处理
+};
+
+// 累计网络统计
+struct NetworkStats
+{
+    uint64_t messages = 0;
+    uint64_t bytes = 0;
+    uint64_t retransmits = 0;
+    double simulatedMs = 0; // 虚拟时钟当前时间
+};
+
+// 虚拟时钟：只随模拟的消息推进，与墙钟无关，模拟比实时更快
+class VirtualClock
+{
+private:
+    double nowMs = 0;
+
+public:
+    double now() const { return nowMs; }
+    void advance(double ms) { nowMs += ms; }
+    void advanceTo(double ms) { nowMs = ms > nowMs ? ms : nowMs; } // 不回退
+};
+
+// 网络模拟器：由代理在节点之间每发送一条消息时调用，按时延模型、带宽、抖动与丢包计算单程耗时并推进虚拟时钟。
+// 操作在管理器中同步执行，一次操作的模拟耗时即前后两次 now() 之差。
+// 异步运行时的请求互相重叠：每条消息经 sendConcurrent 只计入所属请求自己的耗时，每轮结束时由 advanceTo 把时钟推进到本轮最晚的请求。
+// 不加锁，同一时刻只能由一个线程使用：管理器所在线程，或请求在途期间的异步运行时工作线程（此时调用方不能调用管理器，见 ChordAsyncRuntime）。
+class NetworkEmulator
+{
+private:
+    NetworkOptions options;
+    std::unique_ptr<LatencyModel> model;
+    VirtualClock clock;
+    std::mt19937_64 rng;
+    NetworkStats stats;
+
+    double delay(const Node &from, const Node &to, size_t payloadBytes); // 计算单程耗时并更新统计，不推进时钟
+
+public:
+    explicit NetworkEmulator(const NetworkOptions &options);
+    bool init(); // 创建时延模型（MATRIX 时加载文件），失败返回 false
+    double send(const Node &from, const Node &to, size_t payloadBytes = 0); // 返回单程耗时（毫秒）
+    double sendParallel(const Node &from, const std::vector<Node> &to, size_t payloadBytes = 0); // 并发发送，时钟只推进最慢的一条
+    double sendConcurrent(const Node &from, const Node &to, size_t payloadBytes = 0); // 计入统计、返回单程耗时，不推进时钟
+    void advanceTo(double ms); // 时钟推进到 ms，早于当前时间时不变
+    double now() const;
+    const NetworkStats &getStats() const;
+    const NetworkOptions &getOptions() const;
+    LinkProfile link(const Node &a, const Node &b) const;
+};
+
+#endif // NETSIM_H
@@ -5,16 +5,76 @@
 
 using namespace std;
 
-Node::Node() : id(0), ip("") {}
+// ==================== NodeRegistry 实现 ====================
 
-Node::Node(string ip) : ip(ip)
+NodeRegistry &NodeRegistry::instance()
 {
-    uint32_t hash = sha1_hash_to_uint32(ip);
-    this->id = hash % ID_SPACE;
+    static NodeRegistry registry;
+    return registry;
+}
+
+/**
+ * @brief 查找 IP 对应的驻留记录，不存在时创建
+ * @param ip 节点IP
+ * @return const NodeRecord* 驻留记录，地址在进程生命周期内有效
+ */
+const NodeRecord *NodeRegistry::intern(const string &ip)
+{
+    {
+        lock_guard<mutex> lock(mtx);
+        auto it = byIp.find(ip);
+        if (it != byIp.end())
+            return it->second;
+    }
+
+    // SHA-1 在锁外计算，多个线程同时驻留不同 IP 时只在插入时互斥
+    uint32_t id = sha1_hash_to_uint32(ip) % ID_SPACE;
+    lock_guard<mutex> lock(mtx);
+    auto it = byIp.find(ip);
+    if (it != byIp.end())
+        return it->second;
+    records.push_back(NodeRecord{id, ip});
+    const NodeRecord *record = &records.back();
+    byIp.emplace(ip, record);
+    return record;
+}
+
+/**
+ * @brief 查找 IP 对应的驻留记录
+ * @param ip 节点IP
+ * @return const NodeRecord* 驻留记录，IP 从未出现过时返回 nullptr
+ */
+const NodeRecord *NodeRegistry::find(const string &ip) const
+{
+    lock_guard<mutex> lock(mtx);
+    auto it = byIp.find(ip);
+    return it == byIp.end() ? nullptr : it->second;
+}
+
+size_t NodeRegistry::size() const
+{
+    lock_guard<mutex> lock(mtx);
+    return records.size();
+}
+
+// ==================== Node 实现 ====================
+
+Node::Node() : id(0), record(nullptr) {}
+
+Node::Node(const string &ip) : record(NodeRegistry::instance().intern(ip)) { id = record->id; }
+
+Node::Node(uint32_t id, const string &ip) : id(id), record(ip.empty() ? nullptr : NodeRegistry::instance().intern(ip)) {}
+
+Node::Node(const NodeRecord *record) : id(record ? record->id : 0), record(record) {}
+
+const string &Node::ip() const
+{
+    static const string empty;
+    return record ? record->ip : empty;
 }
 
 bool Node::operator==(const Node &other) const { return id == other.id; }
 bool Node::operator!=(const Node &other) const { return !(*this == other); }
 bool Node::operator<(const Node &other) const { return id < other.id; }
-bool Node::isEmpty() const { return ip.empty() && id == 0; }
-string Node::toString() const { return "Node(ID: " + to_string(id) + " ,IP: " + ip + " )"; }
\ No newline at end of file
+bool Node::isEmpty() const { return record == nullptr && id == 0; }
+string Node::toString() const { return "Node(ID: " + to_string(id) + " ,IP: " + ip() + " )"; }
\ No newline at end of file
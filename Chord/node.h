@@ -3,14 +3,44 @@
 
 #include <string>
 #include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
 
+// 驻留的节点记录：同一个 IP 在进程内只保存一份，创建后不再修改，地址在进程生命周期内保持不变
+struct NodeRecord
+{
+    uint32_t id; // IP 哈希得到的节点ID
+    std::string ip;
+};
+
+// 节点注册表：IP → 记录的哈希索引，所有 Node 共享其中的记录，复制 Node 不再复制 IP 字符串
+// 记录只增不删（离开的节点以后可能重新加入），intern/find 加锁，可被多个线程同时调用（SHA-1 在锁外计算）
+class NodeRegistry
+{
+private:
+    mutable std::mutex mtx;
+    std::deque<NodeRecord> records; // deque 追加元素不移动已有元素，记录指针始终有效
+    std::unordered_map<std::string, const NodeRecord *> byIp;
+
+public:
+    static NodeRegistry &instance();
+    const NodeRecord *intern(const std::string &ip); // 查找或创建记录，首次创建时计算 SHA-1 ID
+    const NodeRecord *find(const std::string &ip) const; // 未驻留过时返回 nullptr
+    size_t size() const;
+};
+
+// 节点句柄：ID + 指向驻留记录的指针，可按值廉价传递
 struct Node
 {
     uint32_t id;
-    std::string ip;
+    const NodeRecord *record; // 空节点或只知道ID的节点为 nullptr
 
     Node();
-    explicit Node(std::string ip);
+    explicit Node(const std::string &ip);
+    Node(uint32_t id, const std::string &ip); // 已知ID时直接构造（如从快照恢复），不重新哈希
+    explicit Node(const NodeRecord *record);
+    const std::string &ip() const;
     bool operator==(const Node &other) const;
     bool operator!=(const Node &other) const;
     bool operator<(const Node &other) const;
@@ -18,10 +48,4 @@ struct Node
     std::string toString() const;
 };
 
-struct FingerEntry
-{
-    uint32_t startId;
-    Node node;
-};
-
 #endif // NODE_H
\ No newline at end of file
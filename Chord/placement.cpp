@@ -0,0 +1,97 @@
+#include "placement.h"
+#include "config.h"
+#include "SHA_1.h"
+
+using namespace std;
+
+namespace
+{
+    // 取 key 从 offset 开始的 8 个字节作为大端定点小数 0.b0b1...b7，不足部分补 0
+    uint64_t fractionAt(const string &key, size_t offset)
+    {
+        uint64_t v = 0;
+        for (size_t i = 0; i < 8; i++)
+        {
+            size_t pos = offset + i;
+            uint8_t b = pos < key.size() ? static_cast<uint8_t>(key[pos]) : 0;
+            v = (v << 8) | b;
+        }
+        return v;
+    }
+}
+
+/**
+ * @brief 哈希放置：SHA-1 后取 m 位
+ * @param key 资源名称
+ * @return uint32_t 资源ID
+ */
+uint32_t hashedKeyId(const string &key)
+{
+    return sha1_hash_to_uint32(key) % ID_SPACE;
+}
+
+/**
+ * @brief 保序放置：去掉键域上下界的公共前缀后，把其后 8 个字节视为 [0,1) 内的小数，
+ *        在 [lowKey, highKey) 上线性插值到 [0, ID_SPACE)。映射单调不减，字典序相邻的键落在相邻的节点上；
+ *        映射到同一ID的键与哈希冲突一样视为同一资源
+ * @param key 资源名称
+ * @param options 放置配置
+ * @return uint32_t 资源ID
+ */
+uint32_t orderPreservingKeyId(const string &key, const PlacementOptions &options)
+{
+    const string &low = options.lowKey, &high = options.highKey;
+    if (key <= low)
+        return 0;
+    if (!high.empty() && key >= high)
+        return ID_SPACE - 1;
+
+    // 落在 [low, high) 内的键必然与上下界共享它们的公共前缀
+    size_t common = 0;
+    if (!high.empty())
+    {
+        while (common < low.size() && common < high.size() && low[common] == high[common])
+            common++;
+    }
+    long double lo = static_cast<long double>(fractionAt(low, common));
+    long double hi = high.empty() ? 18446744073709551616.0L : static_cast<long double>(fractionAt(high, common));
+    long double x = static_cast<long double>(fractionAt(key, common));
+    if (hi <= lo || x <= lo)
+        return 0;
+    long double scaled = (x - lo) / (hi - lo) * ID_SPACE;
+    if (scaled >= ID_SPACE - 1)
+        return ID_SPACE - 1;
+    return static_cast<uint32_t>(scaled);
+}
+
+/**
+ * @brief 按放置配置计算资源ID
+ * @param key 资源名称
+ * @param options 放置配置
+ * @return uint32_t 资源ID
+ */
+uint32_t placeKey(const string &key, const PlacementOptions &options)
+{
+    return options.mode == PlacementMode::ORDER_PRESERVING ? orderPreservingKeyId(key, options) : hashedKeyId(key);
+}
+
+/**
+ * @brief 计算前缀查询的右开上界：以 prefix 开头的键都满足 prefix <= key < 上界
+ * @param prefix 前缀
+ * @return string 上界，为空表示无上界（前缀全部为 0xFF 或为空）
+ */
+string prefixUpperBound(const string &prefix)
+{
+    string upper = prefix;
+    while (!upper.empty())
+    {
+        unsigned char last = static_cast<unsigned char>(upper.back());
+        if (last != 0xFF)
+        {
+            upper.back() = static_cast<char>(last + 1);
+            return upper;
+        }
+        upper.pop_back();
+    }
+    return upper;
+}
@@ -0,0 +1,27 @@
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+#include <string>
+#include <cstdint>
+
+// 资源在环上的放置方式
+enum class PlacementMode
+{
+    HASHED,          // SHA-1 哈希（默认），负载均匀但无法范围查询
+    ORDER_PRESERVING // 保序映射，键的字典序与环上ID顺序一致，支持范围/前缀查询
+};
+
+// 放置配置：保序模式下把键域 [lowKey, highKey) 线性映射到 [0, ID_SPACE)
+struct PlacementOptions
+{
+    PlacementMode mode = PlacementMode::HASHED;
+    std::string lowKey;  // 键域下界，小于等于它的键映射到 0
+    std::string highKey; // 键域上界，大于等于它的键映射到 ID_SPACE-1；为空表示不设上界
+};
+
+uint32_t hashedKeyId(const std::string &key);
+uint32_t orderPreservingKeyId(const std::string &key, const PlacementOptions &options);
+uint32_t placeKey(const std::string &key, const PlacementOptions &options);
+std::string prefixUpperBound(const std::string &prefix);
+
+#endif // PLACEMENT_H
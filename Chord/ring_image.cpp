@@ -0,0 +1,526 @@
+#include "ring_image.h"
+#include "chord.h"
+#include "logger.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+/*
+镜像布局：RingImageHeader | 各数据段（见 RingImageSection，按 8 字节对齐）
+节点按 ID 升序排列，前驱/后继/finger 都存节点下标，查找时对 SEC_NODE_IDS 二分即可定位负责节点，
+再对该节点在 SEC_KEY_IDS 中的区间二分定位资源。打开镜像只做 mmap 和 O(1) 的结构校验，内容校验（下标、偏移）
+按需调用 contentsValid；lookup 逐次核对所用的区间与偏移，未做内容校验时也不会越界。
+之后的查找直接落在映射内存上，不做反序列化。
+ChordRingManager::loadRingImage 则把整个镜像重建为可修改的环（逐个创建节点并复制资源），代价 O(N·m + K)，
+与镜像大小成正比；只读查询应直接使用映射，不必载入
+*/
+
+namespace
+{
+    const char RING_IMAGE_MAGIC[4] = {'C', 'H', 'R', 'I'};
+    const uint32_t RING_IMAGE_ENDIAN_TAG = 0x01020304u;
+
+    uint64_t alignUp(uint64_t v) { return (v + 7) & ~static_cast<uint64_t>(7); }
+
+    // 数据段写完后补零到 8 字节对齐
+    void writePadding(FILE *f, uint64_t written)
+    {
+        static const char zeros[8] = {0};
+        size_t pad = alignUp(written) - written;
+        if (pad)
+            fwrite(zeros, 1, pad, f);
+    }
+
+    // 写入整段数据并补齐到 8 字节对齐
+    void writePadded(FILE *f, const void *data, size_t len)
+    {
+        if (len)
+            fwrite(data, 1, len, f);
+        writePadding(f, len);
+    }
+
+    bool syncFile(FILE *f)
+    {
+        if (fflush(f) != 0)
+            return false;
+#ifdef _WIN32
+        return _commit(_fileno(f)) == 0;
+#else
+        return fsync(fileno(f)) == 0;
+#endif
+    }
+
+    // rename 后的目录项落盘，镜像才在崩溃后仍可见（Windows 没有对应的接口，视为成功）
+    bool syncDir(const string &filePath)
+    {
+#ifdef _WIN32
+        (void)filePath;
+        return true;
+#else
+        size_t slash = filePath.find_last_of('/');
+        string dir = slash == string::npos ? string(".") : slash == 0 ? string("/") : filePath.substr(0, slash);
+        int fd = ::open(dir.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        bool ok = fsync(fd) == 0;
+        ::close(fd);
+        return ok;
+#endif
+    }
+
+    uint32_t indexOf(const vector<uint32_t> &ids, uint32_t id)
+    {
+        auto it = lower_bound(ids.begin(), ids.end(), id);
+        if (it == ids.end() || *it != id)
+            return RING_IMAGE_NO_NODE;
+        return static_cast<uint32_t>(it - ids.begin());
+    }
+
+    uint32_t indexOf(const vector<uint32_t> &ids, const Node &n)
+    {
+        return n.isEmpty() ? RING_IMAGE_NO_NODE : indexOf(ids, n.id);
+    }
+}
+
+RingImage::RingImage() : base(nullptr), size(0), header(nullptr), contentsChecked(false)
+{
+#ifdef _WIN32
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+#endif
+}
+
+RingImage::~RingImage() { close(); }
+
+/**
+ * @brief 将整个环写成二进制镜像，带 TTL 的资源连同到期时刻写入 SEC_DEADLINES；
+ *        先写临时文件并 fsync，rename 后 fsync 所在目录，中途崩溃时旧镜像保持完整
+ * @param manager 环管理器
+ * @param path 镜像文件路径
+ * @return true 若写入成功
+ * @return false 若无法写入、落盘或替换文件
+ */
+bool RingImage::write(const ChordRingManager &manager, const string &path)
+{
+    map<uint32_t, Chord *> nodes = manager.getAllChordNodes();
+    vector<uint32_t> ids;
+    ids.reserve(nodes.size());
+    for (auto &p : nodes)
+        ids.push_back(p.first);
+
+    uint64_t n = ids.size(), keyCount = 0, ipBytes = 0, valueBytes = 0;
+    vector<RingImageDeadline> deadlines;
+    for (auto &p : nodes)
+    {
+        ipBytes += p.second->getSelf().ip().size();
+        bool timed = !p.second->getDeadlines().empty();
+        for (auto &res : p.second->getResourceMap())
+        {
+            uint64_t deadlineMs = timed ? p.second->getDeadline(res.first) : 0;
+            if (deadlineMs)
+                deadlines.push_back(RingImageDeadline{keyCount, deadlineMs});
+            valueBytes += res.second.size();
+            keyCount++;
+        }
+    }
+
+    RingImageHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, RING_IMAGE_MAGIC, 4);
+    header.version = RING_IMAGE_VERSION;
+    header.endianTag = RING_IMAGE_ENDIAN_TAG;
+    header.m = m;
+    const PlacementOptions &placement = manager.getPlacement();
+    header.placementMode = static_cast<uint32_t>(placement.mode);
+    header.placementLowBytes = static_cast<uint32_t>(placement.lowKey.size());
+    header.placementHighBytes = static_cast<uint32_t>(placement.highKey.size());
+    header.nodeCount = n;
+    header.keyCount = keyCount;
+    header.deadlineCount = deadlines.size();
+    uint64_t sizes[RING_IMAGE_SECTIONS] = {
+        n * 4, n * 4, n * 4, n * m * 4,
+        (n + 1) * 8, ipBytes,
+        (n + 1) * 8, keyCount * 4, (keyCount + 1) * 8, valueBytes,
+        deadlines.size() * sizeof(RingImageDeadline),
+        static_cast<uint64_t>(placement.lowKey.size()) + placement.highKey.size()};
+    uint64_t offset = alignUp(sizeof(RingImageHeader));
+    for (int s = 0; s < RING_IMAGE_SECTIONS; s++)
+    {
+        header.offsets[s] = offset;
+        offset += alignUp(sizes[s]);
+    }
+    header.fileSize = offset;
+
+    string tmp = path + ".tmp";
+    FILE *f = fopen(tmp.c_str(), "wb");
+    if (!f)
+    {
+        logger.error("无法写入环镜像：" + tmp);
+        return false;
+    }
+    setvbuf(f, nullptr, _IOFBF, 1 << 20);
+    writePadded(f, &header, sizeof(header));
+
+    vector<uint32_t> u32s;
+    vector<uint64_t> u64s;
+    writePadded(f, ids.data(), ids.size() * 4);
+
+    for (auto &p : nodes)
+        u32s.push_back(indexOf(ids, p.second->getPredecessor()));
+    writePadded(f, u32s.data(), u32s.size() * 4);
+
+    u32s.clear();
+    for (auto &p : nodes)
+        u32s.push_back(indexOf(ids, p.second->getSuccessor()));
+    writePadded(f, u32s.data(), u32s.size() * 4);
+
+    u32s.clear();
+    for (auto &p : nodes)
+    {
+        for (int i = 0; i < m; i++)
+            u32s.push_back(indexOf(ids, p.second->getFingerId(i)));
+    }
+    writePadded(f, u32s.data(), u32s.size() * 4);
+
+    u64s.assign(1, 0);
+    for (auto &p : nodes)
+        u64s.push_back(u64s.back() + p.second->getSelf().ip().size());
+    writePadded(f, u64s.data(), u64s.size() * 8);
+    size_t written = 0;
+    for (auto &p : nodes)
+    {
+        const string &ip = p.second->getSelf().ip();
+        fwrite(ip.data(), 1, ip.size(), f);
+        written += ip.size();
+    }
+    writePadding(f, written);
+
+    u64s.assign(1, 0);
+    for (auto &p : nodes)
+        u64s.push_back(u64s.back() + p.second->getResourceCount());
+    writePadded(f, u64s.data(), u64s.size() * 8);
+
+    u32s.clear();
+    for (auto &p : nodes)
+        for (auto &res : p.second->getResourceMap())
+            u32s.push_back(res.first);
+    writePadded(f, u32s.data(), u32s.size() * 4);
+
+    u64s.assign(1, 0);
+    for (auto &p : nodes)
+        for (auto &res : p.second->getResourceMap())
+            u64s.push_back(u64s.back() + res.second.size());
+    writePadded(f, u64s.data(), u64s.size() * 8);
+
+    written = 0;
+    for (auto &p : nodes)
+    {
+        for (auto &res : p.second->getResourceMap())
+        {
+            fwrite(res.second.data(), 1, res.second.size(), f);
+            written += res.second.size();
+        }
+    }
+    writePadding(f, written);
+
+    writePadded(f, deadlines.data(), deadlines.size() * sizeof(RingImageDeadline));
+
+    string placementKeys = placement.lowKey + placement.highKey;
+    writePadded(f, placementKeys.data(), placementKeys.size());
+
+    bool ok = ferror(f) == 0 && syncFile(f);
+    ok = fclose(f) == 0 && ok;
+    if (!ok)
+    {
+        logger.error("写入环镜像失败：" + tmp);
+        remove(tmp.c_str());
+        return false;
+    }
+#ifdef _WIN32
+    remove(path.c_str());
+#endif
+    if (rename(tmp.c_str(), path.c_str()) != 0 || !syncDir(path))
+    {
+        logger.error("无法替换环镜像：" + path);
+        remove(tmp.c_str());
+        return false;
+    }
+    logger.info("环镜像已写入 " + path + ": 节点 " + to_string(n) + ", 资源 " + to_string(keyCount) +
+                ", 带 TTL " + to_string(deadlines.size()));
+    return true;
+}
+
+/**
+ * @brief 以只读方式 mmap 镜像文件并校验
+ * @param path 镜像文件路径
+ * @param checkContents 是否同时校验全部下标与偏移（O(N·m + K)，逐段顺序读一遍）；
+ *        默认只做 O(1) 的结构校验，lookup 仍可安全使用，loadRingImage 之前会补做完整校验
+ * @return true 若映射成功且校验通过
+ * @return false 若文件不存在、映射失败、版本不符或内容越界
+ */
+bool RingImage::open(const string &path, bool checkContents)
+{
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(file, &fileSize);
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping)
+    {
+        CloseHandle(file);
+        return false;
+    }
+    void *addr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!addr)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle = file;
+    mappingHandle = mapping;
+    size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(RingImageHeader)))
+    {
+        ::close(fd);
+        return false;
+    }
+    void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+        return false;
+    size = st.st_size;
+#endif
+    base = static_cast<const char *>(addr);
+    header = reinterpret_cast<const RingImageHeader *>(base);
+    if (!validate() || (checkContents && !contentsValid()))
+    {
+        logger.error("环镜像格式无效：" + path);
+        close();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 解除映射
+ */
+void RingImage::close()
+{
+    if (!base)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(base);
+    CloseHandle(static_cast<HANDLE>(mappingHandle));
+    CloseHandle(static_cast<HANDLE>(fileHandle));
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+#else
+    munmap(const_cast<char *>(base), size);
+#endif
+    base = nullptr;
+    header = nullptr;
+    size = 0;
+    contentsChecked = false;
+}
+
+/**
+ * @brief 校验文件头与各数据段的边界（O(1)，不扫描数据）
+ */
+bool RingImage::validate() const
+{
+    if (size < sizeof(RingImageHeader) || memcmp(header->magic, RING_IMAGE_MAGIC, 4) != 0)
+        return false;
+    if (header->version != RING_IMAGE_VERSION || header->endianTag != RING_IMAGE_ENDIAN_TAG)
+        return false;
+    if (header->m != static_cast<uint32_t>(m) || header->fileSize != size)
+        return false;
+    uint64_t n = header->nodeCount, k = header->keyCount, d = header->deadlineCount;
+    // 每个节点、资源至少占 4 字节，先按文件大小限住数量，之后的段大小计算不会溢出
+    if (n > size / 4 || k > size / 4 || d > k || header->placementMode > static_cast<uint32_t>(PlacementMode::ORDER_PRESERVING))
+        return false;
+    uint64_t minSizes[RING_IMAGE_SECTIONS] = {n * 4, n * 4, n * 4, n * header->m * 4, (n + 1) * 8, 0, (n + 1) * 8, k * 4, (k + 1) * 8, 0,
+                                              d * sizeof(RingImageDeadline),
+                                              static_cast<uint64_t>(header->placementLowBytes) + header->placementHighBytes};
+    for (int s = 0; s < RING_IMAGE_SECTIONS; s++)
+    {
+        uint64_t off = header->offsets[s];
+        if (off % 8 != 0 || off > size || size - off < minSizes[s])
+            return false;
+    }
+    if (section<uint64_t>(SEC_KEY_STARTS)[n] != k)
+        return false;
+    if (section<uint64_t>(SEC_IP_OFFSETS)[n] > size - header->offsets[SEC_IP_BYTES])
+        return false;
+    if (section<uint64_t>(SEC_VALUE_OFFSETS)[k] > size - header->offsets[SEC_VALUE_BYTES])
+        return false;
+    return true;
+}
+
+/**
+ * @brief 校验全部内容：节点ID严格升序且在ID空间内，前驱/后继/finger 下标小于 N（或为空），
+ *        KEY_STARTS 与 IP/资源内容偏移从 0 开始单调不减且不越过所在的段，节点内资源ID严格升序，
+ *        到期表的资源下标严格升序。通过后各访问函数在映射内存上不会越界
+ * @return true 若内容有效
+ */
+bool RingImage::contentsValid() const
+{
+    if (!header)
+        return false;
+    if (contentsChecked)
+        return true;
+    uint64_t n = header->nodeCount, k = header->keyCount, d = header->deadlineCount;
+    const uint32_t *ids = section<uint32_t>(SEC_NODE_IDS);
+    for (uint64_t i = 0; i < n; i++)
+    {
+        if (ids[i] >= ID_SPACE || (i > 0 && ids[i] <= ids[i - 1]))
+            return false;
+    }
+    auto indexValid = [n](uint32_t idx)
+    { return idx == RING_IMAGE_NO_NODE || idx < n; };
+    const uint32_t *preds = section<uint32_t>(SEC_PREDECESSORS), *succs = section<uint32_t>(SEC_SUCCESSORS);
+    const uint32_t *fingers = section<uint32_t>(SEC_FINGERS);
+    for (uint64_t i = 0; i < n; i++)
+    {
+        if (!indexValid(preds[i]) || !indexValid(succs[i]))
+            return false;
+    }
+    for (uint64_t i = 0; i < n * header->m; i++)
+    {
+        if (!indexValid(fingers[i]))
+            return false;
+    }
+
+    // 偏移数组：从 0 开始单调不减，末项不越过数据段所在的文件范围
+    auto offsetsValid = [this](RingImageSection sec, uint64_t count, uint64_t limit)
+    {
+        const uint64_t *offs = section<uint64_t>(sec);
+        if (offs[0] != 0 || offs[count] > limit)
+            return false;
+        for (uint64_t i = 0; i < count; i++)
+        {
+            if (offs[i + 1] < offs[i])
+                return false;
+        }
+        return true;
+    };
+    if (!offsetsValid(SEC_IP_OFFSETS, n, size - header->offsets[SEC_IP_BYTES]) ||
+        !offsetsValid(SEC_KEY_STARTS, n, k) ||
+        !offsetsValid(SEC_VALUE_OFFSETS, k, size - header->offsets[SEC_VALUE_BYTES]))
+        return false;
+
+    const uint32_t *keys = section<uint32_t>(SEC_KEY_IDS);
+    for (uint64_t i = 0; i < n; i++)
+    {
+        for (uint64_t key = keyBegin(i) + 1; key < keyEnd(i); key++)
+        {
+            if (keys[key] <= keys[key - 1])
+                return false;
+        }
+    }
+    for (uint64_t t = 0; t < d; t++)
+    {
+        const RingImageDeadline &entry = deadline(t);
+        if (entry.keyIndex >= k || (t > 0 && entry.keyIndex <= deadline(t - 1).keyIndex))
+            return false;
+    }
+    contentsChecked = true;
+    return true;
+}
+
+/**
+ * @brief 写镜像时环的放置方式，资源ID由它计算
+ */
+PlacementOptions RingImage::placement() const
+{
+    PlacementOptions options;
+    options.mode = static_cast<PlacementMode>(header->placementMode);
+    const char *keys = section<char>(SEC_PLACEMENT_KEYS);
+    options.lowKey.assign(keys, header->placementLowBytes);
+    options.highKey.assign(keys + header->placementLowBytes, header->placementHighBytes);
+    return options;
+}
+
+string RingImage::nodeIp(size_t i) const
+{
+    const uint64_t *offs = section<uint64_t>(SEC_IP_OFFSETS);
+    return string(section<char>(SEC_IP_BYTES) + offs[i], offs[i + 1] - offs[i]);
+}
+
+const char *RingImage::valueData(size_t k) const
+{
+    return section<char>(SEC_VALUE_BYTES) + section<uint64_t>(SEC_VALUE_OFFSETS)[k];
+}
+
+size_t RingImage::valueSize(size_t k) const
+{
+    const uint64_t *offs = section<uint64_t>(SEC_VALUE_OFFSETS);
+    return offs[k + 1] - offs[k];
+}
+
+/**
+ * @brief 在镜像上二分查找负责 id 的节点（第一个 ID >= id 的节点，越过末尾则回到第一个）
+ * @param id 目标ID
+ * @return size_t 节点下标，镜像为空时返回 RING_IMAGE_NO_NODE
+ */
+size_t RingImage::findSuccessorIndex(uint32_t id) const
+{
+    size_t n = nodeCount();
+    if (n == 0)
+        return RING_IMAGE_NO_NODE;
+    const uint32_t *ids = section<uint32_t>(SEC_NODE_IDS);
+    size_t idx = lower_bound(ids, ids + n, id) - ids;
+    return idx == n ? 0 : idx;
+}
+
+/**
+ * @brief 直接在镜像上查找资源，未做内容校验的镜像上也不会越界（内容损坏时可能查不到）
+ * @param rid 资源ID
+ * @param nodeIndex 输出负责节点下标
+ * @param value 若非空则输出资源内容
+ * @return true 若资源存在
+ */
+bool RingImage::lookup(uint32_t rid, size_t &nodeIndex, string *value) const
+{
+    nodeIndex = findSuccessorIndex(rid);
+    if (nodeIndex == RING_IMAGE_NO_NODE)
+        return false;
+    // validate 只检查过偏移数组的末项，这里逐个核对用到的区间与偏移
+    size_t begin = keyBegin(nodeIndex), end = keyEnd(nodeIndex);
+    if (begin > end || end > header->keyCount)
+        return false;
+    const uint32_t *keys = section<uint32_t>(SEC_KEY_IDS);
+    const uint32_t *it = lower_bound(keys + begin, keys + end, rid);
+    if (it == keys + end || *it != rid)
+        return false;
+    if (value)
+    {
+        size_t k = it - keys;
+        const uint64_t *offs = section<uint64_t>(SEC_VALUE_OFFSETS);
+        if (offs[k] > offs[k + 1] || offs[k + 1] > offs[header->keyCount])
+            return false;
+        value->assign(valueData(k), valueSize(k));
+    }
+    return true;
+}
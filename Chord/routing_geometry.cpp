@@ -0,0 +1,367 @@
+#include "routing_geometry.h"
+#include "finger_simd.h"
+#include "config.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+using namespace std;
+
+namespace
+{
+    // splitmix64，把种子、节点ID与桶号混合成互不相关的随机数种子
+    uint64_t mix(uint64_t x)
+    {
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    // 以 splitmix64 为输出函数的计数器发生器，构造代价为零，每个节点每个桶各用一个
+    class SplitMix
+    {
+    private:
+        uint64_t state;
+
+    public:
+        explicit SplitMix(uint64_t seed) : state(seed) {}
+        uint64_t next() { return mix(state++); }
+        double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); } // [0, 1)
+    };
+
+    // x 的二进制位数（x = 0 时为 0）
+    int bitLength(uint32_t x)
+    {
+#if defined(__GNUC__)
+        return x ? 32 - __builtin_clz(x) : 0;
+#else
+        int bits = 0;
+        while (x >> bits)
+            bits++;
+        return bits;
+#endif
+    }
+
+    bool isMember(const vector<uint32_t> &ids, uint32_t id) { return binary_search(ids.begin(), ids.end(), id); }
+
+    // 按自身起的顺时针距离升序排列
+    void sortClockwise(vector<uint32_t> &links, uint32_t self)
+    {
+        sort(links.begin(), links.end(), [self](uint32_t a, uint32_t b)
+             { return ((a - self) & (ID_SPACE - 1)) < ((b - self) & (ID_SPACE - 1)); });
+    }
+
+    // 链接落在哪个 Kademlia 桶：与自身首个不同的位（XOR 距离的最高位）
+    int bucketOf(uint32_t self, uint32_t id) { return bitLength(self ^ id) - 1; }
+
+    // 有序成员中 id 的后继下标（含 id 自身），越过最大ID时回到 0
+    size_t successorIndex(const vector<uint32_t> &ids, uint32_t id)
+    {
+        size_t j = lower_bound(ids.begin(), ids.end(), id) - ids.begin();
+        return j == ids.size() ? 0 : j;
+    }
+
+    // 最接近前驱：条件与 finger_simd 相同，取满足条件的最大下标（表按顺时针距离升序时即最接近 target 者）
+    uint32_t closestPreceding(const uint32_t *table, size_t count, uint32_t self, uint32_t target)
+    {
+        int idx = closestPrecedingIndex(table, static_cast<int>(count), self, target, ID_SPACE - 1);
+        return idx < 0 ? self : table[idx];
+    }
+}
+
+void RoutingGeometry::linkLeft(uint32_t self, uint32_t successor, vector<uint32_t> &links, uint32_t left,
+                               uint32_t successorId) const
+{
+    (void)self, (void)successor, (void)successorId;
+    links.erase(remove(links.begin(), links.end(), left), links.end());
+}
+
+uint32_t ChordFingerGeometry::nextHop(const uint32_t *table, size_t count, uint32_t self, uint32_t target) const
+{
+    return closestPreceding(table, count, self, target);
+}
+
+// ==================== Kademlia ====================
+
+KademliaGeometry::KademliaGeometry(size_t bucketSize, uint64_t seed) : bucketSize(max<size_t>(1, bucketSize)), seed(seed) {}
+
+/**
+ * @brief 桶 b 对应与自身在第 b 位首次不同的子树 [lo, lo + 2^b)，这是一段连续的ID区间。
+ *        区间内节点不超过 bucketSize 时全部保存；否则先保留仍在环中的旧链接，再随机补足（Kademlia 偏好长期在线的节点）
+ * @param ids 有序成员
+ * @param i 节点在 ids 中的下标
+ * @param previous 节点现有的链接
+ * @param out 输出链接
+ */
+void KademliaGeometry::buildLinks(const vector<uint32_t> &ids, size_t i, const vector<uint32_t> &previous,
+                                  vector<uint32_t> &out) const
+{
+    uint32_t self = ids[i];
+    vector<uint32_t> kept(previous);
+    sort(kept.begin(), kept.end());
+    for (int b = 0; b < m; b++)
+    {
+        uint32_t lo = ((self ^ (1u << b)) >> b) << b;
+        uint64_t hi = static_cast<uint64_t>(lo) + (1u << b);
+        size_t first = lower_bound(ids.begin(), ids.end(), lo) - ids.begin();
+        size_t last = hi >= ID_SPACE ? ids.size() : lower_bound(ids.begin(), ids.end(), static_cast<uint32_t>(hi)) - ids.begin();
+        size_t count = last - first;
+        if (count == 0)
+            continue;
+        if (count <= bucketSize)
+        {
+            out.insert(out.end(), ids.begin() + first, ids.begin() + last);
+            continue;
+        }
+        size_t begin = out.size();
+        for (auto it = lower_bound(kept.begin(), kept.end(), lo); it != kept.end() && *it < hi; ++it)
+        {
+            if (out.size() - begin >= bucketSize)
+                break;
+            if (isMember(ids, *it))
+                out.push_back(*it);
+        }
+        SplitMix rng(seed ^ mix(self) ^ static_cast<uint64_t>(b) << 56);
+        while (out.size() - begin < bucketSize)
+        {
+            uint32_t id = ids[first + rng.next() % count];
+            if (find(out.begin() + begin, out.end(), id) == out.end())
+                out.push_back(id);
+        }
+    }
+    sortClockwise(out, self);
+}
+
+/**
+ * @brief 加入：新成员所在的桶未满时加入该桶。桶未满说明子树内的成员已全部在桶中，加入后仍不超过 bucketSize，
+ *        与整表重算的结果相同；桶已满时保留原有链接（偏好长期在线的节点），同样与重算一致
+ */
+void KademliaGeometry::linkJoined(uint32_t self, uint32_t successor, vector<uint32_t> &links, uint32_t joined) const
+{
+    (void)successor;
+    if (joined == self || find(links.begin(), links.end(), joined) != links.end())
+        return;
+    int b = bucketOf(self, joined);
+    size_t inBucket = count_if(links.begin(), links.end(), [&](uint32_t id)
+                               { return bucketOf(self, id) == b; });
+    if (inBucket >= bucketSize)
+        return;
+    links.push_back(joined);
+    sortClockwise(links, self);
+}
+
+/**
+ * @brief 离开：删去该链接；子树是连续区间，接替者 successorId 若仍在同一子树内且不在桶中，就补入桶中，
+ *        否则桶暂时少一项（子树内没有其他已知成员），下次整表重算时补足
+ */
+void KademliaGeometry::linkLeft(uint32_t self, uint32_t successor, vector<uint32_t> &links, uint32_t left,
+                                uint32_t successorId) const
+{
+    (void)successor;
+    auto it = find(links.begin(), links.end(), left);
+    if (it == links.end())
+        return;
+    links.erase(it);
+    if (successorId != self && bucketOf(self, successorId) == bucketOf(self, left) &&
+        find(links.begin(), links.end(), successorId) == links.end())
+    {
+        links.push_back(successorId);
+        sortClockwise(links, self);
+    }
+}
+
+/**
+ * @brief 在 (self, target) 内的节点中取与 target 公共前缀最长者（XOR 距离的最高位最低），
+ *        前缀一样长时 XOR 距离不再反映环上的远近，取顺时针离 target 最近者
+ */
+uint32_t KademliaGeometry::nextHop(const uint32_t *table, size_t count, uint32_t self, uint32_t target) const
+{
+    const uint32_t mask = ID_SPACE - 1;
+    uint32_t limit = (target - self - 1) & mask;
+    uint32_t best = self, bestGap = ~0u;
+    int bestPrefix = 33;
+    for (size_t j = 0; j < count; j++)
+    {
+        uint32_t id = table[j];
+        if (((id - self - 1) & mask) >= limit)
+            continue;
+        int prefix = bitLength(id ^ target); // XOR 距离的位数，越小公共前缀越长
+        uint32_t gap = (target - id) & mask;
+        if (prefix < bestPrefix || (prefix == bestPrefix && gap < bestGap))
+        {
+            best = id;
+            bestPrefix = prefix;
+            bestGap = gap;
+        }
+    }
+    return best;
+}
+
+// ==================== Symphony ====================
+
+SymphonyGeometry::SymphonyGeometry(size_t links, uint64_t seed) : links(max<size_t>(1, links)), seed(seed), scale(-1) {}
+
+/**
+ * @brief 估计值取 n 的最接近的 2 的幂。Symphony 只在规模估计偏离建链时的估计超过一倍时才重新建链，
+ *        这里同样留出滞后：n 仍在 [2^(scale-1), 2^(scale+1)] 内时沿用原估计与仍在环中的链接
+ */
+bool SymphonyGeometry::beginRebuild(size_t n)
+{
+    double bits = n < 2 ? 1.0 : log2(static_cast<double>(n));
+    if (scale >= 0 && bits >= scale - 1 && bits <= scale + 1)
+        return true;
+    scale = max(1, static_cast<int>(lround(bits)));
+    return false;
+}
+
+/**
+ * @brief 长链接：x = ñ^(u-1)（u 在 [0,1) 上均匀）服从 [1/ñ, 1) 上的调和分布，链接指向 self + x·2^m 的后继；
+ *        落到自身或后继上的抽取作废重抽（后继本来就在路由表中）
+ * @param ids 有序成员
+ * @param i 节点在 ids 中的下标
+ * @param previous 节点现有的链接，仍在环中的保留
+ * @param out 输出链接
+ */
+void SymphonyGeometry::buildLinks(const vector<uint32_t> &ids, size_t i, const vector<uint32_t> &previous,
+                                  vector<uint32_t> &out) const
+{
+    size_t n = ids.size();
+    uint32_t self = ids[i], successor = ids[(i + 1) % n];
+    if (n < 3)
+        return;
+    for (uint32_t id : previous)
+        if (out.size() < links && id != self && id != successor && isMember(ids, id) &&
+            find(out.begin(), out.end(), id) == out.end())
+            out.push_back(id);
+
+    int bits = scale >= 0 ? scale : max(1, static_cast<int>(lround(log2(static_cast<double>(n))))); // 尚未整表建链时按当前成员估计
+    double logN = bits * log(2.0);
+    SplitMix rng(seed ^ mix(self));
+    for (size_t attempts = 0; out.size() < links && attempts < links * 8; attempts++)
+    {
+        double x = exp(logN * (rng.uniform() - 1.0));
+        uint64_t offset = static_cast<uint64_t>(x * ID_SPACE);
+        offset = min<uint64_t>(max<uint64_t>(offset, 1), ID_SPACE - 1);
+        uint32_t id = ids[successorIndex(ids, static_cast<uint32_t>((self + offset) & (ID_SPACE - 1)))];
+        if (id != self && id != successor && find(out.begin(), out.end(), id) == out.end())
+            out.push_back(id);
+    }
+    sortClockwise(out, self);
+}
+
+/**
+ * @brief 离开：长链接指向 self + offset 的后继，离开后该点的后继正是接替者 successorId，直接改指，不重新抽取；
+ *        接替者是自身、后继或已在表中时只删去
+ */
+void SymphonyGeometry::linkLeft(uint32_t self, uint32_t successor, vector<uint32_t> &links, uint32_t left,
+                                uint32_t successorId) const
+{
+    auto it = find(links.begin(), links.end(), left);
+    if (it == links.end())
+        return;
+    links.erase(it);
+    if (successorId != self && successorId != successor && find(links.begin(), links.end(), successorId) == links.end())
+    {
+        links.push_back(successorId);
+        sortClockwise(links, self);
+    }
+}
+
+uint32_t SymphonyGeometry::nextHop(const uint32_t *table, size_t count, uint32_t self, uint32_t target) const
+{
+    return closestPreceding(table, count, self, target);
+}
+
+// ==================== 单跳 ====================
+
+namespace
+{
+    // 顺时针有序表中第一个与 self 顺时针距离不小于 target 的下标；末尾的 self 填充不参与比较
+    size_t clockwiseLowerBound(const uint32_t *table, size_t &count, uint32_t self, uint32_t target)
+    {
+        while (count > 0 && table[count - 1] == self)
+            count--;
+        const uint32_t mask = ID_SPACE - 1;
+        uint32_t distance = (target - self) & mask;
+        return lower_bound(table, table + count, distance, [self, mask](uint32_t id, uint32_t d)
+                           { return ((id - self) & mask) < d; }) -
+               table;
+    }
+}
+
+/**
+ * @brief 全部其他成员按顺时针顺序：ids 已升序，从 i 之后开始绕一圈即可，O(N)
+ */
+void OneHopGeometry::buildLinks(const vector<uint32_t> &ids, size_t i, const vector<uint32_t> &previous,
+                                vector<uint32_t> &out) const
+{
+    (void)previous;
+    out.reserve(ids.size());
+    out.insert(out.end(), ids.begin() + i + 1, ids.end());
+    out.insert(out.end(), ids.begin(), ids.begin() + i);
+}
+
+uint32_t OneHopGeometry::nextHop(const uint32_t *table, size_t count, uint32_t self, uint32_t target) const
+{
+    size_t j = clockwiseLowerBound(table, count, self, target);
+    return j == 0 ? self : table[j - 1];
+}
+
+bool OneHopGeometry::owner(const uint32_t *table, size_t count, uint32_t self, uint32_t target, uint32_t &out) const
+{
+    size_t j = clockwiseLowerBound(table, count, self, target);
+    out = j == count ? self : table[j];
+    return true;
+}
+
+// ==================== 工厂 ====================
+
+unique_ptr<RoutingGeometry> makeGeometry(const GeometryOptions &options)
+{
+    switch (options.kind)
+    {
+    case GeometryKind::KADEMLIA:
+        return unique_ptr<RoutingGeometry>(new KademliaGeometry(options.bucketSize, options.seed));
+    case GeometryKind::SYMPHONY:
+        return unique_ptr<RoutingGeometry>(new SymphonyGeometry(options.links, options.seed));
+    case GeometryKind::ONE_HOP:
+        return unique_ptr<RoutingGeometry>(new OneHopGeometry());
+    default:
+        return unique_ptr<RoutingGeometry>(new ChordFingerGeometry());
+    }
+}
+
+const RoutingGeometry &chordFingerGeometry()
+{
+    static const ChordFingerGeometry instance;
+    return instance;
+}
+
+const char *geometryName(GeometryKind kind)
+{
+    switch (kind)
+    {
+    case GeometryKind::KADEMLIA:
+        return "kademlia";
+    case GeometryKind::SYMPHONY:
+        return "symphony";
+    case GeometryKind::ONE_HOP:
+        return "onehop";
+    default:
+        return "chord";
+    }
+}
+
+bool parseGeometry(const string &name, GeometryKind &kind)
+{
+    static const map<string, GeometryKind> names = {{"chord", GeometryKind::CHORD},
+                                                    {"kademlia", GeometryKind::KADEMLIA},
+                                                    {"symphony", GeometryKind::SYMPHONY},
+                                                    {"onehop", GeometryKind::ONE_HOP}};
+    auto it = names.find(name);
+    if (it == names.end())
+        return false;
+    kind = it->second;
+    return true;
+}
@@ -0,0 +1,145 @@
+#ifndef ROUTING_GEOMETRY_H
+#define ROUTING_GEOMETRY_H
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// 路由几何：决定每个节点在前驱/后继之外保存哪些远程节点，以及每一步从中选哪个作为下一跳。
+// 资源归属始终是环上的后继，各几何共用同一套管理器、代理、迁移与基准测试，只有路由表不同
+enum class GeometryKind
+{
+    CHORD,    // finger i 指向 self + 2^i 的后继（默认），每跳距离至少减半
+    KADEMLIA, // XOR 桶：桶 i 保存与自身 XOR 距离在 [2^i, 2^(i+1)) 内的至多 bucketSize 个节点
+    SYMPHONY, // 小世界：links 条长链接，距离按调和分布 p(x) ∝ 1/x（x ∈ [1/n, 1]）随机抽取
+    ONE_HOP   // 全成员：每个节点保存全部成员，入口直接确定后继；成员变化按增量逐个节点推送，适合数千节点以内的环
+};
+
+struct GeometryOptions
+{
+    GeometryKind kind = GeometryKind::CHORD;
+    size_t bucketSize = 2; // KADEMLIA：每个桶的节点数 k
+    size_t links = 4;      // SYMPHONY：长链接数
+    uint64_t seed = 1;     // 随机选择的种子，同一成员下同一节点的结果确定
+};
+
+class RoutingGeometry
+{
+public:
+    virtual ~RoutingGeometry() {}
+    virtual GeometryKind kind() const = 0;
+
+    // 为 true 时节点直接用自身的 finger 数组作为路由表（由加入/离开协议与 rebuildRouting 维护），不生成链接表
+    virtual bool usesFingerTable() const { return false; }
+
+    // 为 true 时链接表即除自身外的全部成员：单个节点加入/离开时由管理器把增量推送给每个节点（Chord::addMember / removeMember），
+    // 不刷新 finger；批量成员变化、切换几何与载入镜像时仍整表重算
+    virtual bool fullMembership() const { return false; }
+
+    // 一次全环重算开始前调用，n 为成员数；返回 false 表示各节点现有的链接作废，全部重新选择
+    virtual bool beginRebuild(size_t n)
+    {
+        (void)n;
+        return true;
+    }
+
+    // 为有序成员 ids 中的第 i 个节点选择链接，previous 为它现有的链接（仍在环中的可以保留，减少成员变化时的改动）；
+    // out 去重、不含自身，按自身起的顺时针距离升序
+    virtual void buildLinks(const std::vector<uint32_t> &ids, size_t i, const std::vector<uint32_t> &previous,
+                            std::vector<uint32_t> &out) const
+    {
+        (void)ids, (void)i, (void)previous, (void)out;
+    }
+
+    // gossip 传来单个成员变化时就地修补链接表（links 不含自身，按顺时针距离升序，修补后仍如此），
+    // 只用本节点现有的链接与更新携带的信息，不做全环重算。successor 为本节点（修补后）的后继。
+    // 加入默认不改动；离开默认删去该链接，successorId 为接替离开节点的成员
+    virtual void linkJoined(uint32_t self, uint32_t successor, std::vector<uint32_t> &links, uint32_t joined) const
+    {
+        (void)self, (void)successor, (void)links, (void)joined;
+    }
+    virtual void linkLeft(uint32_t self, uint32_t successor, std::vector<uint32_t> &links, uint32_t left,
+                          uint32_t successorId) const;
+
+    // 从路由表中选 target 的下一跳：只能选落在开区间 (self, target) 内的节点，保证每跳顺时针距离严格减小；
+    // 没有满足条件的节点时返回 self。table 中可以含 self 作为填充
+    virtual uint32_t nextHop(const uint32_t *table, size_t count, uint32_t self, uint32_t target) const = 0;
+
+    // 路由表足以在本节点确定 target 的后继时返回 true 并给出后继（没有其他节点负责时为 self），否则返回 false 交给 nextHop
+    virtual bool owner(const uint32_t *table, size_t count, uint32_t self, uint32_t target, uint32_t &out) const
+    {
+        (void)table, (void)count, (void)self, (void)target, (void)out;
+        return false;
+    }
+};
+
+// Chord finger：最接近前驱，使用 finger_simd 内核（count 须为 FINGER_LANES 的倍数）
+class ChordFingerGeometry : public RoutingGeometry
+{
+public:
+    GeometryKind kind() const override { return GeometryKind::CHORD; }
+    bool usesFingerTable() const override { return true; }
+    uint32_t nextHop(const uint32_t *table, size_t count, uint32_t self, uint32_t target) const override;
+};
+
+// Kademlia XOR 桶：下一跳在 (self, target) 内的节点中取与 target 公共前缀最长者，同长时取顺时针最近者。
+// 归属按后继确定，只沿顺时针前进，最后一段由后继指针完成
+class KademliaGeometry : public RoutingGeometry
+{
+private:
+    size_t bucketSize;
+    uint64_t seed;
+
+public:
+    KademliaGeometry(size_t bucketSize, uint64_t seed);
+    GeometryKind kind() const override { return GeometryKind::KADEMLIA; }
+    void buildLinks(const std::vector<uint32_t> &ids, size_t i, const std::vector<uint32_t> &previous,
+                    std::vector<uint32_t> &out) const override;
+    void linkJoined(uint32_t self, uint32_t successor, std::vector<uint32_t> &links, uint32_t joined) const override;
+    void linkLeft(uint32_t self, uint32_t successor, std::vector<uint32_t> &links, uint32_t left,
+                  uint32_t successorId) const override;
+    uint32_t nextHop(const uint32_t *table, size_t count, uint32_t self, uint32_t target) const override;
+};
+
+// Symphony：长链接指向 self + x·2^m 的后继，x 按调和分布抽取；下一跳为顺时针最接近的前驱。
+// 网络规模按 2 的幂估计，估计值不变时保留仍在环中的链接，只为离开的链接重新抽取；
+// gossip 的单个成员变化不重新估计规模（批量成员变化、切换几何与载入镜像时才估计）
+class SymphonyGeometry : public RoutingGeometry
+{
+private:
+    size_t links;
+    uint64_t seed;
+    int scale; // log2(估计的网络规模)，-1 表示尚未建立
+
+public:
+    SymphonyGeometry(size_t links, uint64_t seed);
+    GeometryKind kind() const override { return GeometryKind::SYMPHONY; }
+    bool beginRebuild(size_t n) override;
+    void buildLinks(const std::vector<uint32_t> &ids, size_t i, const std::vector<uint32_t> &previous,
+                    std::vector<uint32_t> &out) const override;
+    void linkLeft(uint32_t self, uint32_t successor, std::vector<uint32_t> &links, uint32_t left,
+                  uint32_t successorId) const override;
+    uint32_t nextHop(const uint32_t *table, size_t count, uint32_t self, uint32_t target) const override;
+};
+
+// 单跳：链接表为按顺时针距离升序的全部其他成员（末尾可有 self 填充），后继与最接近前驱都由二分查找得到，
+// 查找在入口节点一步确定后继，不经转发
+class OneHopGeometry : public RoutingGeometry
+{
+public:
+    GeometryKind kind() const override { return GeometryKind::ONE_HOP; }
+    bool fullMembership() const override { return true; }
+    void buildLinks(const std::vector<uint32_t> &ids, size_t i, const std::vector<uint32_t> &previous,
+                    std::vector<uint32_t> &out) const override;
+    uint32_t nextHop(const uint32_t *table, size_t count, uint32_t self, uint32_t target) const override;
+    bool owner(const uint32_t *table, size_t count, uint32_t self, uint32_t target, uint32_t &out) const override;
+};
+
+std::unique_ptr<RoutingGeometry> makeGeometry(const GeometryOptions &options);
+const RoutingGeometry &chordFingerGeometry(); // 共享的 Chord 实例，没有管理器的节点使用
+const char *geometryName(GeometryKind kind);
+bool parseGeometry(const std::string &name, GeometryKind &kind);
+
+#endif // ROUTING_GEOMETRY_H
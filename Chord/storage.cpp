@@ -0,0 +1,1040 @@
+#include "storage.h"
+#include "node.h"
+#include "logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <io.h>
+#else
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+/*
+文件格式（小端序）：
+WAL 记录：u32 负载长度 | u32 CRC32(负载) | 负载
+    负载 = u8 类型 + 字段，类型见 RecordType
+    快照之后重建的 WAL 以一条 REC_GENERATION（u64 代号）开头，没有这条记录的 WAL 代号为 0
+快照文件：'C''H''S''N' | u32 版本 | u32 种类 | u32 条目数 | 条目... | u32 CRC32(此前所有字节)
+    节点快照条目 = u32 资源ID + str 资源内容，成员快照条目 = str IP
+    节点快照（版本 ≥ 2）在条目之后另有 u32 数量 + (u32 资源ID + u64 到期时刻) 若干，版本 1 没有这一段
+    成员快照（版本 ≥ 4）在条目之后另有放置方式：u8 模式 + str 键域下界 + str 键域上界，更早的版本视为哈希放置
+    版本 ≥ 3 在 CRC 之前另有 u64 代号（快照之后那一代 WAL 的代号），版本 1、2 视为代号 0
+    str = u32 长度 + 字节
+快照先写临时文件并 fsync，rename 后 fsync 目录，再以新代号重建 WAL 并 fsync。重建未落盘时磁盘上仍是旧一代的 WAL，
+其内容都已包含在快照中，恢复时按代号整体跳过，不会把快照之后删除的资源重放回来
+*/
+
+namespace
+{
+    enum RecordType : uint8_t
+    {
+        REC_JOIN = 1,
+        REC_LEAVE = 2,
+        REC_PUT = 3,
+        REC_DEL = 4,
+        REC_XFER = 5, // 单条转移，现由 REC_XFER_CHUNK 取代，仅在恢复时读取
+        REC_DEL_RANGE = 6,
+        REC_XFER_CHUNK = 7,
+        REC_EXPIRE = 8,    // 为刚写入或迁入的资源设置到期时刻；之后的 PUT/DEL/迁移会清除它
+        REC_GENERATION = 9, // WAL 的第一条记录：本 WAL 的代号
+        REC_PLACEMENT = 10  // 成员 WAL：切换放置方式（u8 模式 + str 下界 + str 上界）
+    };
+
+    const char SNAPSHOT_MAGIC[4] = {'C', 'H', 'S', 'N'};
+    const uint32_t SNAPSHOT_VERSION = 4;
+    const uint32_t SNAPSHOT_KIND_MEMBERSHIP = 0;
+    const uint32_t SNAPSHOT_KIND_NODE = 1;
+
+    uint32_t crc32(const char *data, size_t len)
+    {
+        static uint32_t table[256];
+        static bool ready = false;
+        if (!ready)
+        {
+            for (uint32_t i = 0; i < 256; i++)
+            {
+                uint32_t c = i;
+                for (int k = 0; k < 8; k++)
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                table[i] = c;
+            }
+            ready = true;
+        }
+        uint32_t crc = 0xFFFFFFFFu;
+        for (size_t i = 0; i < len; i++)
+            crc = table[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+    void putU32(string &out, uint32_t v)
+    {
+        for (int i = 0; i < 4; i++)
+            out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+    }
+
+    void putU64(string &out, uint64_t v)
+    {
+        putU32(out, static_cast<uint32_t>(v));
+        putU32(out, static_cast<uint32_t>(v >> 32));
+    }
+
+    void putStr(string &out, const string &s)
+    {
+        putU32(out, static_cast<uint32_t>(s.size()));
+        out += s;
+    }
+
+    // 顺序读取缓冲区的游标，越界时 ok 置为 false
+    struct Reader
+    {
+        const string &buf;
+        size_t pos;
+        bool ok;
+
+        Reader(const string &b, size_t p) : buf(b), pos(p), ok(true) {}
+
+        uint32_t u32()
+        {
+            if (pos + 4 > buf.size())
+            {
+                ok = false;
+                return 0;
+            }
+            uint32_t v = 0;
+            for (int i = 0; i < 4; i++)
+                v |= static_cast<uint32_t>(static_cast<uint8_t>(buf[pos + i])) << (8 * i);
+            pos += 4;
+            return v;
+        }
+
+        uint64_t u64()
+        {
+            uint64_t lo = u32();
+            uint64_t hi = u32();
+            return lo | (hi << 32);
+        }
+
+        uint8_t u8()
+        {
+            if (pos + 1 > buf.size())
+            {
+                ok = false;
+                return 0;
+            }
+            return static_cast<uint8_t>(buf[pos++]);
+        }
+
+        string str()
+        {
+            uint32_t len = u32();
+            if (!ok || pos + len > buf.size())
+            {
+                ok = false;
+                return string();
+            }
+            string s = buf.substr(pos, len);
+            pos += len;
+            return s;
+        }
+    };
+
+    void putPlacement(string &out, const PlacementOptions &placement)
+    {
+        out.push_back(static_cast<char>(placement.mode));
+        putStr(out, placement.lowKey);
+        putStr(out, placement.highKey);
+    }
+
+    PlacementOptions readPlacement(Reader &r)
+    {
+        PlacementOptions placement;
+        placement.mode = r.u8() == static_cast<uint8_t>(PlacementMode::ORDER_PRESERVING) ? PlacementMode::ORDER_PRESERVING
+                                                                                          : PlacementMode::HASHED;
+        placement.lowKey = r.str();
+        placement.highKey = r.str();
+        return placement;
+    }
+
+    string frame(const string &payload)
+    {
+        string out;
+        putU32(out, static_cast<uint32_t>(payload.size()));
+        putU32(out, crc32(payload.data(), payload.size()));
+        out += payload;
+        return out;
+    }
+
+    bool readWholeFile(const string &path, string &out)
+    {
+        FILE *f = fopen(path.c_str(), "rb");
+        if (!f)
+            return false;
+        out.clear();
+        char buf[65536];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+            out.append(buf, n);
+        fclose(f);
+        return true;
+    }
+
+    bool syncFile(FILE *f)
+    {
+        if (fflush(f) != 0)
+            return false;
+#ifdef _WIN32
+        return _commit(_fileno(f)) == 0;
+#else
+        return fsync(fileno(f)) == 0;
+#endif
+    }
+
+    // 新建、rename 的文件在其所在目录的目录项落盘后才算持久（Windows 没有对应的接口，视为成功）
+    bool syncDir(const string &filePath)
+    {
+#ifdef _WIN32
+        (void)filePath;
+        return true;
+#else
+        size_t slash = filePath.find_last_of('/');
+        string dir = slash == string::npos ? string(".") : slash == 0 ? string("/") : filePath.substr(0, slash);
+        int fd = ::open(dir.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        bool ok = fsync(fd) == 0;
+        ::close(fd);
+        return ok;
+#endif
+    }
+
+    bool resizeFile(FILE *f, uint64_t size)
+    {
+#ifdef _WIN32
+        return _chsize_s(_fileno(f), static_cast<__int64>(size)) == 0;
+#else
+        return ftruncate(fileno(f), static_cast<off_t>(size)) == 0;
+#endif
+    }
+
+    // 去掉 WAL 损坏的尾部，之后的追加接在最后一条完整记录后面
+    bool truncateFile(const string &path, uint64_t size)
+    {
+        FILE *f = fopen(path.c_str(), "r+b");
+        if (!f)
+            return false;
+        bool ok = resizeFile(f, size) && syncFile(f);
+        fclose(f);
+        return ok;
+    }
+
+    uint64_t nowUs()
+    {
+        return static_cast<uint64_t>(
+            chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    void makeDir(const string &path)
+    {
+#ifdef _WIN32
+        _mkdir(path.c_str());
+#else
+        mkdir(path.c_str(), 0755);
+#endif
+    }
+
+    // 逐条解析 WAL，遇到截断或校验失败的尾部即停止；返回是否完整读完，validLen 为完整记录的总长度
+    template <typename Fn>
+    bool forEachRecord(const string &buf, Fn fn, uint64_t &count, size_t &validLen)
+    {
+        size_t pos = 0;
+        validLen = 0;
+        while (pos < buf.size())
+        {
+            Reader header(buf, pos);
+            uint32_t len = header.u32();
+            uint32_t crc = header.u32();
+            if (!header.ok || header.pos + len > buf.size())
+                return false;
+            if (crc32(buf.data() + header.pos, len) != crc)
+                return false;
+            string payload = buf.substr(header.pos, len);
+            Reader r(payload, 0);
+            fn(r);
+            if (!r.ok)
+                return false;
+            pos = header.pos + len;
+            validLen = pos;
+            count++;
+        }
+        return true;
+    }
+
+    // WAL 的代号：第一条记录是 REC_GENERATION 时取其值，否则为 0
+    uint64_t walGeneration(const string &buf)
+    {
+        Reader header(buf, 0);
+        uint32_t len = header.u32();
+        uint32_t crc = header.u32();
+        if (!header.ok || len != 9 || header.pos + len > buf.size() || crc32(buf.data() + header.pos, len) != crc)
+            return 0;
+        Reader r(buf, header.pos);
+        return r.u8() == REC_GENERATION ? r.u64() : 0;
+    }
+
+    // 读取并校验快照，返回条目区的 Reader 起点、版本与代号；文件不存在或损坏返回 false
+    bool openSnapshot(const string &path, uint32_t kind, string &buf, uint32_t &count, size_t &bodyPos, uint32_t &version,
+                      uint64_t &generation)
+    {
+        if (!readWholeFile(path, buf) || buf.size() < 20)
+            return false;
+        if (memcmp(buf.data(), SNAPSHOT_MAGIC, 4) != 0)
+            return false;
+        Reader tail(buf, buf.size() - 4);
+        if (tail.u32() != crc32(buf.data(), buf.size() - 4))
+            return false;
+        Reader r(buf, 4);
+        version = r.u32();
+        uint32_t snapKind = r.u32();
+        count = r.u32();
+        if (!r.ok || version < 1 || version > SNAPSHOT_VERSION || snapKind != kind)
+            return false;
+        if (version >= 3 && buf.size() < 28)
+            return false;
+        generation = version >= 3 ? Reader(buf, buf.size() - 12).u64() : 0;
+        bodyPos = r.pos;
+        return true;
+    }
+
+    double elapsedMs(chrono::steady_clock::time_point since)
+    {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - since).count();
+    }
+}
+
+double StorageStats::writeAmplification() const
+{
+    return logicalBytes == 0 ? 0.0 : static_cast<double>(walBytes + snapshotBytes) / logicalBytes;
+}
+
+// ==================== LogFile 实现 ====================
+
+LogFile::LogFile(const string &walPath, const string &snapPath, uint32_t nodeId)
+    : walPath(walPath), snapPath(snapPath), nodeId(nodeId), pendingCount(0), recordsSinceSnapshot(0), generation(0),
+      walStale(false), receiving(false), sending(false)
+{
+}
+
+/**
+ * @brief 追加一条已封帧的记录到待写缓冲
+ * @param record 记录字节
+ */
+void LogFile::append(const string &record)
+{
+    pending += record;
+    pendingCount++;
+    recordsSinceSnapshot++;
+}
+
+/**
+ * @brief 将缓冲记录追加到 WAL 文件：打开、写入、（fsync）后立即关闭；失败时把文件截回写入前的长度，缓冲记录保留
+ * @param sync 是否 fsync
+ * @param written 输出写入的字节数
+ * @return true 若全部写入（没有缓冲记录时也返回 true）
+ */
+bool LogFile::flush(bool sync, uint64_t &written)
+{
+    written = 0;
+    if (pending.empty())
+        return true;
+    if (walStale && !reset())
+        return false;
+    FILE *f = fopen(walPath.c_str(), "ab");
+    if (!f)
+    {
+        logger.error("无法打开 WAL 文件：" + walPath);
+        return false;
+    }
+    setvbuf(f, nullptr, _IONBF, 0); // 不经 stdio 缓冲，失败时截回之后不会再有残留数据写出
+    long before = fseek(f, 0, SEEK_END) == 0 ? ftell(f) : -1;
+    bool ok = before >= 0 && fwrite(pending.data(), 1, pending.size(), f) == pending.size();
+    if (ok && sync)
+        ok = syncFile(f);
+    if (!ok && before >= 0)
+        resizeFile(f, static_cast<uint64_t>(before));
+    fclose(f);
+    if (!ok)
+    {
+        logger.error("写入 WAL 失败：" + walPath);
+        return false;
+    }
+    written = pending.size();
+    pending.clear();
+    pendingCount = 0;
+    receiving = false;
+    sending = false;
+    return true;
+}
+
+/**
+ * @brief 丢弃缓冲记录（其内容已包含在即将写入的快照中）
+ * @return size_t 丢弃的记录数
+ */
+size_t LogFile::discardPending()
+{
+    size_t n = pendingCount;
+    pending.clear();
+    pendingCount = 0;
+    receiving = false;
+    sending = false;
+    return n;
+}
+
+/**
+ * @brief 以当前代号重建 WAL：新文件只含一条代号记录，文件与目录都 fsync 后才算完成；
+ *        失败时保持 walStale，下次写盘前重试
+ * @return true 若重建完成
+ */
+bool LogFile::reset()
+{
+    walStale = true;
+    string payload(1, static_cast<char>(REC_GENERATION));
+    putU64(payload, generation);
+    string record = frame(payload);
+    FILE *f = fopen(walPath.c_str(), "wb");
+    if (!f)
+    {
+        logger.error("无法重建 WAL：" + walPath);
+        return false;
+    }
+    bool ok = fwrite(record.data(), 1, record.size(), f) == record.size() && syncFile(f);
+    fclose(f);
+    if (!ok || !syncDir(walPath))
+    {
+        logger.error("无法重建 WAL：" + walPath);
+        return false;
+    }
+    walStale = false;
+    return true;
+}
+
+/**
+ * @brief 删除该日志对应的 WAL 与快照文件
+ */
+void LogFile::removeFiles()
+{
+    pending.clear();
+    pendingCount = 0;
+    remove(walPath.c_str());
+    remove(snapPath.c_str());
+}
+
+// ==================== ChordStorage 实现 ====================
+
+ChordStorage::ChordStorage()
+    : enabled(false), suspended(false), recovering(false), failed(false), pendingRecords(0), batchStartUs(0),
+      membership(nullptr)
+{
+}
+
+ChordStorage::~ChordStorage() { close(); }
+
+/**
+ * @brief 打开数据目录，启用持久化
+ * @param opts 持久化配置
+ * @return true 若成功打开
+ * @return false 若数据目录为空、无法创建或不可写
+ */
+bool ChordStorage::open(const StorageOptions &opts)
+{
+    close();
+    if (opts.dataDir.empty())
+        return false;
+    options = opts;
+    if (options.groupCommitSize == 0)
+        options.groupCommitSize = 1;
+    makeDir(options.dataDir);
+    string walPath = options.dataDir + "/ring.wal";
+    FILE *probe = fopen(walPath.c_str(), "ab");
+    if (!probe)
+    {
+        logger.error("无法写入数据目录：" + options.dataDir);
+        return false;
+    }
+    fclose(probe);
+    membership = new LogFile(walPath, options.dataDir + "/ring.snap", 0);
+    enabled = true;
+    failed = false;
+    pendingRecords = 0;
+    stats = StorageStats();
+    logger.info("持久化目录: " + options.dataDir);
+    return true;
+}
+
+/**
+ * @brief 刷盘并释放所有日志
+ */
+void ChordStorage::close()
+{
+    if (!enabled)
+        return;
+    if (!sync())
+        logger.error("关闭持久化时仍有记录未能写盘：" + options.dataDir);
+    for (auto &p : nodeLogs)
+        delete p.second;
+    nodeLogs.clear();
+    dirtyLogs.clear();
+    snapshotDue.clear();
+    delete membership;
+    membership = nullptr;
+    pendingRecords = 0;
+    enabled = false;
+}
+
+string ChordStorage::nodeWalPath(uint32_t nodeId) const
+{
+    return options.dataDir + "/node_" + to_string(nodeId) + ".wal";
+}
+
+string ChordStorage::nodeSnapPath(uint32_t nodeId) const
+{
+    return options.dataDir + "/node_" + to_string(nodeId) + ".snap";
+}
+
+LogFile *ChordStorage::nodeLog(uint32_t nodeId)
+{
+    auto it = nodeLogs.find(nodeId);
+    if (it != nodeLogs.end())
+        return it->second;
+    LogFile *log = new LogFile(nodeWalPath(nodeId), nodeSnapPath(nodeId), nodeId);
+    // 恢复之外新建的日志属于新加入的节点：同ID节点先前离开时未删掉的文件不能再被读到
+    if (!recovering)
+    {
+        remove(log->getSnapPath().c_str());
+        log->markStale();
+    }
+    nodeLogs[nodeId] = log;
+    return log;
+}
+
+void ChordStorage::appendRecord(LogFile *log, const string &payload, uint64_t logicalBytes)
+{
+    if (log != membership && !log->hasPending())
+        dirtyLogs.push_back(log);
+    log->append(frame(payload));
+    stats.walRecords++;
+    stats.logicalBytes += logicalBytes;
+    if (log != membership && log->needsSnapshot(options.snapshotThreshold))
+        snapshotDue.insert(log->getNodeId());
+    uint64_t now = nowUs();
+    if (pendingRecords++ == 0)
+        batchStartUs = now;
+    if (pendingRecords >= options.groupCommitSize ||
+        (options.commitDelayMs > 0 && now - batchStartUs >= options.commitDelayMs * 1000))
+        commit();
+}
+
+void ChordStorage::logJoin(const string &ip)
+{
+    if (!isEnabled())
+        return;
+    string p(1, static_cast<char>(REC_JOIN));
+    putStr(p, ip);
+    appendRecord(membership, p, ip.size());
+}
+
+void ChordStorage::logLeave(const string &ip)
+{
+    if (!isEnabled())
+        return;
+    string p(1, static_cast<char>(REC_LEAVE));
+    putStr(p, ip);
+    appendRecord(membership, p, ip.size());
+}
+
+void ChordStorage::logPlacement(const PlacementOptions &placement)
+{
+    if (!isEnabled())
+        return;
+    string p(1, static_cast<char>(REC_PLACEMENT));
+    putPlacement(p, placement);
+    appendRecord(membership, p, p.size() - 1);
+}
+
+void ChordStorage::logPut(uint32_t nodeId, uint32_t rid, const string &res)
+{
+    if (!isEnabled())
+        return;
+    string p(1, static_cast<char>(REC_PUT));
+    putU32(p, rid);
+    putStr(p, res);
+    appendRecord(nodeLog(nodeId), p, 4 + res.size());
+}
+
+void ChordStorage::logRemove(uint32_t nodeId, uint32_t rid)
+{
+    if (!isEnabled())
+        return;
+    string p(1, static_cast<char>(REC_DEL));
+    putU32(p, rid);
+    appendRecord(nodeLog(nodeId), p, 4);
+}
+
+/**
+ * @brief 记录资源的到期时刻，紧跟在对应的 PUT 或迁移分块记录之后；过期删除本身不写日志，恢复后按到期时刻直接过期
+ */
+void ChordStorage::logExpiry(uint32_t nodeId, uint32_t rid, uint64_t deadlineMs)
+{
+    if (!isEnabled())
+        return;
+    string p(1, static_cast<char>(REC_EXPIRE));
+    putU32(p, rid);
+    putU64(p, deadlineMs);
+    appendRecord(nodeLog(nodeId), p, 12);
+}
+
+/**
+ * @brief 记录一段连续资源的删除（闭区间 [lo, hi]），区间迁移时发送方每个分块一条记录
+ */
+void ChordStorage::logRemoveRange(uint32_t nodeId, uint32_t lo, uint32_t hi)
+{
+    if (!isEnabled())
+        return;
+    LogFile *log = nodeLog(nodeId);
+    if (log->isReceiving())
+        commit();
+    log->markSending();
+    string p(1, static_cast<char>(REC_DEL_RANGE));
+    putU32(p, lo);
+    putU32(p, hi);
+    appendRecord(log, p, 8);
+}
+
+/**
+ * @brief 记录一个迁移分块的所有权转移，写入接收方日志（发送方的删除由其 DEL_RANGE 记录或节点离开体现）。
+ *        接收方本批已有迁出、或发送方本批已有迁入时先提交已缓冲的记录，保证每批中迁入方都能先于迁出方落盘
+ */
+void ChordStorage::logTransferChunk(uint32_t fromId, uint32_t toId, const ResourceChunk &chunk)
+{
+    if (!isEnabled() || chunk.empty())
+        return;
+    LogFile *log = nodeLog(toId);
+    auto sender = nodeLogs.find(fromId);
+    if (log->isSending() || (sender != nodeLogs.end() && sender->second->isReceiving()))
+        commit();
+    log->markReceiving();
+    string p(1, static_cast<char>(REC_XFER_CHUNK));
+    putU32(p, fromId);
+    putU32(p, static_cast<uint32_t>(chunk.size()));
+    uint64_t logical = 0;
+    for (auto &res : chunk)
+    {
+        putU32(p, res.first);
+        putStr(p, res.second);
+        logical += 4 + res.second.size();
+    }
+    appendRecord(log, p, logical);
+}
+
+/**
+ * @brief 节点离开后删除其日志与快照。先提交：接收方的迁入与成员日志中的离开记录落盘后才能删除；
+ *        提交失败时保留文件（恢复时该节点仍在成员中，资源从它自己的日志恢复）
+ * @param nodeId 离开的节点ID
+ */
+void ChordStorage::dropNode(uint32_t nodeId)
+{
+    if (!isEnabled())
+        return;
+    bool committed = commit();
+    auto it = nodeLogs.find(nodeId);
+    if (it != nodeLogs.end())
+    {
+        LogFile *log = it->second;
+        dirtyLogs.erase(std::remove(dirtyLogs.begin(), dirtyLogs.end(), log), dirtyLogs.end());
+        pendingRecords -= log->discardPending();
+        delete log;
+        nodeLogs.erase(it);
+    }
+    snapshotDue.erase(nodeId);
+    if (!committed)
+    {
+        logger.error("组提交失败，暂不删除离开节点的日志：" + to_string(nodeId));
+        return;
+    }
+    remove(nodeWalPath(nodeId).c_str());
+    remove(nodeSnapPath(nodeId).c_str());
+}
+
+bool ChordStorage::flushLog(LogFile *log)
+{
+    uint64_t written = 0;
+    bool ok = log->flush(options.syncOnCommit, written);
+    stats.walBytes += written;
+    return ok;
+}
+
+/**
+ * @brief 组提交：本批收到迁移分块的节点日志 → 成员日志 → 其余节点日志，每个文件只 fsync 一次；
+ *        任一文件失败即停止，之后的文件不写，缓冲记录全部保留到下次提交
+ * @return true 若全部写盘
+ */
+bool ChordStorage::commit()
+{
+    if (!enabled || pendingRecords == 0)
+        return true;
+    bool ok = true;
+    for (LogFile *log : dirtyLogs)
+        if (ok && log->isReceiving())
+            ok = flushLog(log);
+    ok = ok && flushLog(membership);
+    for (LogFile *log : dirtyLogs)
+        if (ok)
+            ok = flushLog(log);
+    if (!ok)
+    {
+        failed = true;
+        stats.commitFailures++;
+        return false;
+    }
+    dirtyLogs.clear();
+    pendingRecords = 0;
+    failed = false;
+    stats.groupCommits++;
+    return true;
+}
+
+/**
+ * @brief 立即提交所有缓冲记录（退出或显式同步时调用）
+ * @return true 若全部写盘
+ */
+bool ChordStorage::sync() { return commit(); }
+
+vector<uint32_t> ChordStorage::nodesNeedingSnapshot() const
+{
+    return vector<uint32_t>(snapshotDue.begin(), snapshotDue.end());
+}
+
+bool ChordStorage::membershipNeedsSnapshot() const
+{
+    return enabled && membership->needsSnapshot(options.snapshotThreshold);
+}
+
+/**
+ * @brief 写快照文件：先写临时文件并 fsync，rename 后 fsync 所在目录
+ * @return true 若快照已持久
+ */
+bool ChordStorage::writeSnapshotFile(const string &path, const string &body)
+{
+    string out = body;
+    putU32(out, crc32(out.data(), out.size()));
+    string tmp = path + ".tmp";
+    FILE *f = fopen(tmp.c_str(), "wb");
+    if (!f)
+    {
+        logger.error("无法写入快照：" + tmp);
+        return false;
+    }
+    bool ok = fwrite(out.data(), 1, out.size(), f) == out.size() && syncFile(f);
+    fclose(f);
+    if (!ok)
+    {
+        logger.error("无法写入快照：" + tmp);
+        remove(tmp.c_str());
+        return false;
+    }
+#ifdef _WIN32
+    remove(path.c_str());
+#endif
+    if (rename(tmp.c_str(), path.c_str()) != 0 || !syncDir(path))
+    {
+        logger.error("无法替换快照：" + path);
+        return false;
+    }
+    stats.snapshotsWritten++;
+    stats.snapshotBytes += out.size();
+    return true;
+}
+
+/**
+ * @brief 写入节点快照并以新代号重建其 WAL
+ * @param nodeId 节点ID
+ * @param resources 节点当前的全部资源
+ * @param deadlines 其中带 TTL 的资源的到期时刻
+ * @return true 若快照已持久（WAL 重建失败时会在下次写盘前重试）
+ */
+bool ChordStorage::writeNodeSnapshot(uint32_t nodeId, const ResourceMap &resources, const DeadlineMap &deadlines)
+{
+    if (!enabled)
+        return false;
+    LogFile *log = nodeLog(nodeId);
+    uint64_t generation = log->getGeneration() + 1;
+    string body(SNAPSHOT_MAGIC, 4);
+    putU32(body, SNAPSHOT_VERSION);
+    putU32(body, SNAPSHOT_KIND_NODE);
+    putU32(body, static_cast<uint32_t>(resources.size()));
+    for (auto &res : resources)
+    {
+        putU32(body, res.first);
+        putStr(body, res.second);
+    }
+    putU32(body, static_cast<uint32_t>(deadlines.size()));
+    for (auto &d : deadlines)
+    {
+        putU32(body, d.first);
+        putU64(body, d.second);
+    }
+    putU64(body, generation);
+    if (!writeSnapshotFile(log->getSnapPath(), body))
+        return false;
+    pendingRecords -= log->discardPending();
+    log->setGeneration(generation);
+    log->setRecordsSinceSnapshot(0);
+    snapshotDue.erase(nodeId);
+    log->reset();
+    return true;
+}
+
+/**
+ * @brief 写入成员快照（含放置方式）并以新代号重建成员 WAL
+ * @param ips 当前所有节点 IP
+ * @param placement 当前放置方式
+ * @return true 若快照已持久
+ */
+bool ChordStorage::writeMembershipSnapshot(const vector<string> &ips, const PlacementOptions &placement)
+{
+    if (!enabled)
+        return false;
+    uint64_t generation = membership->getGeneration() + 1;
+    string body(SNAPSHOT_MAGIC, 4);
+    putU32(body, SNAPSHOT_VERSION);
+    putU32(body, SNAPSHOT_KIND_MEMBERSHIP);
+    putU32(body, static_cast<uint32_t>(ips.size()));
+    for (auto &ip : ips)
+        putStr(body, ip);
+    putPlacement(body, placement);
+    putU64(body, generation);
+    if (!writeSnapshotFile(membership->getSnapPath(), body))
+        return false;
+    pendingRecords -= membership->discardPending();
+    membership->setGeneration(generation);
+    membership->setRecordsSinceSnapshot(0);
+    membership->reset();
+    return true;
+}
+
+/**
+ * @brief 启动恢复：加载成员快照并重放成员 WAL，再逐个节点加载快照并重放 WAL 尾部。
+ *        代号早于快照的 WAL（快照后的重建未落盘）整体跳过；损坏的尾部被截掉
+ * @param ring 输出恢复得到的环状态
+ * @return true 若数据目录中存在可恢复的状态
+ * @return false 若数据目录为空
+ */
+bool ChordStorage::recover(RecoveredRing &ring)
+{
+    ring = RecoveredRing();
+    if (!enabled)
+        return false;
+    auto start = chrono::steady_clock::now();
+    recovering = true;
+
+    string buf;
+    uint32_t count = 0;
+    size_t bodyPos = 0;
+    uint32_t version = 0;
+    uint64_t snapGeneration = 0;
+    bool found = false;
+    vector<string> &ips = ring.memberIps;
+    if (openSnapshot(membership->getSnapPath(), SNAPSHOT_KIND_MEMBERSHIP, buf, count, bodyPos, version, snapGeneration))
+    {
+        found = true;
+        Reader r(buf, bodyPos);
+        for (uint32_t i = 0; i < count && r.ok; i++)
+            ips.push_back(r.str());
+        if (version >= 4)
+            ring.placement = readPlacement(r);
+    }
+    membership->setGeneration(snapGeneration);
+
+    uint64_t membershipRecords = 0;
+    if (readWholeFile(membership->getWalPath(), buf) && !buf.empty())
+    {
+        uint64_t walGen = walGeneration(buf);
+        if (walGen < snapGeneration)
+        {
+            stats.staleLogs++;
+            membership->markStale();
+        }
+        else
+        {
+            found = true;
+            size_t validLen = 0;
+            bool clean = forEachRecord(buf, [&ips, &ring](Reader &r)
+                                       {
+                uint8_t type = r.u8();
+                if (type == REC_GENERATION)
+                {
+                    r.u64();
+                    return;
+                }
+                if (type == REC_PLACEMENT)
+                {
+                    PlacementOptions placement = readPlacement(r);
+                    if (r.ok)
+                        ring.placement = placement;
+                    return;
+                }
+                string ip = r.str();
+                if (!r.ok)
+                    return;
+                auto it = find(ips.begin(), ips.end(), ip);
+                if (type == REC_JOIN && it == ips.end())
+                    ips.push_back(ip);
+                else if (type == REC_LEAVE && it != ips.end())
+                    ips.erase(it); }, membershipRecords, validLen);
+            membership->setGeneration(walGen);
+            // 截不掉损坏的尾部时立即写快照，快照之后 WAL 整个重建
+            if (!clean && !truncateFile(membership->getWalPath(), validLen))
+                membershipRecords = max<uint64_t>(membershipRecords, options.snapshotThreshold);
+        }
+    }
+    stats.replayedRecords += membershipRecords;
+    membership->setRecordsSinceSnapshot(membershipRecords);
+
+    for (auto &ip : ips)
+    {
+        uint32_t nodeId = Node(ip).id;
+        map<uint32_t, string> &res = ring.resources[nodeId];
+        DeadlineMap &deadlines = ring.deadlines[nodeId];
+        LogFile *log = nodeLog(nodeId);
+        snapGeneration = 0;
+        if (openSnapshot(log->getSnapPath(), SNAPSHOT_KIND_NODE, buf, count, bodyPos, version, snapGeneration))
+        {
+            Reader r(buf, bodyPos);
+            for (uint32_t i = 0; i < count && r.ok; i++)
+            {
+                uint32_t rid = r.u32();
+                string s = r.str();
+                if (r.ok)
+                    res[rid] = s;
+            }
+            uint32_t timed = version >= 2 ? r.u32() : 0;
+            for (uint32_t i = 0; i < timed && r.ok; i++)
+            {
+                uint32_t rid = r.u32();
+                uint64_t deadline = r.u64();
+                if (r.ok)
+                    deadlines[rid] = deadline;
+            }
+        }
+        log->setGeneration(snapGeneration);
+        uint64_t records = 0;
+        if (readWholeFile(log->getWalPath(), buf) && !buf.empty())
+        {
+            uint64_t walGen = walGeneration(buf);
+            if (walGen < snapGeneration)
+            {
+                stats.staleLogs++;
+                log->markStale();
+                buf.clear();
+            }
+            else
+                log->setGeneration(walGen);
+        }
+        else
+            buf.clear();
+        if (!buf.empty())
+        {
+            size_t validLen = 0;
+            bool clean = forEachRecord(buf, [&res, &deadlines](Reader &r)
+                                       {
+                uint8_t type = r.u8();
+                if (type == REC_PUT)
+                {
+                    uint32_t rid = r.u32();
+                    string s = r.str();
+                    if (r.ok)
+                    {
+                        res[rid] = s;
+                        deadlines.erase(rid);
+                    }
+                }
+                else if (type == REC_DEL)
+                {
+                    uint32_t rid = r.u32();
+                    if (r.ok)
+                    {
+                        res.erase(rid);
+                        deadlines.erase(rid);
+                    }
+                }
+                else if (type == REC_XFER)
+                {
+                    r.u32();
+                    uint32_t rid = r.u32();
+                    string s = r.str();
+                    if (r.ok)
+                    {
+                        res[rid] = s;
+                        deadlines.erase(rid);
+                    }
+                }
+                else if (type == REC_DEL_RANGE)
+                {
+                    uint32_t lo = r.u32();
+                    uint32_t hi = r.u32();
+                    if (r.ok && lo <= hi)
+                    {
+                        auto first = res.lower_bound(lo), last = res.upper_bound(hi);
+                        if (!deadlines.empty())
+                            for (auto it = first; it != last; ++it)
+                                deadlines.erase(it->first);
+                        res.erase(first, last);
+                    }
+                }
+                else if (type == REC_XFER_CHUNK)
+                {
+                    r.u32();
+                    uint32_t count = r.u32();
+                    for (uint32_t i = 0; i < count && r.ok; i++)
+                    {
+                        uint32_t rid = r.u32();
+                        string s = r.str();
+                        if (r.ok)
+                        {
+                            res[rid] = s;
+                            deadlines.erase(rid);
+                        }
+                    }
+                }
+                else if (type == REC_EXPIRE)
+                {
+                    uint32_t rid = r.u32();
+                    uint64_t deadline = r.u64();
+                    if (r.ok && res.count(rid))
+                        deadlines[rid] = deadline;
+                }
+                else if (type == REC_GENERATION)
+                    r.u64();
+                else
+                    r.ok = false; }, records, validLen);
+            if (!clean && !truncateFile(log->getWalPath(), validLen))
+                records = max<uint64_t>(records, options.snapshotThreshold);
+        }
+        stats.replayedRecords += records;
+        log->setRecordsSinceSnapshot(records);
+        if (log->needsSnapshot(options.snapshotThreshold))
+            snapshotDue.insert(nodeId);
+        stats.recoveredResources += res.size();
+    }
+    recovering = false;
+    stats.recoveredNodes = ips.size();
+    stats.recoveryMs = elapsedMs(start);
+    return found;
+}
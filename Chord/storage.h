@@ -0,0 +1,166 @@
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <functional>
+#include "arena.h"
+#include "placement.h"
+
+// 一组按资源ID升序排列的资源（区间迁移的分块）
+typedef std::vector<std::pair<uint32_t, std::string>> ResourceChunk;
+
+// 节点上的资源表（资源ID → 资源名），树节点从所属管理器的 MemoryArena 分配
+typedef std::map<uint32_t, std::string, std::less<uint32_t>, ArenaAllocator<std::pair<const uint32_t, std::string>>> ResourceMap;
+
+// 带 TTL 的资源的到期时间（资源ID → 到期时刻，毫秒），没有 TTL 的资源不在表中
+typedef std::unordered_map<uint32_t, uint64_t> DeadlineMap;
+
+// 持久化配置
+// 写入先进入内存缓冲，组提交后才落盘：累计 groupCommitSize 条，或本批第一条记录已等待 commitDelayMs 后的下一次写入时提交。
+// 没有后台线程，最后一批记录在 sync()、关闭或下一次写入时才写盘；需要逐条持久时把 groupCommitSize 设为 1
+struct StorageOptions
+{
+    std::string dataDir;            // 数据目录，为空表示不启用持久化
+    size_t groupCommitSize = 64;    // 组提交：累计多少条记录后统一写盘
+    double commitDelayMs = 50;      // 组提交：本批第一条记录最多等待多久（在之后的写入中检查），0 表示只按条数
+    size_t snapshotThreshold = 4096; // 单个 WAL 记录数超过该值后写快照并截断 WAL
+    bool syncOnCommit = true;       // 组提交时是否 fsync
+};
+
+// 持久化统计信息
+struct StorageStats
+{
+    uint64_t walRecords = 0;       // 追加的 WAL 记录数
+    uint64_t walBytes = 0;         // 写入 WAL 的字节数
+    uint64_t snapshotBytes = 0;    // 写入快照的字节数
+    uint64_t snapshotsWritten = 0; // 写入的快照数
+    uint64_t groupCommits = 0;     // 组提交次数
+    uint64_t logicalBytes = 0;     // 逻辑修改的字节数（资源 ID + 资源内容）
+    uint64_t recoveredNodes = 0;   // 启动时恢复的节点数
+    uint64_t recoveredResources = 0; // 启动时恢复的资源数
+    uint64_t replayedRecords = 0;  // 启动时重放的 WAL 记录数
+    uint64_t staleLogs = 0;        // 启动时因早于快照而跳过的 WAL 数（快照后截断未落盘）
+    uint64_t commitFailures = 0;   // 写盘失败的组提交次数
+    double recoveryMs = 0.0;       // 启动恢复耗时（毫秒）
+
+    double writeAmplification() const;
+};
+
+// 启动恢复得到的环状态
+struct RecoveredRing
+{
+    std::vector<std::string> memberIps;                             // 存活节点 IP
+    std::map<uint32_t, std::map<uint32_t, std::string>> resources; // 节点 ID -> 资源
+    std::map<uint32_t, DeadlineMap> deadlines;                     // 节点 ID -> 资源到期时间
+    PlacementOptions placement;                                     // 放置方式，资源ID由它计算
+};
+
+// 单个日志文件（节点 WAL 或成员 WAL）：缓冲追加，组提交时打开文件追加、fsync 后立即关闭，不长期占用文件描述符。
+// 每次快照后 WAL 换一代：新 WAL 以一条代号记录开头，快照中记下同一代号，恢复时跳过代号更早的 WAL
+class LogFile
+{
+private:
+    std::string walPath;
+    std::string snapPath;
+    uint32_t nodeId;             // 所属节点，成员日志为 0
+    std::string pending;         // 尚未写盘的记录
+    size_t pendingCount;         // 尚未写盘的记录数
+    size_t recordsSinceSnapshot; // 自上次快照以来的记录数
+    uint64_t generation;         // 当前 WAL 的代号
+    bool walStale;               // 磁盘上的 WAL 不是当前代（截断未完成或属于先前离开的同ID节点），写盘前先重建
+    bool receiving;              // 本批含迁入的分块
+    bool sending;                // 本批含迁出后的区间删除
+
+public:
+    LogFile(const std::string &walPath, const std::string &snapPath, uint32_t nodeId);
+    LogFile(const LogFile &) = delete;
+    LogFile &operator=(const LogFile &) = delete;
+
+    void append(const std::string &record);
+    bool flush(bool sync, uint64_t &written);
+    size_t discardPending();
+    bool reset();
+    void removeFiles();
+    bool needsSnapshot(size_t threshold) const { return recordsSinceSnapshot >= threshold; }
+    bool hasPending() const { return !pending.empty(); }
+    const std::string &getWalPath() const { return walPath; }
+    const std::string &getSnapPath() const { return snapPath; }
+    uint32_t getNodeId() const { return nodeId; }
+    uint64_t getGeneration() const { return generation; }
+    void setGeneration(uint64_t g) { generation = g; }
+    void markStale() { walStale = true; }
+    void setRecordsSinceSnapshot(size_t n) { recordsSinceSnapshot = n; }
+    void markReceiving() { receiving = true; }
+    void markSending() { sending = true; }
+    bool isReceiving() const { return receiving; }
+    bool isSending() const { return sending; }
+};
+
+// 持久化层：每个节点一个 WAL + 快照，另有一个记录成员变化的 WAL + 快照。
+// 组提交分三步写盘：先写本批收到迁移分块的节点，再写成员日志，最后写其余节点（包括迁出方的区间删除），
+// 任一时刻崩溃，迁移中的资源至少留在一方的日志中；一批中同一节点既迁入又迁出时先提交前一部分，保持这一顺序
+class ChordStorage
+{
+private:
+    StorageOptions options;
+    bool enabled;
+    bool suspended;        // 恢复期间暂停记录
+    bool recovering;       // recover() 中创建的日志沿用磁盘上的文件
+    bool failed;           // 最近一次组提交写盘失败，缓冲记录保留到下次提交重试
+    size_t pendingRecords; // 所有日志中尚未写盘的记录数
+    uint64_t batchStartUs; // 本批第一条记录的时刻
+    LogFile *membership;
+    std::map<uint32_t, LogFile *> nodeLogs;
+    std::vector<LogFile *> dirtyLogs;  // 本批有缓冲记录的节点日志
+    std::set<uint32_t> snapshotDue;    // WAL 记录数达到阈值、等待写快照的节点
+    StorageStats stats;
+
+    LogFile *nodeLog(uint32_t nodeId);
+    void appendRecord(LogFile *log, const std::string &record, uint64_t logicalBytes);
+    bool flushLog(LogFile *log);
+    std::string nodeWalPath(uint32_t nodeId) const;
+    std::string nodeSnapPath(uint32_t nodeId) const;
+    bool writeSnapshotFile(const std::string &path, const std::string &body);
+
+public:
+    ChordStorage();
+    ~ChordStorage();
+    ChordStorage(const ChordStorage &) = delete;
+    ChordStorage &operator=(const ChordStorage &) = delete;
+
+    bool open(const StorageOptions &opts);
+    void close();
+    bool isEnabled() const { return enabled && !suspended; }
+    void setSuspended(bool value) { suspended = value; }
+
+    void logJoin(const std::string &ip);
+    void logLeave(const std::string &ip);
+    void logPlacement(const PlacementOptions &placement);
+    void logPut(uint32_t nodeId, uint32_t rid, const std::string &res);
+    void logRemove(uint32_t nodeId, uint32_t rid);
+    void logExpiry(uint32_t nodeId, uint32_t rid, uint64_t deadlineMs);
+    void logRemoveRange(uint32_t nodeId, uint32_t lo, uint32_t hi);
+    void logTransferChunk(uint32_t fromId, uint32_t toId, const ResourceChunk &chunk);
+    void dropNode(uint32_t nodeId);
+
+    bool commit();
+    bool sync();
+    bool healthy() const { return !failed; } // false 表示有已确认的写入尚未能写盘
+    bool recover(RecoveredRing &ring);
+    std::vector<uint32_t> nodesNeedingSnapshot() const;
+    bool membershipNeedsSnapshot() const;
+    bool writeNodeSnapshot(uint32_t nodeId, const ResourceMap &resources, const DeadlineMap &deadlines);
+    bool writeMembershipSnapshot(const std::vector<std::string> &ips, const PlacementOptions &placement);
+
+    const StorageStats &getStats() const { return stats; }
+    StorageStats &mutableStats() { return stats; }
+};
+
+#endif // STORAGE_H
@@ -0,0 +1,170 @@
+#include "timer_wheel.h"
+#include <algorithm>
+
+using namespace std;
+
+TimerWheel::TimerWheel(uint32_t tickMs) : freeHead(NIL), live(0), current(0), tickMs(tickMs ? tickMs : 1)
+{
+    for (int l = 0; l < LEVELS; l++)
+    {
+        counts[l] = 0;
+        for (uint32_t s = 0; s < SLOTS; s++)
+            heads[l][s] = NIL;
+    }
+}
+
+uint64_t TimerWheel::tickOf(uint64_t deadlineMs) const { return deadlineMs / tickMs + (deadlineMs % tickMs != 0); }
+
+/**
+ * @brief 把条目放入最低的、能在一圈之内覆盖其到期刻度的层；已过期的条目放到 ref 所在的槽，本刻度即触发
+ * @param index 条目下标
+ * @param ref 即将处理的刻度
+ */
+void TimerWheel::place(uint32_t index, uint64_t ref)
+{
+    uint64_t t = max(tickOf(entries[index].deadlineMs), ref);
+    int level = LEVELS - 1;
+    uint32_t slot = static_cast<uint32_t>(((ref >> (level * SLOT_BITS)) + SLOTS - 1) & (SLOTS - 1));
+    for (int l = 0; l < LEVELS; l++)
+    {
+        int shift = l * SLOT_BITS;
+        if ((t >> shift) - (ref >> shift) < SLOTS)
+        {
+            level = l;
+            slot = static_cast<uint32_t>((t >> shift) & (SLOTS - 1));
+            break;
+        }
+    }
+    entries[index].next = heads[level][slot];
+    heads[level][slot] = index;
+    counts[level]++;
+}
+
+/**
+ * @brief 把高层一个槽的条目按当前刻度重新放置（落入更低的层）
+ * @param level 层
+ * @param slot 槽
+ */
+void TimerWheel::cascade(int level, uint32_t slot)
+{
+    uint32_t index = heads[level][slot];
+    heads[level][slot] = NIL;
+    while (index != NIL)
+    {
+        uint32_t next = entries[index].next;
+        counts[level]--;
+        place(index, current);
+        index = next;
+    }
+}
+
+/**
+ * @brief 登记一个到期时间
+ * @param key 资源ID
+ * @param deadlineMs 到期时间（毫秒）
+ * @param nowMs 当前时间，轮为空时从这里开始计刻度
+ */
+void TimerWheel::schedule(uint32_t key, uint64_t deadlineMs, uint64_t nowMs)
+{
+    if (live == 0)
+        current = max(current, nowMs / tickMs);
+    uint32_t index;
+    if (freeHead != NIL)
+    {
+        index = freeHead;
+        freeHead = entries[index].next;
+    }
+    else
+    {
+        index = static_cast<uint32_t>(entries.size());
+        entries.push_back(Entry());
+    }
+    entries[index].deadlineMs = deadlineMs;
+    entries[index].key = key;
+    place(index, current + 1);
+    live++;
+}
+
+/**
+ * @brief 推进到 nowMs：逐刻度先由高到低级联，再触发第 0 层的槽；
+ *        最低的非空层在第 l 层时，下一次有事可做的刻度是第 l 层的下一个槽边界，中间的刻度直接跳过
+ * @param nowMs 当前时间
+ * @param due 输出到期的 (key, deadlineMs)
+ * @param limit 到期数上限（按刻度整批结算），0 表示不限
+ * @return size_t 本次到期的条目数
+ */
+size_t TimerWheel::advance(uint64_t nowMs, vector<pair<uint32_t, uint64_t>> &due, size_t limit)
+{
+    uint64_t target = nowMs / tickMs;
+    size_t fired = 0;
+    while (current < target)
+    {
+        if (live == 0)
+        {
+            current = target;
+            break;
+        }
+        int low = 0;
+        while (counts[low] == 0)
+            low++;
+        uint64_t next = current + 1;
+        if (low > 0)
+        {
+            int shift = low * SLOT_BITS;
+            next = ((current >> shift) + 1) << shift;
+            if (next > target)
+            {
+                current = target;
+                break;
+            }
+        }
+        current = next;
+        for (int l = LEVELS - 1; l >= 1; l--)
+        {
+            int shift = l * SLOT_BITS;
+            if ((current & ((1ULL << shift) - 1)) == 0)
+                cascade(l, static_cast<uint32_t>((current >> shift) & (SLOTS - 1)));
+        }
+
+        uint32_t slot = static_cast<uint32_t>(current & (SLOTS - 1));
+        uint32_t index = heads[0][slot];
+        heads[0][slot] = NIL;
+        while (index != NIL)
+        {
+            Entry &e = entries[index];
+            uint32_t next = e.next;
+            due.emplace_back(e.key, e.deadlineMs);
+            e.next = freeHead;
+            freeHead = index;
+            counts[0]--;
+            live--;
+            fired++;
+            index = next;
+        }
+        if (limit > 0 && fired >= limit)
+            break;
+    }
+    if (live == 0 && !entries.empty())
+    {
+        vector<Entry>().swap(entries);
+        freeHead = NIL;
+    }
+    return fired;
+}
+
+void TimerWheel::clear()
+{
+    vector<Entry>().swap(entries);
+    freeHead = NIL;
+    live = 0;
+    for (int l = 0; l < LEVELS; l++)
+    {
+        counts[l] = 0;
+        for (uint32_t s = 0; s < SLOTS; s++)
+            heads[l][s] = NIL;
+    }
+}
+
+size_t TimerWheel::size() const { return live; }
+size_t TimerWheel::memoryBytes() const { return sizeof(*this) + entries.capacity() * sizeof(Entry); }
+uint32_t TimerWheel::getTickMs() const { return tickMs; }
@@ -0,0 +1,56 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+// 分层时间轮：LEVELS 层，每层 SLOTS 个槽，第 l 层一个槽跨 SLOTS^l 个刻度，共覆盖 2^24 个刻度，
+// 更远的到期时间先放在顶层最远的槽，级联时再重新放置。
+// 插入 O(1)；每个条目至多级联 LEVELS-1 次，推进时只在非空层的槽边界上停留，均摊到每个条目为 O(1)。
+// 条目不支持删除：键被删除或改期后，旧条目到期时由使用者比对到期时间后丢弃
+class TimerWheel
+{
+public:
+    static const int LEVELS = 4;
+    static const int SLOT_BITS = 6;
+    static const uint32_t SLOTS = 1u << SLOT_BITS;
+
+private:
+    static const uint32_t NIL = 0xFFFFFFFFu;
+
+    // 条目放在一个数组中，槽内以下标串成单链表，空闲条目同样串成链表复用
+    struct Entry
+    {
+        uint64_t deadlineMs;
+        uint32_t key;
+        uint32_t next;
+    };
+
+    std::vector<Entry> entries;
+    uint32_t freeHead;
+    uint32_t heads[LEVELS][SLOTS];
+    uint32_t counts[LEVELS];
+    size_t live;
+    uint64_t current; // 已处理到的刻度
+    uint32_t tickMs;
+
+    uint64_t tickOf(uint64_t deadlineMs) const; // 向上取整，保证不早于到期时间触发
+    void place(uint32_t index, uint64_t ref);   // 按相对 ref 的距离放入合适的层与槽
+    void cascade(int level, uint32_t slot);
+
+public:
+    explicit TimerWheel(uint32_t tickMs = 100);
+
+    void schedule(uint32_t key, uint64_t deadlineMs, uint64_t nowMs);
+    // 推进到 nowMs，到期条目以 (key, deadlineMs) 追加到 due；
+    // limit 非 0 时，累计到期数达到 limit 后在当前刻度处理完即停止，剩余的留给下一次推进
+    size_t advance(uint64_t nowMs, std::vector<std::pair<uint32_t, uint64_t>> &due, size_t limit = 0);
+    void clear();
+    size_t size() const; // 条目数（含已失效、尚未到期的旧条目）
+    size_t memoryBytes() const;
+    uint32_t getTickMs() const;
+};
+
+#endif // TIMER_WHEEL_H
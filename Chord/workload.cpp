@@ -0,0 +1,402 @@
+#include "workload.h"
+#include "chord.h"
+#include <fstream>
+#include <chrono>
+#include <set>
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace
+{
+    const char TRACE_CODES[] = {'J', 'L', 'C', 'P', 'G', 'R'};
+
+    // 由 64 位随机数得到 [0, 1) 的小数；不用 <random> 的分布类，保证不同标准库生成的轨迹一致
+    double unitDouble(mt19937_64 &rng)
+    {
+        return (rng() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    string traceIp(size_t i)
+    {
+        return "10." + to_string((i >> 16) & 0xFF) + "." + to_string((i >> 8) & 0xFF) + "." + to_string(i & 0xFF);
+    }
+
+    // 参照模型：只记录成员 ID 与资源ID，负责节点由有序成员集合直接计算，不经过 Chord 路由
+    struct Oracle
+    {
+        set<uint32_t> members;
+        map<uint32_t, string> store;
+
+        uint32_t owner(uint32_t rid) const
+        {
+            auto it = members.lower_bound(rid);
+            return it == members.end() ? *members.begin() : *it;
+        }
+    };
+
+    void summarize(ostream &out, const char *label, const vector<size_t> &values)
+    {
+        if (values.empty())
+            return;
+        size_t total = 0, maxValue = 0;
+        for (size_t v : values)
+        {
+            total += v;
+            maxValue = max(maxValue, v);
+        }
+        out << "  " << label << "：共 " << total << "，平均 " << static_cast<double>(total) / values.size()
+            << "，最大 " << maxValue << endl;
+    }
+}
+
+/**
+ * @brief 构造 Zipf 采样器
+ * @param n 取值个数
+ * @param theta 偏斜参数，越大越集中
+ */
+ZipfGenerator::ZipfGenerator(size_t n, double theta)
+{
+    cdf.resize(max<size_t>(n, 1));
+    double sum = 0;
+    for (size_t i = 0; i < cdf.size(); i++)
+    {
+        sum += 1.0 / pow(static_cast<double>(i + 1), theta);
+        cdf[i] = sum;
+    }
+    for (auto &c : cdf)
+        c /= sum;
+}
+
+/**
+ * @brief 抽取一个秩
+ * @param rng 随机数发生器
+ * @return size_t [0, n) 内的秩
+ */
+size_t ZipfGenerator::operator()(mt19937_64 &rng) const
+{
+    double u = unitDouble(rng);
+    size_t idx = lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+    return min(idx, cdf.size() - 1);
+}
+
+const char *traceOpName(TraceOpType type)
+{
+    static const char *names[] = {"join", "leave", "crash", "put", "get", "remove"};
+    return names[static_cast<int>(type)];
+}
+
+/**
+ * @brief 按配置生成确定性轨迹：同一 seed 总是得到同一条轨迹。轨迹开头是 initialNodes 次加入，
+ *        之后按权重混合成员变化与资源操作；生成器自己维护成员表，离开/崩溃只作用于在环节点
+ * @param options 生成配置
+ * @return vector<TraceOp> 轨迹
+ */
+vector<TraceOp> generateTrace(const WorkloadOptions &options)
+{
+    mt19937_64 rng(options.seed);
+    ZipfGenerator zipf(options.keySpace, options.zipfTheta);
+    bool useZipf = options.keyDistribution == "zipf";
+    size_t keySpace = max<size_t>(options.keySpace, 1);
+
+    vector<TraceOp> trace;
+    trace.reserve(options.initialNodes + options.operations);
+    vector<string> members;
+    set<uint32_t> memberIds;
+    size_t nextIp = 0;
+
+    // 取一个与在环节点ID不冲突的新 IP，ID 空间已满时返回空串
+    auto freshIp = [&]() -> string
+    {
+        if (memberIds.size() >= ID_SPACE)
+            return string();
+        while (true)
+        {
+            string ip = traceIp(nextIp++);
+            if (!memberIds.count(Node(ip).id))
+                return ip;
+        }
+    };
+    auto addJoin = [&]() -> bool
+    {
+        string ip = freshIp();
+        if (ip.empty())
+            return false;
+        members.push_back(ip);
+        memberIds.insert(Node(ip).id);
+        trace.push_back({TraceOpType::JOIN, ip});
+        return true;
+    };
+    auto pickKey = [&]() -> string
+    {
+        size_t k = useZipf ? zipf(rng) : static_cast<size_t>(rng() % keySpace);
+        return "key-" + to_string(k);
+    };
+
+    for (size_t i = 0; i < options.initialNodes; i++)
+        addJoin();
+
+    const double weights[6] = {options.joinRate, options.leaveRate, options.crashRate,
+                               options.putRate, options.getRate, options.removeRate};
+    double totalWeight = 0;
+    for (double w : weights)
+        totalWeight += max(w, 0.0);
+    if (totalWeight <= 0)
+        return trace;
+
+    for (size_t i = 0; i < options.operations; i++)
+    {
+        double u = unitDouble(rng) * totalWeight;
+        int type = 0;
+        while (type < 5 && u >= max(weights[type], 0.0))
+            u -= max(weights[type++], 0.0);
+
+        TraceOpType op = static_cast<TraceOpType>(type);
+        if (op == TraceOpType::JOIN)
+        {
+            if (addJoin())
+                continue;
+            op = TraceOpType::GET;
+        }
+        if (op == TraceOpType::LEAVE || op == TraceOpType::CRASH)
+        {
+            if (members.size() > options.minNodes)
+            {
+                size_t idx = static_cast<size_t>(rng() % members.size());
+                memberIds.erase(Node(members[idx]).id);
+                trace.push_back({op, members[idx]});
+                members[idx] = members.back();
+                members.pop_back();
+                continue;
+            }
+            op = TraceOpType::GET;
+        }
+        trace.push_back({op, pickKey()});
+    }
+    return trace;
+}
+
+/**
+ * @brief 将轨迹写成文本文件，每行一条操作：<J|L|C|P|G|R> <参数>
+ * @param trace 轨迹
+ * @param path 文件路径
+ * @return true 若写入成功
+ */
+bool saveTrace(const vector<TraceOp> &trace, const string &path)
+{
+    ofstream out(path);
+    if (!out)
+        return false;
+    out << "# chord-trace v1\n";
+    for (const auto &op : trace)
+        out << TRACE_CODES[static_cast<int>(op.type)] << ' ' << op.arg << '\n';
+    return static_cast<bool>(out);
+}
+
+/**
+ * @brief 读取轨迹文件，忽略空行与 # 开头的注释行
+ * @param path 文件路径
+ * @param trace 读出的轨迹
+ * @return true 若读取成功且每一行格式正确
+ */
+bool loadTrace(const string &path, vector<TraceOp> &trace)
+{
+    ifstream in(path);
+    if (!in)
+        return false;
+    trace.clear();
+    string line;
+    while (getline(in, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (line.empty() || line[0] == '#')
+            continue;
+        const char *code = find(TRACE_CODES, TRACE_CODES + 6, line[0]);
+        if (code == TRACE_CODES + 6 || line.size() < 3 || line[1] != ' ')
+            return false;
+        trace.push_back({static_cast<TraceOpType>(code - TRACE_CODES), line.substr(2)});
+    }
+    return true;
+}
+
+/**
+ * @brief 以最快速度回放轨迹，每个操作的返回值与参照模型比对；只有对环管理器的调用计入耗时。
+ *        正常离开与加入统计迁移的资源数（来自迁移统计），崩溃统计丢失的资源数
+ * @param manager 环管理器（通常为空环）
+ * @param trace 轨迹
+ * @param verifyEvery 每回放多少个操作做一次 ChordRingManager::verify()，0 表示只在结束时校验
+ * @return ReplayReport 回放报告
+ */
+ReplayReport replayTrace(ChordRingManager &manager, const vector<TraceOp> &trace, size_t verifyEvery)
+{
+    ReplayReport report;
+    Oracle oracle;
+    for (auto &p : manager.getAllChordNodes())
+    {
+        oracle.members.insert(p.first);
+        for (auto &res : p.second->getResourceMap())
+            oracle.store.insert(res);
+    }
+
+    for (const auto &op : trace)
+    {
+        int type = static_cast<int>(op.type);
+        bool ok = false, expected = false, ownerMatches = true;
+        MigrationStats before = manager.getMigrationStats();
+        chrono::steady_clock::time_point begin;
+
+        switch (op.type)
+        {
+        case TraceOpType::JOIN:
+        {
+            uint32_t id = Node(op.arg).id;
+            expected = !oracle.members.count(id);
+            begin = chrono::steady_clock::now();
+            ok = manager.join(op.arg);
+            report.seconds[type] += chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+            if (ok)
+            {
+                oracle.members.insert(id);
+                report.keysMovedPerJoin.push_back(manager.getMigrationStats().keysMoved - before.keysMoved);
+                report.bytesMovedOnJoin += manager.getMigrationStats().bytesMoved - before.bytesMoved;
+            }
+            break;
+        }
+        case TraceOpType::LEAVE:
+        case TraceOpType::CRASH:
+        {
+            bool graceful = op.type == TraceOpType::LEAVE;
+            uint32_t id = Node(op.arg).id;
+            expected = oracle.members.count(id) > 0;
+            begin = chrono::steady_clock::now();
+            ok = manager.removeNodeByIP(op.arg, graceful);
+            report.seconds[type] += chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+            if (!ok)
+                break;
+
+            // 崩溃节点负责的资源丢失；最后一个节点离开时环上不再有资源
+            size_t lost = 0;
+            if (!graceful || oracle.members.size() == 1)
+            {
+                for (auto it = oracle.store.begin(); it != oracle.store.end();)
+                {
+                    if (oracle.owner(it->first) == id)
+                    {
+                        it = oracle.store.erase(it);
+                        lost++;
+                    }
+                    else
+                        ++it;
+                }
+            }
+            oracle.members.erase(id);
+            if (graceful)
+            {
+                report.keysMovedPerLeave.push_back(manager.getMigrationStats().keysMoved - before.keysMoved);
+                report.bytesMovedOnLeave += manager.getMigrationStats().bytesMoved - before.bytesMoved;
+            }
+            else
+                report.keysLostPerCrash.push_back(lost);
+            break;
+        }
+        case TraceOpType::PUT:
+        {
+            uint32_t rid = manager.resourceIdOf(op.arg);
+            expected = !oracle.members.empty() && !oracle.store.count(rid);
+            begin = chrono::steady_clock::now();
+            ok = manager.addResource(op.arg);
+            report.seconds[type] += chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+            if (ok)
+                oracle.store[rid] = op.arg;
+            break;
+        }
+        case TraceOpType::GET:
+        {
+            uint32_t rid = manager.resourceIdOf(op.arg);
+            begin = chrono::steady_clock::now();
+            Node owner = manager.lookupResource(op.arg);
+            report.seconds[type] += chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+            ok = !owner.isEmpty();
+            expected = !oracle.members.empty() && oracle.store.count(rid) > 0;
+            ownerMatches = !ok || owner.id == oracle.owner(rid);
+            report.getChecked++;
+            if (ok != expected || !ownerMatches)
+                report.getMismatches++;
+            break;
+        }
+        case TraceOpType::REMOVE:
+        {
+            uint32_t rid = manager.resourceIdOf(op.arg);
+            expected = oracle.store.count(rid) > 0;
+            begin = chrono::steady_clock::now();
+            ok = manager.removeResource(op.arg);
+            report.seconds[type] += chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+            if (ok)
+                oracle.store.erase(rid);
+            break;
+        }
+        }
+
+        report.counts[type]++;
+        if (ok)
+            report.succeeded[type]++;
+        if (ok != expected || !ownerMatches)
+            report.mismatches++;
+
+        size_t done = &op - trace.data() + 1;
+        if ((verifyEvery > 0 && done % verifyEvery == 0) || done == trace.size())
+        {
+            VerifyReport check = manager.verify(1);
+            report.verifyRuns++;
+            if (!check.ok())
+            {
+                report.verifyFailures++;
+                if (report.verifyFailures == 1 && !check.problems.empty())
+                    report.firstVerifyProblem = "第 " + to_string(done) + " 个操作后：" + check.problems[0];
+            }
+        }
+    }
+
+    for (double s : report.seconds)
+        report.totalSeconds += s;
+    report.finalNodes = manager.getTotalNodes();
+    report.finalKeys = manager.getAllResourceNames().size();
+    if (report.finalKeys != oracle.store.size())
+        report.mismatches++;
+    return report;
+}
+
+/**
+ * @brief 输出回放报告：各操作的次数、成功数与吞吐，参照模型校验结果，每次成员变化迁移/丢失的资源数
+ * @param report 回放报告
+ * @param out 输出流
+ */
+void printReport(const ReplayReport &report, ostream &out)
+{
+    size_t total = 0;
+    for (size_t c : report.counts)
+        total += c;
+    out << "操作总数 " << total << "，耗时 " << report.totalSeconds * 1000 << " ms，吞吐 "
+        << (report.totalSeconds > 0 ? total / report.totalSeconds : 0) << " ops/s" << endl;
+    for (int t = 0; t < 6; t++)
+    {
+        if (report.counts[t] == 0)
+            continue;
+        out << "  " << traceOpName(static_cast<TraceOpType>(t)) << "：" << report.counts[t] << " 次，成功 "
+            << report.succeeded[t] << "，" << (report.seconds[t] > 0 ? report.counts[t] / report.seconds[t] : 0)
+            << " ops/s" << endl;
+    }
+    out << "参照模型校验：不一致 " << report.mismatches << "（查找 " << report.getMismatches << " / "
+        << report.getChecked << "）" << endl;
+    out << "环一致性校验：" << report.verifyRuns << " 次，失败 " << report.verifyFailures << endl;
+    if (!report.firstVerifyProblem.empty())
+        out << "  首个问题：" << report.firstVerifyProblem << endl;
+    out << "成员变化的数据量：" << endl;
+    summarize(out, "每次加入迁移的资源", report.keysMovedPerJoin);
+    summarize(out, "每次离开迁移的资源", report.keysMovedPerLeave);
+    summarize(out, "每次崩溃丢失的资源", report.keysLostPerCrash);
+    out << "  加入迁移字节 " << report.bytesMovedOnJoin << "，离开迁移字节 " << report.bytesMovedOnLeave << endl;
+    out << "结束时节点 " << report.finalNodes << "，资源 " << report.finalKeys << endl;
+}
@@ -0,0 +1,90 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+#include <cstdint>
+#include <cstddef>
+#include <ostream>
+
+class ChordRingManager;
+
+// 负载轨迹中的操作类型
+enum class TraceOpType
+{
+    JOIN,   // 节点加入
+    LEAVE,  // 节点正常离开（资源转移给后继）
+    CRASH,  // 节点崩溃（资源丢失）
+    PUT,    // 添加资源
+    GET,    // 查找资源
+    REMOVE  // 删除资源
+};
+
+// 轨迹中的一条操作，参数为节点 IP 或资源名
+struct TraceOp
+{
+    TraceOpType type;
+    std::string arg;
+};
+
+// 轨迹生成配置：各操作的比例为相对权重
+struct WorkloadOptions
+{
+    uint64_t seed = 1;
+    size_t operations = 10000;          // 不含初始节点的操作数
+    size_t initialNodes = 32;           // 轨迹开头先加入的节点数
+    size_t minNodes = 4;                // 离开/崩溃不会使节点数低于该值
+    size_t keySpace = 5000;             // 资源名取自 key-0 .. key-(keySpace-1)
+    std::string keyDistribution = "uniform"; // uniform / zipf
+    double zipfTheta = 0.99;
+    double joinRate = 0.01;
+    double leaveRate = 0.005;
+    double crashRate = 0.005;
+    double putRate = 0.4;
+    double getRate = 0.5;
+    double removeRate = 0.08;
+};
+
+// Zipf 分布采样：预先计算累积分布，按二分查找取秩（秩 0 最热）
+class ZipfGenerator
+{
+private:
+    std::vector<double> cdf;
+
+public:
+    ZipfGenerator(size_t n, double theta);
+    size_t operator()(std::mt19937_64 &rng) const;
+};
+
+// 回放报告
+struct ReplayReport
+{
+    size_t counts[6] = {0};      // 按 TraceOpType 计数
+    size_t succeeded[6] = {0};   // 操作返回成功的次数
+    double seconds[6] = {0};     // 按操作类型累计耗时
+    double totalSeconds = 0;
+    size_t mismatches = 0;       // 结果与参照模型不一致的操作数
+    size_t getChecked = 0;       // 校验过的查找数
+    size_t getMismatches = 0;    // 其中负责节点或存在性不一致的查找数
+    std::vector<size_t> keysMovedPerJoin;
+    std::vector<size_t> keysMovedPerLeave;
+    std::vector<size_t> keysLostPerCrash;
+    uint64_t bytesMovedOnJoin = 0;
+    uint64_t bytesMovedOnLeave = 0;
+    size_t finalNodes = 0;
+    size_t finalKeys = 0;
+    size_t verifyRuns = 0;       // 环一致性校验次数
+    size_t verifyFailures = 0;   // 其中未通过的次数
+    std::string firstVerifyProblem;
+};
+
+const char *traceOpName(TraceOpType type);
+std::vector<TraceOp> generateTrace(const WorkloadOptions &options);
+bool saveTrace(const std::vector<TraceOp> &trace, const std::string &path);
+bool loadTrace(const std::string &path, std::vector<TraceOp> &trace);
+ReplayReport replayTrace(ChordRingManager &manager, const std::vector<TraceOp> &trace, size_t verifyEvery = 0);
+void printReport(const ReplayReport &report, std::ostream &out);
+
+#endif // WORKLOAD_H